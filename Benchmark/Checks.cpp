@@ -0,0 +1,711 @@
+#include "Checks.h"
+
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <cstring>
+#include <algorithm>
+
+#include "LayoutParser/LayoutParser.h"
+
+#include "Analysis/Lexer.h"
+#include "Analysis/StructuralIndex.h"
+#include "Data/BinaryWriter.h"
+
+#include "CorpusGenerator.h"
+
+namespace
+{
+	void DumpValue(std::ostream& out, const LayoutParser::Value* value);
+
+	void DumpObject(std::ostream& out, const LayoutParser::Object* object)
+	{
+		out << "<" << object->GetIdentifier() << "(";
+		if (object->GetConstructor() != nullptr)
+			DumpValue(out, object->GetConstructor());
+		out << ")";
+
+		for (auto& property : *object)
+		{
+			out << " " << property.first << "=";
+			DumpValue(out, property.second);
+		}
+		out << ">";
+	}
+
+	void DumpValue(std::ostream& out, const LayoutParser::Value* value)
+	{
+		switch (value->GetKind())
+		{
+		case LayoutParser::ValueKind::Object:
+			DumpObject(out, value->AsObject()->GetValue());
+			break;
+		case LayoutParser::ValueKind::String:
+			out << "\"" << value->AsString()->GetValue() << "\"";
+			break;
+		case LayoutParser::ValueKind::Number:
+			out << std::hexfloat << value->AsNumber()->GetValue() << std::defaultfloat;
+			break;
+		case LayoutParser::ValueKind::Boolean:
+			out << (value->AsBoolean()->GetValue() ? "true" : "false");
+			break;
+		case LayoutParser::ValueKind::HexColor:
+		{
+			const LayoutParser::HexColorValue* color = value->AsHexColor();
+			out << "#" << int(color->GetR()) << "," << int(color->GetG()) << "," << int(color->GetB());
+			break;
+		}
+		case LayoutParser::ValueKind::List:
+			out << "{";
+			for (const LayoutParser::Value* item : value->AsList()->GetContainer())
+			{
+				DumpValue(out, item);
+				out << ",";
+			}
+			out << "}";
+			break;
+		case LayoutParser::ValueKind::Dictionary:
+			out << "[";
+			for (auto& entry : value->AsDictionary()->GetContainer())
+			{
+				out << entry.first << "=";
+				DumpValue(out, entry.second);
+				out << ",";
+			}
+			out << "]";
+			break;
+		}
+	}
+
+	// The layouts in order with their spans, and every object with its span and values. One line each.
+	std::string DumpLayouts(LayoutParser::LayoutCollection& collection)
+	{
+		std::ostringstream out;
+		for (auto& pair : collection)
+		{
+			const LayoutParser::Layout& layout = pair.second;
+			out << pair.first << " @" << layout.GetSpan().Start << "+" << layout.GetSpan().Length << "\n";
+			for (size_t i = 0; i < layout.Size(); i++)
+			{
+				LayoutParser::TextSpan span = layout.GetObjectSpan(i);
+				out << "  @" << span.Start << "+" << span.Length << " ";
+				DumpObject(out, layout[i]);
+				out << "\n";
+			}
+		}
+		return out.str();
+	}
+
+	// Everything two loads can differ in
+	std::string DumpCollection(LayoutParser::LayoutCollection& collection)
+	{
+		std::ostringstream out;
+		for (const std::string& message : collection.GetDiagnostics())
+			out << "! " << message << "\n";
+		out << DumpLayouts(collection);
+		return out.str();
+	}
+
+	// The compiled form as well, that one also sees the order of the symbols and strings
+	std::string Compile(const LayoutParser::LayoutCollection& collection)
+	{
+		std::vector<char> bytes = LayoutParser::BinaryWriter(collection).Write();
+		return std::string(bytes.begin(), bytes.end());
+	}
+
+	// Prints the first line that differs, returns whether there was one
+	bool ReportDifference(const char* check, const std::string& what, const std::string& expected, const std::string& actual)
+	{
+		if (expected == actual)
+			return false;
+
+		std::istringstream expectedLines(expected);
+		std::istringstream actualLines(actual);
+		std::string expectedLine;
+		std::string actualLine;
+		for (size_t line = 1; ; line++)
+		{
+			bool hasExpected = static_cast<bool>(std::getline(expectedLines, expectedLine));
+			bool hasActual = static_cast<bool>(std::getline(actualLines, actualLine));
+			if (!hasExpected && !hasActual)
+				break;
+
+			if (!hasExpected || !hasActual || expectedLine != actualLine)
+			{
+				std::cout << check << ": " << what << " differs at line " << line << "\n" <<
+					"  expected: " << (hasExpected ? expectedLine : "<end>") << "\n" <<
+					"  actual:   " << (hasActual ? actualLine : "<end>") << "\n";
+				break;
+			}
+		}
+		return true;
+	}
+
+	// Pieces of .lp syntax that break things in interesting ways, or fix them again
+	const char* const Snippets[] = {
+		"x", "}", "{", "<", ">", "\"", "//", "\n", "#", "#12AB34", ",", "=", "(", ")", "[", "]", "  ",
+		"1", "9", "1+2", "true", "ID", " = 2", "\"s\"", "Layout0", "<Frame() X = 1>", "} Q {",
+		"Layout9\n{\n}\n", "}\nLayoutZ\n{\n", "<Frame() ID = \"a\">,", "\t<Frame()\n\t\tID = \"z\"\n\t>\n",
+		"/", "#AB", "#1{2}=", "\"//\"", "// \"", "0x1F", "-", "*", "L3*",
+	};
+
+	struct Edit
+	{
+		size_t Start;
+		size_t RemovedLength;
+		std::string Inserted;
+	};
+
+	// A few characters replaced by a snippet or just removed, now and then a bigger cut
+	Edit MakeEdit(const std::string& text, std::mt19937_64& random)
+	{
+		Edit edit;
+		edit.Start = random() % (text.length() + 1);
+
+		size_t maximumRemoved = (random() % 4 == 0) ? 200 : 4;
+		edit.RemovedLength = random() % (std::min(maximumRemoved, text.length() - edit.Start) + 1);
+		if (random() % 3 != 0)
+			edit.Inserted = Snippets[random() % (sizeof(Snippets) / sizeof(Snippets[0]))];
+		return edit;
+	}
+
+	std::string ApplyEdit(const std::string& text, const Edit& edit)
+	{
+		return text.substr(0, edit.Start) + edit.Inserted + text.substr(edit.Start + edit.RemovedLength);
+	}
+
+	std::string Mutate(const std::string& text, std::mt19937_64& random, int32_t editCount)
+	{
+		std::string mutated = text;
+		for (int32_t i = 0; i < editCount; i++)
+			mutated = ApplyEdit(mutated, MakeEdit(mutated, random));
+		return mutated;
+	}
+
+	// LoadFromFiles merges in the order of the paths, so the thread count can't change the result
+	bool CheckLoadFromFiles(uint64_t seed)
+	{
+		constexpr int32_t FileCount = 24;
+
+		std::mt19937_64 random(seed);
+		std::filesystem::path directory = std::filesystem::temp_directory_path() / ("LayoutParserCheckFiles" + std::to_string(seed));
+		std::filesystem::create_directories(directory);
+
+		// Every third file is broken somewhere, and the generated names repeat across files
+		std::vector<std::string> paths;
+		for (int32_t i = 0; i < FileCount; i++)
+		{
+			std::string text = CorpusGenerator(seed + i).Generate(static_cast<CorpusShape>(i % 3), 32 * 1024);
+			if (i % 3 == 2)
+				text = Mutate(text, random, 3);
+
+			paths.push_back((directory / ("file" + std::to_string(i) + ".lp")).string());
+			std::ofstream(paths.back(), std::ios::out | std::ios::binary) << text;
+		}
+
+		bool isSame = true;
+		LayoutParser::LayoutCollection sequential = LayoutParser::LayoutCollection::LoadFromFiles(paths, 1);
+		std::string expected = DumpCollection(sequential);
+		for (size_t threadCount : { 2, 8 })
+		{
+			LayoutParser::LayoutCollection parallel = LayoutParser::LayoutCollection::LoadFromFiles(paths, threadCount);
+			if (ReportDifference("files", std::to_string(threadCount) + " threads", expected, DumpCollection(parallel)))
+				isSame = false;
+			else if (Compile(sequential) != Compile(parallel))
+			{
+				std::cout << "files: " << threadCount << " threads compile to different bytes\n";
+				isSame = false;
+			}
+		}
+
+		std::filesystem::remove_all(directory);
+		std::cout << "Files:    " << FileCount << " files, " << sequential.GetDiagnostics().Size() << " diagnostics, " <<
+			(isSame ? "same" : "different") << " with 2 and 8 threads\n";
+		return isSame;
+	}
+
+	// Clean text gets parsed in chunks and stitched together, broken text falls back to one
+	// parse. Either way it has to come out as if it was parsed in one go.
+	bool CheckLoadFromStringParallel(uint64_t seed)
+	{
+		constexpr int32_t MutationCount = 8;
+
+		std::mt19937_64 random(seed);
+		bool isSame = true;
+		int32_t textCount = 0;
+		for (CorpusShape shape : { CorpusShape::Shipped, CorpusShape::Wide, CorpusShape::Deep, CorpusShape::Expressions, CorpusShape::Strings })
+		{
+			// Big enough for a few chunks
+			std::string generated = CorpusGenerator(seed).Generate(shape, 512 * 1024);
+			for (int32_t i = 0; i <= MutationCount; i++, textCount++)
+			{
+				std::string text = (i == 0) ? generated : Mutate(generated, random, 1 + i / 2);
+
+				LayoutParser::LayoutCollection sequential = LayoutParser::LayoutCollection::LoadFromString(text);
+				LayoutParser::LayoutCollection parallel = LayoutParser::LayoutCollection::LoadFromStringParallel(text, 8);
+				std::string what = "shape " + std::to_string(static_cast<int32_t>(shape)) + " mutation " + std::to_string(i);
+				if (ReportDifference("parallel", what, DumpCollection(sequential), DumpCollection(parallel)))
+					isSame = false;
+				else if (Compile(sequential) != Compile(parallel))
+				{
+					std::cout << "parallel: " << what << " compiles to different bytes\n";
+					isSame = false;
+				}
+			}
+		}
+
+		std::cout << "Parallel: " << textCount << " texts, " << (isSame ? "same" : "different") << " with 8 threads\n";
+		return isSame;
+	}
+
+	// Where the lexer finds the characters the structural index is after
+	std::vector<uint32_t> LexStructuralPositions(std::string_view text)
+	{
+		LayoutParser::DiagnosticCollection diagnostics;
+		LayoutParser::Lexer lexer(text, diagnostics);
+
+		std::vector<uint32_t> positions;
+		for (LayoutParser::SyntaxToken token = lexer.Lex(); token.Kind != LayoutParser::SyntaxKind::EndOfFileToken; token = lexer.Lex())
+		{
+			switch (token.Kind)
+			{
+			case LayoutParser::SyntaxKind::OpenAngleBracketToken:
+			case LayoutParser::SyntaxKind::CloseAngleBracketToken:
+			case LayoutParser::SyntaxKind::OpenSquigglyBracketToken:
+			case LayoutParser::SyntaxKind::CloseSquigglyBracketToken:
+			case LayoutParser::SyntaxKind::OpenSquareBracketToken:
+			case LayoutParser::SyntaxKind::CloseSquareBracketToken:
+			case LayoutParser::SyntaxKind::OpenParenthesisToken:
+			case LayoutParser::SyntaxKind::CloseParenthesisToken:
+			case LayoutParser::SyntaxKind::EqualsToken:
+			case LayoutParser::SyntaxKind::CommaToken:
+				positions.push_back(static_cast<uint32_t>(token.Position));
+				break;
+			default:
+				break;
+			}
+		}
+		return positions;
+	}
+
+	std::string DumpPositions(const std::string& text, const std::vector<uint32_t>& positions)
+	{
+		std::ostringstream out;
+		for (uint32_t position : positions)
+			out << position << " " << text[position] << "\n";
+		return out.str();
+	}
+
+	// The index skips strings, comments and hex colors with bit tricks 64 bytes at a time, the
+	// lexer one character at a time. Text made of nothing but snippets has all of them cut off
+	// at every possible point, including across the block edges.
+	bool CheckStructuralIndex(uint64_t seed)
+	{
+		constexpr int32_t SnippetTextCount = 200;
+
+		std::mt19937_64 random(seed);
+		std::vector<std::string> texts;
+		for (int32_t shape = 0; shape <= static_cast<int32_t>(CorpusShape::Errors); shape++)
+		{
+			std::string generated = CorpusGenerator(seed).Generate(static_cast<CorpusShape>(shape), 64 * 1024);
+			texts.push_back(generated);
+			for (int32_t i = 1; i <= 4; i++)
+				texts.push_back(Mutate(generated, random, i * 4));
+		}
+
+		for (int32_t i = 0; i < SnippetTextCount; i++)
+		{
+			std::string text;
+			size_t length = random() % 300;
+			while (text.length() < length)
+				text += Snippets[random() % (sizeof(Snippets) / sizeof(Snippets[0]))];
+			texts.push_back(text);
+		}
+
+		bool isSame = true;
+		size_t positionCount = 0;
+		for (size_t i = 0; i < texts.size(); i++)
+		{
+			LayoutParser::StructuralIndex index(texts[i]);
+			std::vector<uint32_t> indexed(index.begin(), index.end());
+			std::vector<uint32_t> lexed = LexStructuralPositions(texts[i]);
+			positionCount += lexed.size();
+
+			if (ReportDifference("structural", "text " + std::to_string(i), DumpPositions(texts[i], lexed), DumpPositions(texts[i], indexed)))
+				isSame = false;
+		}
+
+		std::cout << "Structural: " << texts.size() << " texts, " << positionCount << " positions, " <<
+			(isSame ? "same" : "different") << " with " << LayoutParser::StructuralIndex::GetImplementationName() << "\n";
+		return isSame;
+	}
+
+	// The kind of edit that keeps generated text valid: a digit changed, an object added after
+	// another one or an object taken out
+	Edit MakeValidEdit(const std::string& text, std::mt19937_64& random)
+	{
+		size_t position = random() % (text.length() + 1);
+		switch (random() % 3)
+		{
+		case 0:
+		{
+			size_t digit = text.find_first_of("0123456789", position);
+			if (digit != std::string::npos)
+				return { digit, 1, std::string(1, static_cast<char>('0' + random() % 10)) };
+			break;
+		}
+		case 1:
+		{
+			size_t objectEnd = text.find("\n\t>\n", position);
+			if (objectEnd != std::string::npos)
+				return { objectEnd + 4, 0, "\t<Frame() ID = \"added\", ZIndex = 5>\n" };
+			break;
+		}
+		case 2:
+		{
+			size_t objectStart = text.find("\n\t<", position);
+			size_t objectEnd = (objectStart != std::string::npos) ? text.find("\n\t>\n", objectStart) : std::string::npos;
+			if (objectEnd != std::string::npos)
+				return { objectStart + 1, objectEnd + 3 - objectStart, std::string() };
+			break;
+		}
+		}
+		return { position, 0, std::string() };
+	}
+
+	// Every reparse builds on the one before, like an editor would. Edits that break the text are
+	// mostly taken back again so most of them land in valid text and get reparsed incrementally.
+	bool CheckReparse(uint64_t seed)
+	{
+		constexpr int32_t EditCount = 600;
+
+		std::mt19937_64 random(seed);
+		const std::string generated = CorpusGenerator(seed).Generate(CorpusShape::Shipped, 64 * 1024);
+		std::string text = generated;
+		LayoutParser::LayoutCollection current = LayoutParser::LayoutCollection::LoadFromString(text);
+
+		int32_t mismatchCount = 0;
+		int32_t incrementalCount = 0;
+		for (int32_t i = 0; i < EditCount; i++)
+		{
+			// Now and then start over before the text has lost all of its structure
+			if (random() % 50 == 0)
+			{
+				text = generated;
+				current = LayoutParser::LayoutCollection::LoadFromString(text);
+			}
+
+			Edit edit = (random() % 2 == 0) ? MakeEdit(text, random) : MakeValidEdit(text, random);
+			std::string edited = ApplyEdit(text, edit);
+
+			LayoutParser::LayoutCollection expected = LayoutParser::LayoutCollection::LoadFromString(edited);
+			LayoutParser::LayoutCollection reparsed = current.Reparse(edited, LayoutParser::TextEdit{ edit.Start, edit.RemovedLength, edit.Inserted.length() });
+
+			std::string what = "edit " + std::to_string(i) + " at " + std::to_string(edit.Start) + " removing " +
+				std::to_string(edit.RemovedLength) + " inserting \"" + edit.Inserted + "\"";
+			if (ReportDifference("reparse", what, DumpCollection(expected), DumpCollection(reparsed)))
+			{
+				// Carry on from the right tree so one mistake doesn't drown out the rest
+				if (++mismatchCount >= 4)
+					break;
+				text = edited;
+				current = expected;
+				continue;
+			}
+
+			if (reparsed.GetArenas().size() > current.GetArenas().size())
+				incrementalCount++;
+
+			if (!expected.GetDiagnostics().IsEmpty() && random() % 8 != 0)
+				continue;
+
+			text = edited;
+			current = reparsed;
+		}
+
+		std::cout << "Reparse:  " << EditCount << " edits, " << incrementalCount << " incremental, " << mismatchCount << " different\n";
+		return mismatchCount == 0;
+	}
+
+	// Every object in the tree under the value, the ones nested in other objects included
+	void CollectObjects(const LayoutParser::Value* value, std::vector<const LayoutParser::Object*>& objects);
+
+	void CollectObjects(const LayoutParser::Object* object, std::vector<const LayoutParser::Object*>& objects)
+	{
+		objects.push_back(object);
+		if (object->GetConstructor() != nullptr)
+			CollectObjects(object->GetConstructor(), objects);
+		for (auto& property : *object)
+			CollectObjects(property.second, objects);
+	}
+
+	void CollectObjects(const LayoutParser::Value* value, std::vector<const LayoutParser::Object*>& objects)
+	{
+		if (value->GetKind() == LayoutParser::ValueKind::Object)
+			CollectObjects(value->AsObject()->GetValue(), objects);
+		else if (value->GetKind() == LayoutParser::ValueKind::List)
+		{
+			for (const LayoutParser::Value* item : value->AsList()->GetContainer())
+				CollectObjects(item, objects);
+		}
+		else if (value->GetKind() == LayoutParser::ValueKind::Dictionary)
+		{
+			for (auto& entry : value->AsDictionary()->GetContainer())
+				CollectObjects(entry.second, objects);
+		}
+	}
+
+	// What the index should hold, worked out from the tree the collection ended up with. Whatever
+	// the parser dropped, like a layout defined twice, can't be in there.
+	std::string DumpExpectedIndex(LayoutParser::LayoutCollection& collection)
+	{
+		std::map<std::string_view, size_t> typeCounts;
+		std::set<std::pair<std::string_view, std::string_view>> keys;
+		std::ostringstream out;
+		size_t objectCount = 0;
+		for (auto& pair : collection)
+		{
+			std::vector<const LayoutParser::Object*> objects;
+			for (const LayoutParser::Object* object : pair.second)
+				CollectObjects(object, objects);
+
+			std::map<std::string_view, const LayoutParser::Object*> keyed;
+			for (const LayoutParser::Object* object : objects)
+			{
+				typeCounts[object->GetIdentifier()]++;
+				for (auto& property : *object)
+				{
+					if (property.first == "ID" && property.second->GetKind() == LayoutParser::ValueKind::String)
+						keyed.emplace(property.second->AsString()->GetValue(), object);
+				}
+			}
+
+			// The first object with a key gets it, which is the one in front for top-level objects
+			for (const LayoutParser::Object* object : pair.second)
+			{
+				for (auto& entry : keyed)
+				{
+					if (entry.second == object)
+						out << pair.first << "/" << entry.first << " -> " << object << "\n";
+				}
+			}
+
+			for (auto& entry : keyed)
+				keys.emplace(pair.first, entry.first);
+			objectCount += objects.size();
+		}
+
+		out << objectCount << " objects, " << keys.size() << " keys\n";
+		for (auto& entry : typeCounts)
+			out << entry.first << " " << entry.second << "\n";
+		return out.str();
+	}
+
+	std::string DumpIndex(LayoutParser::LayoutCollection& collection)
+	{
+		const LayoutParser::ObjectIndex& index = *collection.GetIndex();
+		std::ostringstream out;
+		for (auto& pair : collection)
+		{
+			std::vector<const LayoutParser::Object*> objects;
+			for (const LayoutParser::Object* object : pair.second)
+				CollectObjects(object, objects);
+
+			// Same keys as above, but looked up in the index
+			std::set<std::string_view> keys;
+			for (const LayoutParser::Object* object : objects)
+			{
+				for (auto& property : *object)
+				{
+					if (property.first == "ID" && property.second->GetKind() == LayoutParser::ValueKind::String)
+						keys.insert(property.second->AsString()->GetValue());
+				}
+			}
+
+			for (const LayoutParser::Object* object : pair.second)
+			{
+				for (std::string_view key : keys)
+				{
+					if (index.FindObject(collection.FindSymbol(pair.first), key) == object)
+						out << pair.first << "/" << key << " -> " << object << "\n";
+				}
+			}
+		}
+
+		out << index.GetObjectCount() << " objects, " << index.GetKeyCount() << " keys\n";
+		std::set<std::string_view> types;
+		for (auto& pair : collection)
+		{
+			for (const LayoutParser::Object* object : pair.second)
+			{
+				std::vector<const LayoutParser::Object*> objects;
+				CollectObjects(object, objects);
+				for (const LayoutParser::Object* nested : objects)
+					types.insert(nested->GetIdentifier());
+			}
+		}
+		for (std::string_view type : types)
+			out << type << " " << index.GetObjectsOfType(collection.FindSymbol(type)).Size() << "\n";
+		return out.str();
+	}
+
+	// Layouts defined a second time with an extra object in them, and broken text that stops
+	// the parser halfway through a layout. Neither may leave anything behind in the index.
+	bool CheckObjectIndex(uint64_t seed)
+	{
+		constexpr int32_t TextCount = 40;
+
+		LayoutParser::ParseOptions options;
+		options.BuildIndex = true;
+
+		std::mt19937_64 random(seed);
+		const std::string generated = CorpusGenerator(seed).Generate(CorpusShape::Shipped, 64 * 1024);
+
+		bool isSame = true;
+		size_t duplicateCount = 0;
+		for (int32_t i = 0; i < TextCount; i++)
+		{
+			std::string text = generated;
+			for (int32_t copy = 0; copy < 3; copy++)
+			{
+				// A copy of a layout that comes before it, with one more object at the end
+				size_t layoutEnd = text.find("\n}\n", random() % text.length());
+				if (layoutEnd == std::string::npos)
+					continue;
+				size_t layoutStart = text.rfind("Layout", layoutEnd);
+				std::string duplicate = text.substr(layoutStart, layoutEnd + 1 - layoutStart) +
+					"\t<Frame() ID = \"extra\", ZIndex = 1>\n\t<Frame() ID = \"frame0\">\n}\n";
+				text.insert(layoutEnd + 3, duplicate);
+			}
+
+			if (i % 2 == 1)
+				text = Mutate(text, random, 2);
+
+			LayoutParser::LayoutCollection collection = LayoutParser::LayoutCollection::LoadFromString(text, options);
+			const LayoutParser::DiagnosticCollection& diagnostics = collection.GetDiagnostics();
+			for (size_t j = 0; j < diagnostics.Size(); j++)
+				duplicateCount += diagnostics[j].Code == LayoutParser::DiagnosticCode::DuplicateLayout;
+
+			if (ReportDifference("index", "text " + std::to_string(i), DumpExpectedIndex(collection), DumpIndex(collection)))
+				isSame = false;
+		}
+
+		std::cout << "Index:    " << TextCount << " texts, " << duplicateCount << " duplicate layouts, " <<
+			(isSame ? "nothing left" : "objects left") << " in the index\n";
+		return isSame;
+	}
+
+	// Lazy collections report what a layout's parse found with the layout name in front and
+	// only once it has been touched, so the messages are compared without it and sorted
+	std::string DumpUnprefixedDiagnostics(LayoutParser::LayoutCollection& collection)
+	{
+		const LayoutParser::DiagnosticCollection& diagnostics = collection.GetDiagnostics();
+		std::vector<std::string> messages;
+		for (size_t i = 0; i < diagnostics.Size(); i++)
+		{
+			std::string message = diagnostics.Format(diagnostics[i]);
+			size_t prefixLength = diagnostics[i].Source.Length;
+			messages.push_back(prefixLength > 0 ? message.substr(prefixLength + 2) : message);
+		}
+		std::sort(messages.begin(), messages.end());
+
+		std::ostringstream out;
+		for (const std::string& message : messages)
+			out << "! " << message << "\n";
+		return out.str();
+	}
+
+	// Text that splits cleanly into layouts is loaded lazily, anything else falls back to the
+	// eager parse. A layout with an error in its body only shows up once it's touched, and from
+	// there the two can recover differently: the eager parser carries on from wherever it got to,
+	// a lazy layout ends at its closing brace. So the trees are only compared exactly for text
+	// that loads cleanly, and for text broken between a layout name and its brace, which has to
+	// fall back. Anything else just has to report a problem as well.
+	bool CheckLoadFromStringLazy(uint64_t seed)
+	{
+		constexpr int32_t MutationCount = 30;
+
+		std::mt19937_64 random(seed);
+		bool isSame = true;
+		int32_t textCount = 0;
+		int32_t comparedCount = 0;
+		for (CorpusShape shape : { CorpusShape::Shipped, CorpusShape::Deep, CorpusShape::Errors })
+		{
+			std::string generated = CorpusGenerator(seed).Generate(shape, 32 * 1024);
+			for (int32_t i = 0; i <= MutationCount; i++, textCount++)
+			{
+				std::string text = generated;
+				// Only generated text without errors gets compared after that, see above
+				bool isHeaderBroken = (i % 2 == 1) && shape != CorpusShape::Errors;
+				if (isHeaderBroken)
+				{
+					// Every generated layout opens with its name and the brace on the next line
+					size_t brace = text.find("\n{\n", random() % text.length());
+					if (brace == std::string::npos)
+						brace = text.find("\n{\n");
+					text.insert(brace, Snippets[random() % (sizeof(Snippets) / sizeof(Snippets[0]))]);
+				}
+				else if (i > 0)
+					text = Mutate(text, random, 1 + i % 3);
+
+				LayoutParser::LayoutCollection eager = LayoutParser::LayoutCollection::LoadFromString(text);
+				LayoutParser::LayoutCollection lazy = LayoutParser::LayoutCollection::LoadFromStringLazy(text);
+
+				// The layouts first, a lazy one only knows its diagnostics after that
+				std::string expected = DumpLayouts(eager);
+				expected += DumpUnprefixedDiagnostics(eager);
+				std::string actual = DumpLayouts(lazy);
+				actual += DumpUnprefixedDiagnostics(lazy);
+
+				std::string what = "shape " + std::to_string(static_cast<int32_t>(shape)) + " mutation " + std::to_string(i);
+				if (isHeaderBroken || eager.GetDiagnostics().IsEmpty())
+				{
+					comparedCount++;
+					if (ReportDifference("lazy", what, expected, actual))
+						isSame = false;
+				}
+				else if (lazy.GetDiagnostics().IsEmpty())
+				{
+					std::cout << "lazy: " << what << " has problems, but not once loaded lazily\n";
+					isSame = false;
+				}
+			}
+		}
+
+		std::cout << "Lazy:     " << textCount << " texts, " << comparedCount << " compared, " << (isSame ? "same" : "different") << " once touched\n";
+		return isSame;
+	}
+
+	struct Check
+	{
+		const char* Name;
+		bool (*Run)(uint64_t seed);
+	};
+
+	const Check Checks[] = {
+		{ "files", CheckLoadFromFiles },
+		{ "parallel", CheckLoadFromStringParallel },
+		{ "structural", CheckStructuralIndex },
+		{ "reparse", CheckReparse },
+		{ "index", CheckObjectIndex },
+		{ "lazy", CheckLoadFromStringLazy },
+	};
+}
+
+bool RunCheck(const char* name, uint64_t seed)
+{
+	for (const Check& check : Checks)
+	{
+		if (std::strcmp(check.Name, name) == 0)
+			return check.Run(seed);
+	}
+
+	std::cout << "There is no check called " << name << "\n";
+	return false;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstdint>
+
+// Differential checks run by ctest. Each one gets the same result two ways, on generated text
+// and on randomly mutated copies of it, and prints the first difference it finds. The seed
+// picks the text and the mutations, so a failure can be reproduced with the same one.
+// Returns false on a mismatch or for an unknown check.
+bool RunCheck(const char* name, uint64_t seed);
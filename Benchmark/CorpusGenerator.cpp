@@ -0,0 +1,232 @@
+#include "CorpusGenerator.h"
+
+CorpusGenerator::CorpusGenerator(uint64_t seed)
+	: m_State(seed)
+{
+}
+
+std::string CorpusGenerator::Generate(CorpusShape shape, size_t targetSize)
+{
+	std::ostringstream text;
+	for (int32_t layout = 0; static_cast<size_t>(text.tellp()) < targetSize; layout++)
+	{
+		switch (shape)
+		{
+		case CorpusShape::Shipped:
+			WriteShippedLayout(text, layout, false);
+			break;
+		case CorpusShape::Wide:
+			WriteWideLayout(text, layout);
+			break;
+		case CorpusShape::Deep:
+			WriteDeepLayout(text, layout);
+			break;
+		case CorpusShape::Expressions:
+			WriteExpressionLayout(text, layout);
+			break;
+		case CorpusShape::Strings:
+			WriteStringLayout(text, layout);
+			break;
+		case CorpusShape::Errors:
+			WriteShippedLayout(text, layout, true);
+			break;
+		}
+	}
+	return text.str();
+}
+
+const char* CorpusGenerator::GetShapeName(CorpusShape shape)
+{
+	switch (shape)
+	{
+	case CorpusShape::Shipped: return "shipped";
+	case CorpusShape::Wide: return "wide";
+	case CorpusShape::Deep: return "deep";
+	case CorpusShape::Expressions: return "expressions";
+	case CorpusShape::Strings: return "strings";
+	case CorpusShape::Errors: return "errors";
+	}
+	return "unknown";
+}
+
+uint64_t CorpusGenerator::Next()
+{
+	uint64_t value = (m_State += 0x9E3779B97F4A7C15ull);
+	value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+	value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+	return value ^ (value >> 31);
+}
+
+void CorpusGenerator::WriteShippedLayout(std::ostringstream& text, int32_t layout, bool withErrors)
+{
+	// Each mistake is one the parser recovers from within the object, an unterminated string
+	// would swallow the rest of the file instead
+	static const char* mistakes[] = {
+		"\t\tAlpha = 0.5.5,\n", // invalid number
+		"\t\tRoundness = 10 Alpha = 0.5,\n", // missing comma
+		"\t\tZIndex = 1 @,\n", // bad character
+		"\t\tHorizontalBias = (1/2,\n", // mismatched parentheses
+		"\t\tFill = #33CG22,\n", // bad hex color
+		"\t\tWidth = <ScaleSize(0.2) Bias = >,\n", // missing value
+	};
+
+	int32_t objectCount = 20 + NextBelow(60);
+
+	text << "Layout" << layout << "\n{\n";
+	for (int32_t object = 0; object < objectCount; object++)
+	{
+		text <<
+			"\t<Frame()\n"
+			"\t\tID = \"frame" << object << "\",\n"
+			"\t\tHorizontalBias = 1/2, VerticalBias = 1/2, ZIndex = " << NextBelow(100) << ",\n"
+			"\t\tFill = #33CC22, Roundness = " << NextBelow(20) << ", Alpha = 0.5,\n";
+
+		if (withErrors && NextBelow(4) != 0)
+			text << mistakes[NextBelow(sizeof(mistakes) / sizeof(mistakes[0]))];
+
+		text <<
+			"\t\tWidth = <ScaleSize(0.2)>, Height = <AspectSize(1)>,\n"
+			"\t\tTags = {\"a\", \"b\", \"c\"},\n"
+			"\t\tConstraints = [\n"
+			"\t\t\tTop = <SpringConstraint() Target = \"Window\", TargetSide = \"Top\">,\n"
+			"\t\t\tBottom = <SpringConstraint() Target = \"Window\", TargetSide = \"Bottom\">,\n"
+			"\t\t\tLeft = <SpringConstraint() Target = \"Window\", TargetSide = \"Left\">,\n"
+			"\t\t\tRight = <SpringConstraint() Target = \"Window\", TargetSide = \"Right\">\n"
+			"\t\t]\n"
+			"\t>\n";
+	}
+	text << "}\n";
+}
+
+void CorpusGenerator::WriteWideLayout(std::ostringstream& text, int32_t layout)
+{
+	int32_t objectCount = 2000 + NextBelow(2000);
+
+	text << "Wide" << layout << "\n{\n";
+	for (int32_t object = 0; object < objectCount; object++)
+		text << "\t<Label(" << NextBelow(1000) << ") ID = \"label" << object << "\", Visible = " << (NextBelow(2) ? "true" : "false") << ">\n";
+	text << "}\n";
+}
+
+void CorpusGenerator::WriteDeepLayout(std::ostringstream& text, int32_t layout)
+{
+	int32_t objectCount = 10 + NextBelow(10);
+
+	text << "Deep" << layout << "\n{\n";
+	for (int32_t object = 0; object < objectCount; object++)
+	{
+		// Stays below the default ParseOptions::MaxDepth
+		text << "\t<Node() Child = ";
+		WriteNested(text, 64 + NextBelow(128));
+		text << ">\n";
+	}
+	text << "}\n";
+}
+
+void CorpusGenerator::WriteExpressionLayout(std::ostringstream& text, int32_t layout)
+{
+	int32_t objectCount = 20 + NextBelow(20);
+
+	text << "Math" << layout << "\n{\n";
+	for (int32_t object = 0; object < objectCount; object++)
+	{
+		text << "\t<Frame()\n\t\tWidth = ";
+		WriteExpression(text, 50 + NextBelow(200));
+		text << ",\n\t\tHeight = ";
+		WriteExpression(text, 50 + NextBelow(200));
+		text << "\n\t>\n";
+	}
+	text << "}\n";
+}
+
+void CorpusGenerator::WriteStringLayout(std::ostringstream& text, int32_t layout)
+{
+	int32_t objectCount = 20 + NextBelow(40);
+
+	text << "Text" << layout << "\n{\n";
+	for (int32_t object = 0; object < objectCount; object++)
+	{
+		text << "\t<Paragraph()\n\t\tText = \"";
+		for (uint32_t word = 0, wordCount = 40 + NextBelow(200); word < wordCount; word++)
+		{
+			if (word != 0)
+				text << ' ';
+			WriteWord(text);
+		}
+
+		text << "\",\n\t\tKeywords = {";
+		for (uint32_t keyword = 0, keywordCount = 5 + NextBelow(20); keyword < keywordCount; keyword++)
+		{
+			text << (keyword == 0 ? "\"" : ", \"");
+			WriteWord(text);
+			text << '"';
+		}
+		text << "}\n\t>\n";
+	}
+	text << "}\n";
+}
+
+void CorpusGenerator::WriteNested(std::ostringstream& text, int32_t depth)
+{
+	if (depth == 0)
+	{
+		text << NextBelow(100);
+		return;
+	}
+
+	switch (NextBelow(3))
+	{
+	case 0:
+		text << "<Node() Child = ";
+		WriteNested(text, depth - 1);
+		text << '>';
+		break;
+	case 1:
+		text << '{';
+		WriteNested(text, depth - 1);
+		text << ", " << NextBelow(100) << '}';
+		break;
+	case 2:
+		text << "[Child = ";
+		WriteNested(text, depth - 1);
+		text << ']';
+		break;
+	}
+}
+
+void CorpusGenerator::WriteExpression(std::ostringstream& text, int32_t terms)
+{
+	static const char operators[] = { '+', '-', '*', '/' };
+
+	int32_t openCount = 0;
+	for (int32_t term = 0; term < terms; term++)
+	{
+		if (term != 0)
+			text << ' ' << operators[NextBelow(4)] << ' ';
+
+		if (NextBelow(4) == 0)
+		{
+			text << '(';
+			openCount++;
+		}
+
+		text << 1 + NextBelow(999);
+		if (NextBelow(4) == 0)
+			text << '.' << NextBelow(100);
+
+		if (openCount > 0 && NextBelow(3) == 0)
+		{
+			text << ')';
+			openCount--;
+		}
+	}
+
+	for (; openCount > 0; openCount--)
+		text << ')';
+}
+
+void CorpusGenerator::WriteWord(std::ostringstream& text)
+{
+	for (uint32_t letter = 0, length = 2 + NextBelow(9); letter < length; letter++)
+		text << static_cast<char>('a' + NextBelow(26));
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+#include <sstream>
+#include <cstdint>
+
+enum class CorpusShape
+{
+	Shipped, // frames with constraint dictionaries, like the layouts we ship
+	Wide, // few layouts with thousands of small objects each
+	Deep, // objects, lists and dictionaries nested far down
+	Expressions, // long arithmetic expressions with parentheses
+	Strings, // long strings and lists of them
+	Errors, // shipped layouts with a mistake in most objects
+};
+
+// Builds .lp text of a given shape and roughly a given size. The same seed gives the same
+// text on every platform, so results can be compared across machines and releases.
+class CorpusGenerator
+{
+public:
+	explicit CorpusGenerator(uint64_t seed);
+
+	// Keeps adding layouts until the text is at least targetSize bytes
+	std::string Generate(CorpusShape shape, size_t targetSize);
+
+	static const char* GetShapeName(CorpusShape shape);
+
+private:
+	uint64_t m_State;
+
+	// splitmix64, the standard distributions aren't the same across standard libraries
+	uint64_t Next();
+	inline uint32_t NextBelow(uint32_t bound) { return static_cast<uint32_t>(Next() % bound); }
+
+	void WriteShippedLayout(std::ostringstream& text, int32_t layout, bool withErrors);
+	void WriteWideLayout(std::ostringstream& text, int32_t layout);
+	void WriteDeepLayout(std::ostringstream& text, int32_t layout);
+	void WriteExpressionLayout(std::ostringstream& text, int32_t layout);
+	void WriteStringLayout(std::ostringstream& text, int32_t layout);
+
+	void WriteNested(std::ostringstream& text, int32_t depth);
+	void WriteExpression(std::ostringstream& text, int32_t terms);
+	void WriteWord(std::ostringstream& text);
+};
@@ -0,0 +1,699 @@
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <cstdio>
+#include <chrono>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include <memory>
+#include <limits>
+#include <optional>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "psapi.lib")
+#endif
+#else
+#include <sys/resource.h>
+#endif
+
+#include "LayoutParser/LayoutParser.h"
+
+#include "Analysis/Lexer.h"
+#include "Analysis/Parser.h"
+#include "Analysis/CharacterScanner.h"
+#include "Analysis/TokenBuffer.h"
+#include "Analysis/StructuralIndex.h"
+#include "Data/Arena.h"
+
+#include "CorpusGenerator.h"
+#include "SnapshotStress.h"
+#include "Checks.h"
+
+// Global allocation counters. Every operator new in the process goes through here
+// so the numbers include the parser, the containers and the strings.
+static std::atomic<size_t> s_AllocationCount = 0;
+static std::atomic<size_t> s_FreeCount = 0;
+static std::atomic<size_t> s_BytesAllocated = 0;
+
+void* operator new(size_t size)
+{
+	s_AllocationCount++;
+	s_BytesAllocated += size;
+	if (void* memory = std::malloc(size == 0 ? 1 : size))
+		return memory;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+	if (memory == nullptr)
+		return;
+	s_FreeCount++;
+	std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+	operator delete(memory);
+}
+
+// std::pmr::new_delete_resource, and with it the arena, goes through the aligned overloads
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	s_AllocationCount++;
+	s_BytesAllocated += size;
+
+	size_t alignmentValue = static_cast<size_t>(alignment);
+	size_t paddedSize = (size + alignmentValue - 1) / alignmentValue * alignmentValue;
+#ifdef _MSC_VER
+	if (void* memory = _aligned_malloc(paddedSize == 0 ? alignmentValue : paddedSize, alignmentValue))
+#else
+	if (void* memory = std::aligned_alloc(alignmentValue, paddedSize == 0 ? alignmentValue : paddedSize))
+#endif
+		return memory;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept
+{
+	if (memory == nullptr)
+		return;
+	s_FreeCount++;
+#ifdef _MSC_VER
+	_aligned_free(memory);
+#else
+	std::free(memory);
+#endif
+}
+
+void operator delete(void* memory, size_t, std::align_val_t alignment) noexcept
+{
+	operator delete(memory, alignment);
+}
+
+struct AllocationSnapshot
+{
+	size_t Allocations;
+	size_t Frees;
+	size_t Bytes;
+
+	static AllocationSnapshot Take() { return { s_AllocationCount.load(), s_FreeCount.load(), s_BytesAllocated.load() }; }
+
+	AllocationSnapshot operator-(const AllocationSnapshot& other) const
+	{
+		return { Allocations - other.Allocations, Frees - other.Frees, Bytes - other.Bytes };
+	}
+};
+
+// High water mark of the whole process, it only ever goes up
+static size_t GetPeakResidentBytes()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return counters.PeakWorkingSetSize;
+	return 0;
+#else
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+#ifdef __APPLE__
+	return static_cast<size_t>(usage.ru_maxrss);
+#else
+	return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+// Builds a file shaped like the layouts we ship: a few hundred top-level layouts
+// with frames that each carry a constraint dictionary of nested objects.
+static std::string GenerateCorpus(int32_t layoutCount, int32_t objectsPerLayout)
+{
+	std::stringstream text;
+	for (int32_t layout = 0; layout < layoutCount; layout++)
+	{
+		text << "Layout" << layout << "\n{\n";
+		for (int32_t object = 0; object < objectsPerLayout; object++)
+		{
+			text <<
+				"\t<Frame()\n"
+				"\t\tID = \"frame" << object << "\",\n"
+				"\t\tHorizontalBias = 1/2, VerticalBias = 1/2, ZIndex = " << object << ",\n"
+				"\t\tFill = #33CC22, Roundness = 10, Alpha = 0.5,\n"
+				"\t\tWidth = <ScaleSize(0.2)>, Height = <AspectSize(1)>,\n"
+				"\t\tTags = {\"a\", \"b\", \"c\"},\n"
+				"\t\tConstraints = [\n"
+				"\t\t\tTop = <SpringConstraint() Target = \"Window\", TargetSide = \"Top\">,\n"
+				"\t\t\tBottom = <SpringConstraint() Target = \"Window\", TargetSide = \"Bottom\">,\n"
+				"\t\t\tLeft = <SpringConstraint() Target = \"Window\", TargetSide = \"Left\">,\n"
+				"\t\t\tRight = <SpringConstraint() Target = \"Window\", TargetSide = \"Right\">\n"
+				"\t\t]\n"
+				"\t>\n";
+		}
+		text << "}\n";
+	}
+	return text.str();
+}
+
+template<typename Function>
+static double MeasureMilliseconds(Function&& function)
+{
+	auto start = std::chrono::steady_clock::now();
+	function();
+	auto end = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Best of a few runs, and the allocations of the first one
+template<typename Function>
+static std::pair<double, AllocationSnapshot> MeasureBest(int32_t runCount, Function&& function)
+{
+	double best = 0.0;
+	AllocationSnapshot allocations = {};
+	for (int32_t run = 0; run < runCount; run++)
+	{
+		AllocationSnapshot before = AllocationSnapshot::Take();
+		double runTime = MeasureMilliseconds(function);
+		if (run == 0)
+			allocations = AllocationSnapshot::Take() - before;
+		if (run == 0 || runTime < best)
+			best = runTime;
+	}
+	return { best, allocations };
+}
+
+struct StageResult
+{
+	double Milliseconds;
+	AllocationSnapshot Allocations;
+};
+
+struct SuiteResult
+{
+	CorpusShape Shape;
+	size_t Bytes;
+	size_t Tokens;
+	size_t Diagnostics;
+
+	StageResult Lex; // lexer only, nothing kept
+	StageResult Parse; // the parser pulling tokens from the lexer, so lexing is part of it
+	StageResult Load; // LoadFromString, everything up to a collection
+
+	static double GetMegabytesPerSecond(size_t bytes, double milliseconds) { return milliseconds > 0.0 ? bytes / (milliseconds * 1000.0) : 0.0; }
+
+	// The parser can't run without lexing, so the parser's own share is what's left after the lexer
+	inline double GetParseOnlyMilliseconds() const { return std::max(Parse.Milliseconds - Lex.Milliseconds, 0.0); }
+};
+
+// Every shape through the lexer, the parser and the full load. Errors aren't capped so
+// the error-heavy corpus is parsed all the way through like the others.
+static SuiteResult RunSuite(CorpusShape shape, const std::string& corpus)
+{
+	constexpr int32_t RunCount = 3;
+
+	SuiteResult result = {};
+	result.Shape = shape;
+	result.Bytes = corpus.size();
+
+	LayoutParser::ParseOptions options;
+	options.MaxErrors = std::numeric_limits<size_t>::max();
+
+	// Token by token like the parser pulls them, filling a TokenBuffer would cost more than the parser pays
+	{
+		auto lex = MeasureBest(RunCount, [&]() {
+			LayoutParser::DiagnosticCollection diagnostics;
+			LayoutParser::Lexer lexer(corpus, diagnostics);
+
+			result.Tokens = 0;
+			while (lexer.Lex().Kind != LayoutParser::SyntaxKind::EndOfFileToken)
+				result.Tokens++;
+		});
+		result.Lex = { lex.first, lex.second };
+	}
+
+	{
+		auto parse = MeasureBest(RunCount, [&]() {
+			LayoutParser::Arena arena;
+			LayoutParser::SymbolTable symbols;
+			LayoutParser::Parser(corpus, arena, symbols, 0, options).Parse();
+		});
+		result.Parse = { parse.first, parse.second };
+	}
+
+	{
+		auto load = MeasureBest(RunCount, [&]() {
+			result.Diagnostics = LayoutParser::LayoutCollection::LoadFromString(corpus, options).GetDiagnostics().Size();
+		});
+		result.Load = { load.first, load.second };
+	}
+
+	return result;
+}
+
+static void WriteStageJson(std::ostream& json, const char* name, const StageResult& stage, size_t bytes)
+{
+	json << "\"" << name << "\": { \"ms\": " << stage.Milliseconds <<
+		", \"mb_per_s\": " << SuiteResult::GetMegabytesPerSecond(bytes, stage.Milliseconds) <<
+		", \"allocations\": " << stage.Allocations.Allocations <<
+		", \"bytes_requested\": " << stage.Allocations.Bytes << " }";
+}
+
+// One object per run, meant to be kept next to the release it was measured on and diffed.
+// Peak RSS is the high water mark of the whole process, so it's only reported once for the run.
+static void WriteSuiteJson(const std::string& path, uint64_t seed, const std::vector<SuiteResult>& results)
+{
+	std::ofstream json(path, std::ios::out | std::ios::binary);
+	json << "{\n"
+		"  \"seed\": " << seed << ",\n"
+		"  \"scanner\": \"" << LayoutParser::CharacterScanner::GetImplementationName() << "\",\n"
+		"  \"structural_index\": \"" << LayoutParser::StructuralIndex::GetImplementationName() << "\",\n"
+		"  \"peak_rss_bytes\": " << GetPeakResidentBytes() << ",\n"
+		"  \"corpora\": [\n";
+
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		const SuiteResult& result = results[i];
+		json << "    { \"shape\": \"" << CorpusGenerator::GetShapeName(result.Shape) << "\", \"bytes\": " << result.Bytes <<
+			", \"tokens\": " << result.Tokens << ", \"diagnostics\": " << result.Diagnostics << ",\n      ";
+		WriteStageJson(json, "lex", result.Lex, result.Bytes);
+		json << ",\n      ";
+		WriteStageJson(json, "parse", result.Parse, result.Bytes);
+		json << ",\n      \"parse_only\": { \"ms\": " << result.GetParseOnlyMilliseconds() <<
+			", \"mb_per_s\": " << SuiteResult::GetMegabytesPerSecond(result.Bytes, result.GetParseOnlyMilliseconds()) << " },\n      ";
+		WriteStageJson(json, "end_to_end", result.Load, result.Bytes);
+		json << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+	}
+
+	json << "  ]\n}\n";
+}
+
+// Every reader thread calls makeReader once and then reads as fast as it can while write runs
+// on this thread. Returns the number of reads and how many of them saw an inconsistent tree.
+template<typename MakeReader, typename Write>
+static std::pair<size_t, size_t> MeasureConcurrentReads(uint32_t readerCount, MakeReader&& makeReader, Write&& write)
+{
+	std::atomic<bool> isRunning = true;
+	std::atomic<size_t> readCount = 0;
+	std::atomic<size_t> tornCount = 0;
+
+	std::vector<std::thread> readers;
+	for (uint32_t i = 0; i < readerCount; i++)
+	{
+		readers.emplace_back([&]() {
+			auto read = makeReader();
+			size_t reads = 0;
+			while (isRunning.load(std::memory_order_relaxed))
+			{
+				if (!read())
+					tornCount++;
+				reads++;
+			}
+			readCount += reads;
+		});
+	}
+
+	write();
+
+	isRunning = false;
+	for (std::thread& reader : readers)
+		reader.join();
+	return { readCount.load(), tornCount.load() };
+}
+
+// Benchmark [layouts] [objects per layout] [--seed N] [--size MiB] [--json path]
+// Benchmark --stress [milliseconds] only runs the SnapshotStore stress test and fails if it does
+// Benchmark --check <name> [seed] only runs one of the checks in Checks.cpp and fails if it does
+int main(int argc, char** argv)
+{
+	if (argc >= 2 && std::strcmp(argv[1], "--stress") == 0)
+	{
+		std::chrono::milliseconds duration(argc >= 3 ? std::atoi(argv[2]) : 2000);
+		return RunSnapshotStress(duration) ? 0 : 1;
+	}
+
+	if (argc >= 3 && std::strcmp(argv[1], "--check") == 0)
+		return RunCheck(argv[2], argc >= 4 ? std::strtoull(argv[3], nullptr, 10) : 1) ? 0 : 1;
+
+	int32_t layoutCount = 200;
+	int32_t objectsPerLayout = 50;
+	uint64_t seed = 1;
+	size_t suiteSize = 8;
+	const char* jsonPath = nullptr;
+
+	for (int32_t i = 1, positional = 0; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+			seed = std::strtoull(argv[++i], nullptr, 10);
+		else if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+			suiteSize = std::strtoull(argv[++i], nullptr, 10);
+		else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+			jsonPath = argv[++i];
+		else if (positional++ == 0)
+			layoutCount = std::atoi(argv[i]);
+		else
+			objectsPerLayout = std::atoi(argv[i]);
+	}
+
+	std::string corpus = GenerateCorpus(layoutCount, objectsPerLayout);
+	std::cout << "Corpus: " << layoutCount << " layouts x " << objectsPerLayout << " objects, " <<
+		corpus.size() / 1024 << " KiB\n\n";
+
+	{
+		LayoutParser::TokenBuffer tokens;
+		LayoutParser::DiagnosticCollection diagnostics;
+
+		AllocationSnapshot beforeLex = AllocationSnapshot::Take();
+		LayoutParser::Lexer(corpus, diagnostics).LexAll(tokens);
+		AllocationSnapshot lex = AllocationSnapshot::Take() - beforeLex;
+
+		// Best of a few runs, a single lex of a few megabytes is too noisy on its own
+		double lexTime = 0.0;
+		for (int32_t run = 0; run < 5; run++)
+		{
+			tokens.Clear();
+			double runTime = MeasureMilliseconds([&]() { LayoutParser::Lexer(corpus, diagnostics).LexAll(tokens); });
+			if (run == 0 || runTime < lexTime)
+				lexTime = runTime;
+		}
+
+		// A SyntaxToken used to be kind + position + std::string + float, 48 bytes on x64 MSVC
+		std::cout << "Lex:      " << lexTime << " ms, " << tokens.Size() << " tokens, " << lex.Allocations << " allocations, " <<
+			tokens.GetMemoryUsage() / 1024 << " KiB token buffer (" << tokens.Size() * 48 / 1024 << " KiB as 48 byte tokens)\n";
+		std::cout << "          " << corpus.size() / (lexTime * 1000.0) << " MB/s with the " <<
+			LayoutParser::CharacterScanner::GetImplementationName() << " scanners\n";
+	}
+
+	// The structural pre-pass against the full lexer above, same best of five
+	{
+		LayoutParser::StructuralIndex index;
+
+		double indexTime = 0.0;
+		for (int32_t run = 0; run < 5; run++)
+		{
+			double runTime = MeasureMilliseconds([&]() { index.Build(corpus); });
+			if (run == 0 || runTime < indexTime)
+				indexTime = runTime;
+		}
+
+		std::cout << "Index:    " << indexTime << " ms, " << index.Size() << " structural characters\n";
+		std::cout << "          " << corpus.size() / (indexTime * 1000.0) << " MB/s with " <<
+			LayoutParser::StructuralIndex::GetImplementationName() << "\n";
+	}
+
+	// Heap allocate the collection so construction and teardown can be measured separately
+	LayoutParser::LayoutCollection* collection = nullptr;
+
+	AllocationSnapshot beforeLoad = AllocationSnapshot::Take();
+	double loadTime = MeasureMilliseconds([&]() {
+		collection = new LayoutParser::LayoutCollection(LayoutParser::LayoutCollection::LoadFromString(corpus));
+	});
+	AllocationSnapshot load = AllocationSnapshot::Take() - beforeLoad;
+
+	// Only there when the library was built with LAYOUTPARSER_ENABLE_STATS
+	std::optional<LayoutParser::ParseStats> loadStats;
+	if (collection->GetStats() != nullptr)
+		loadStats = *collection->GetStats();
+
+	AllocationSnapshot beforeTeardown = AllocationSnapshot::Take();
+	double teardownTime = MeasureMilliseconds([&]() { delete collection; });
+	AllocationSnapshot teardown = AllocationSnapshot::Take() - beforeTeardown;
+
+	std::cout << "Load:     " << loadTime << " ms, " << load.Allocations << " allocations, " <<
+		load.Frees << " frees, " << load.Bytes / 1024 << " KiB requested\n";
+	std::cout << "Teardown: " << teardownTime << " ms, " << teardown.Frees << " frees\n";
+	if (loadStats)
+	{
+		std::cout << "Stats:    " << loadStats->ReadMilliseconds << " ms read, " << loadStats->LexMilliseconds << " ms lex, " <<
+			loadStats->ParseMilliseconds << " ms parse, " << loadStats->BuildMilliseconds << " ms build, " << loadStats->Objects << " objects, " <<
+			loadStats->Allocations << " arena allocations, nesting depth " << loadStats->MaxDepth << "\n";
+	}
+
+	// Top-level layouts split across every core
+	{
+		double parallelTime = MeasureMilliseconds([&]() { LayoutParser::LayoutCollection::LoadFromStringParallel(corpus); });
+		std::cout << "Parallel: " << parallelTime << " ms on " << std::max(std::thread::hardware_concurrency(), 1u) << " threads\n";
+	}
+
+	// One keystroke in the middle of the corpus, a digit of a ZIndex changes
+	{
+		LayoutParser::LayoutCollection previous = LayoutParser::LayoutCollection::LoadFromString(corpus);
+
+		std::string edited = corpus;
+		size_t editStart = edited.find("ZIndex = ", edited.length() / 2) + 9;
+		edited[editStart] = (edited[editStart] == '9') ? '1' : '9';
+
+		AllocationSnapshot beforeReparse = AllocationSnapshot::Take();
+		double reparseTime = MeasureMilliseconds([&]() { previous.Reparse(edited, { editStart, 1, 1 }); });
+		AllocationSnapshot reparse = AllocationSnapshot::Take() - beforeReparse;
+
+		std::cout << "Reparse:  " << reparseTime << " ms, " << reparse.Allocations << " allocations for a one character edit\n";
+	}
+
+	// Two bad numbers in every object, like a file halfway through an edit. Messages are only
+	// built when they're read, so that part is measured on its own.
+	{
+		std::string broken = corpus;
+		for (size_t position = broken.find("Alpha = 0.5"); position != std::string::npos; position = broken.find("Alpha = 0.5", position))
+		{
+			broken.replace(position, 11, "Alpha = 0.5.5, Roundness = 1 0");
+			position += 11;
+		}
+
+		LayoutParser::LayoutCollection* brokenCollection = nullptr;
+		double brokenTime = MeasureMilliseconds([&]() {
+			brokenCollection = new LayoutParser::LayoutCollection(LayoutParser::LayoutCollection::LoadFromString(broken));
+		});
+
+		size_t messageLength = 0;
+		double formatTime = MeasureMilliseconds([&]() {
+			for (const std::string& message : brokenCollection->GetDiagnostics())
+				messageLength += message.length();
+		});
+
+		std::cout << "Broken:   " << brokenTime << " ms for " << brokenCollection->GetDiagnostics().Size() << " diagnostics, " <<
+			formatTime << " ms to format all of them\n";
+		delete brokenCollection;
+	}
+
+	// Only the layout names up front, then a single layout the first time it's touched
+	{
+		LayoutParser::LayoutCollection* lazy = nullptr;
+
+		AllocationSnapshot beforeLazy = AllocationSnapshot::Take();
+		double lazyTime = MeasureMilliseconds([&]() {
+			lazy = new LayoutParser::LayoutCollection(LayoutParser::LayoutCollection::LoadFromStringLazy(corpus));
+		});
+		AllocationSnapshot lazyLoad = AllocationSnapshot::Take() - beforeLazy;
+
+		double firstAccessTime = MeasureMilliseconds([&]() { lazy->LastLayout().Size(); });
+		delete lazy;
+
+		std::cout << "Lazy:     " << lazyTime << " ms, " << lazyLoad.Allocations << " allocations, " <<
+			lazyLoad.Bytes / 1024 << " KiB requested, " << firstAccessTime << " ms to parse one layout\n";
+	}
+
+	// Same corpus through the file path, which maps the file instead of copying it around
+	{
+		const char* corpusPath = "benchmark_corpus.lp";
+		std::ofstream(corpusPath, std::ios::out | std::ios::binary) << corpus;
+
+		AllocationSnapshot beforeFile = AllocationSnapshot::Take();
+		double fileTime = MeasureMilliseconds([&]() { LayoutParser::LayoutCollection::LoadFromFile(corpusPath); });
+		AllocationSnapshot file = AllocationSnapshot::Take() - beforeFile;
+
+		std::cout << "File:     " << fileTime << " ms, " << file.Allocations << " allocations, " << file.Bytes / 1024 << " KiB requested\n";
+		std::remove(corpusPath);
+	}
+
+	// Compiled once, then loaded without lexing or parsing
+	{
+		const char* binaryPath = "benchmark_corpus.lpb";
+		LayoutParser::LayoutCollection::LoadFromString(corpus).SaveBinary(binaryPath);
+
+		AllocationSnapshot beforeBinary = AllocationSnapshot::Take();
+		double binaryTime = MeasureMilliseconds([&]() { LayoutParser::LayoutCollection::LoadBinary(binaryPath); });
+		AllocationSnapshot binary = AllocationSnapshot::Take() - beforeBinary;
+
+		std::cout << "Binary:   " << binaryTime << " ms, " << binary.Allocations << " allocations, " << binary.Bytes / 1024 << " KiB requested\n";
+		std::remove(binaryPath);
+	}
+
+	// Back out as canonical source, as the tree dump and as JSON, all into memory
+	{
+		LayoutParser::LayoutCollection loaded = LayoutParser::LayoutCollection::LoadFromString(corpus);
+
+		std::string source;
+		double writeTime = MeasureMilliseconds([&]() { source = loaded.SaveToString(); });
+
+		std::ostringstream tree;
+		double printTime = MeasureMilliseconds([&]() { LayoutParser::LayoutCollection::PrettyPrint(loaded, tree); });
+
+		std::cout << "Write:    " << writeTime << " ms, " << source.size() / (writeTime * 1000.0) << " MB/s of canonical source\n";
+		std::cout << "Print:    " << printTime << " ms, " << tree.tellp() / (printTime * 1000.0) << " MB/s of tree\n";
+
+		std::string json;
+		double jsonWriteTime = MeasureMilliseconds([&]() { json = loaded.SaveToJson(); });
+		double jsonReadTime = MeasureMilliseconds([&]() { LayoutParser::LayoutCollection::LoadFromJson(json); });
+
+		std::cout << "Json:     " << jsonWriteTime << " ms write, " << jsonReadTime << " ms read, "
+			<< json.size() / (jsonWriteTime * 1000.0) << " / " << json.size() / (jsonReadTime * 1000.0) << " MB/s\n";
+	}
+
+	// Bindings of one layout resolved with compiled queries, one by one and as a batch
+	{
+		LayoutParser::LayoutCollection loaded = LayoutParser::LayoutCollection::LoadFromString(corpus);
+
+		LayoutParser::QueryBatch batch;
+		for (int32_t object = 0; object < objectsPerLayout; object++)
+		{
+			std::string text = "Layout0/Frame[ID=\"frame" + std::to_string(object) + "\"]/Constraints/Top/Target";
+			batch.Add(LayoutParser::Query::Compile(text, loaded));
+		}
+
+		std::vector<LayoutParser::QueryMatch> matches(batch.Size());
+		double singleTime = MeasureMilliseconds([&]()
+		{
+			for (size_t i = 0; i < batch.Size(); i++)
+				matches[i] = batch.GetQuery(i).First(loaded);
+		});
+
+		AllocationSnapshot beforeBatch = AllocationSnapshot::Take();
+		double batchTime = MeasureMilliseconds([&]() { batch.RunFirst(loaded, matches); });
+		AllocationSnapshot batchAllocations = AllocationSnapshot::Take() - beforeBatch;
+
+		std::cout << "Query:    " << batch.Size() << " bindings, " << singleTime << " ms one by one, " << batchTime << " ms as a batch, "
+			<< batchAllocations.Allocations << " allocations\n";
+	}
+
+	// What building the object index costs on top of a load, and what a lookup costs once it is there
+	{
+		LayoutParser::ParseOptions options;
+		options.BuildIndex = true;
+
+		LayoutParser::LayoutCollection indexed = LayoutParser::LayoutCollection::LoadFromString(corpus);
+		double plainTime = MeasureMilliseconds([&]() { LayoutParser::LayoutCollection::LoadFromString(corpus); });
+		double indexTime = MeasureMilliseconds([&]() { indexed = LayoutParser::LayoutCollection::LoadFromString(corpus, options); });
+
+		const LayoutParser::ObjectIndex& index = *indexed.GetIndex();
+		LayoutParser::Symbol layout = indexed.FindSymbol("Layout0");
+		std::vector<std::string> keys;
+		for (int32_t object = 0; object < objectsPerLayout; object++)
+			keys.push_back("frame" + std::to_string(object));
+
+		size_t found = 0;
+		double lookupTime = MeasureMilliseconds([&]()
+		{
+			for (auto& key : keys)
+				found += index.FindObject(layout, key) != nullptr;
+			found += index.GetObjectsOfType(indexed.FindSymbol("Frame")).Size();
+		});
+
+		std::cout << "Objects:  " << plainTime << " ms plain, " << indexTime << " ms indexed, " << index.GetObjectCount() << " objects, "
+			<< found << " found in " << lookupTime << " ms\n";
+	}
+
+	// Readers on every core while a writer keeps publishing, two corpora with a different number
+	// of objects per layout take turns so a reader can tell when it got the wrong tree
+	{
+		LayoutParser::LayoutCollection odd = LayoutParser::LayoutCollection::LoadFromString(corpus);
+		LayoutParser::LayoutCollection even = LayoutParser::LayoutCollection::LoadFromString(GenerateCorpus(layoutCount, objectsPerLayout + 1));
+
+		uint32_t readerCount = std::max(std::thread::hardware_concurrency(), 2u);
+		std::chrono::milliseconds duration(250);
+
+		auto isConsistent = [&](uint64_t version, const LayoutParser::LayoutCollection& collection) {
+			size_t expectedSize = (version % 2 == 1) ? objectsPerLayout : objectsPerLayout + 1;
+			return collection.FirstLayout().Size() == expectedSize && collection.LastLayout().Size() == expectedSize;
+		};
+
+		uint64_t publishCount = 0;
+		size_t retiredCount = 0;
+		std::pair<size_t, size_t> snapshotReads;
+		{
+			LayoutParser::SnapshotStore store{ LayoutParser::LayoutCollection(odd) };
+			snapshotReads = MeasureConcurrentReads(readerCount, [&]() {
+				return [&, reader = std::make_shared<LayoutParser::SnapshotStore::Reader>(store)]() {
+					LayoutParser::SnapshotStore::Pin pin(*reader);
+					return isConsistent(pin->Version, pin->Collection);
+				};
+			}, [&]() {
+				auto end = std::chrono::steady_clock::now() + duration;
+				while (std::chrono::steady_clock::now() < end)
+				{
+					publishCount = store.Publish(LayoutParser::LayoutCollection(store.GetVersion() % 2 == 1 ? even : odd)) - 1;
+					std::this_thread::yield();
+				}
+			});
+			retiredCount = store.Reclaim();
+		}
+
+		std::pair<size_t, size_t> sharedReads;
+		{
+			struct Versioned
+			{
+				uint64_t Version;
+				LayoutParser::LayoutCollection Collection;
+			};
+			std::shared_ptr<const Versioned> current = std::make_shared<const Versioned>(Versioned{ 1, odd });
+			sharedReads = MeasureConcurrentReads(readerCount, [&]() {
+				return [&]() {
+					std::shared_ptr<const Versioned> pinned = std::atomic_load(&current);
+					return isConsistent(pinned->Version, pinned->Collection);
+				};
+			}, [&]() {
+				auto end = std::chrono::steady_clock::now() + duration;
+				for (uint64_t version = 2; std::chrono::steady_clock::now() < end; version++)
+				{
+					std::atomic_store(&current, std::make_shared<const Versioned>(Versioned{ version, version % 2 == 1 ? odd : even }));
+					std::this_thread::yield();
+				}
+			});
+		}
+
+		double seconds = std::chrono::duration<double>(duration).count();
+		std::cout << "Snapshot: " << snapshotReads.first / seconds / 1e6 << " M reads/s on " << readerCount << " threads, " <<
+			publishCount << " versions published, " << snapshotReads.second << " torn reads, " << retiredCount << " left unreclaimed\n";
+		std::cout << "          " << sharedReads.first / seconds / 1e6 << " M reads/s with std::atomic_load on a shared_ptr, " <<
+			sharedReads.second << " torn reads\n";
+	}
+
+	// Generated corpora of every shape, the same for a given seed on every platform
+	{
+		std::cout << "\nSuite:    seed " << seed << ", " << suiteSize << " MiB per shape\n";
+
+		const CorpusShape shapes[] = { CorpusShape::Shipped, CorpusShape::Wide, CorpusShape::Deep,
+			CorpusShape::Expressions, CorpusShape::Strings, CorpusShape::Errors };
+
+		std::vector<SuiteResult> results;
+		for (CorpusShape shape : shapes)
+		{
+			std::string generated = CorpusGenerator(seed).Generate(shape, suiteSize * 1024 * 1024);
+			const SuiteResult& result = results.emplace_back(RunSuite(shape, generated));
+
+			std::cout << "  " << CorpusGenerator::GetShapeName(shape) << ": " <<
+				SuiteResult::GetMegabytesPerSecond(result.Bytes, result.Lex.Milliseconds) << " MB/s lex, " <<
+				SuiteResult::GetMegabytesPerSecond(result.Bytes, result.GetParseOnlyMilliseconds()) << " MB/s parse only, " <<
+				SuiteResult::GetMegabytesPerSecond(result.Bytes, result.Load.Milliseconds) << " MB/s end to end, " <<
+				result.Load.Allocations.Allocations << " allocations, " << result.Diagnostics << " diagnostics\n";
+		}
+
+		std::cout << "Peak RSS: " << GetPeakResidentBytes() / (1024 * 1024) << " MiB\n";
+
+		if (jsonPath != nullptr)
+		{
+			WriteSuiteJson(jsonPath, seed, results);
+			std::cout << "Results written to " << jsonPath << "\n";
+		}
+	}
+}
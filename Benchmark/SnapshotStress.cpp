@@ -0,0 +1,135 @@
+#include "SnapshotStress.h"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+#include "LayoutParser/LayoutParser.h"
+
+namespace
+{
+	constexpr int32_t LayoutCount = 20;
+	constexpr int32_t ObjectsPerLayout = 8;
+
+	// Odd versions get ObjectsPerLayout objects in every layout, even ones one more
+	std::string GenerateText(int32_t objectsPerLayout)
+	{
+		std::ostringstream text;
+		for (int32_t layout = 0; layout < LayoutCount; layout++)
+		{
+			text << "Layout" << layout << "\n{\n";
+			for (int32_t object = 0; object < objectsPerLayout; object++)
+				text << "\t<Frame() ID = \"frame" << object << "\", ZIndex = " << object << ">\n";
+			text << "}\n";
+		}
+		return text.str();
+	}
+
+	// Walks every object so a snapshot that was freed under the reader shows up in a sanitizer
+	bool IsConsistent(const LayoutParser::Snapshot& snapshot)
+	{
+		size_t expectedSize = (snapshot.Version % 2 == 1) ? ObjectsPerLayout : ObjectsPerLayout + 1;
+		int32_t layoutCount = 0;
+		for (const auto& pair : snapshot.Collection)
+		{
+			if (pair.second.Size() != expectedSize)
+				return false;
+			layoutCount++;
+
+			for (const LayoutParser::Object* object : pair.second)
+			{
+				if (object->GetContainer().Size() != 2)
+					return false;
+			}
+		}
+		return layoutCount == LayoutCount;
+	}
+}
+
+bool RunSnapshotStress(std::chrono::milliseconds duration, uint32_t readerCount)
+{
+	if (readerCount == 0)
+		readerCount = std::max(std::thread::hardware_concurrency(), 4u);
+
+	const LayoutParser::LayoutCollection odd = LayoutParser::LayoutCollection::LoadFromString(GenerateText(ObjectsPerLayout));
+	const LayoutParser::LayoutCollection even = LayoutParser::LayoutCollection::LoadFromString(GenerateText(ObjectsPerLayout + 1));
+
+	LayoutParser::SnapshotStore store{ LayoutParser::LayoutCollection(odd) };
+
+	std::atomic<bool> isRunning = true;
+	std::atomic<size_t> readCount = 0;
+	std::atomic<size_t> tornCount = 0;
+	std::atomic<size_t> backwardsCount = 0;
+
+	std::vector<std::thread> threads;
+	for (uint32_t i = 0; i < readerCount; i++)
+	{
+		threads.emplace_back([&]() {
+			size_t reads = 0;
+			uint64_t lastPinned = 0;
+			uint64_t lastVersion = 0;
+			while (isRunning.load(std::memory_order_relaxed))
+			{
+				// Readers come and go as well, so slots get released and claimed again
+				auto reader = std::make_unique<LayoutParser::SnapshotStore::Reader>(store);
+				for (int32_t read = 0; read < 64; read++, reads++)
+				{
+					uint64_t pinned;
+					{
+						LayoutParser::SnapshotStore::Pin pin(*reader);
+						if (!IsConsistent(*pin))
+							tornCount++;
+
+						// A nested pin has to hand out the same snapshot
+						{
+							LayoutParser::SnapshotStore::Pin nested(*reader);
+							if (&*nested != &*pin)
+								tornCount++;
+						}
+						pinned = pin->Version;
+					}
+
+					// Without a pin, which has to be safe as well
+					uint64_t version = store.GetVersion();
+					if (pinned < lastPinned || version < lastVersion)
+						backwardsCount++;
+					lastPinned = pinned;
+					lastVersion = version;
+				}
+			}
+			readCount += reads;
+		});
+	}
+
+	threads.emplace_back([&]() {
+		while (isRunning.load(std::memory_order_relaxed))
+		{
+			store.Reclaim();
+			std::this_thread::yield();
+		}
+	});
+
+	uint64_t publishCount = 0;
+	auto end = std::chrono::steady_clock::now() + duration;
+	while (std::chrono::steady_clock::now() < end)
+	{
+		publishCount = store.Publish(LayoutParser::LayoutCollection(store.GetVersion() % 2 == 1 ? even : odd)) - 1;
+		std::this_thread::yield();
+	}
+
+	isRunning = false;
+	for (std::thread& thread : threads)
+		thread.join();
+
+	// Nobody is pinned anymore, so everything retired has to go
+	size_t retiredCount = store.Reclaim();
+
+	std::cout << "Stress:   " << readCount.load() << " reads on " << readerCount << " threads, " << publishCount << " versions published, " <<
+		tornCount.load() << " torn reads, " << backwardsCount.load() << " versions going backwards, " << retiredCount << " left unreclaimed\n";
+	return tornCount.load() == 0 && backwardsCount.load() == 0 && retiredCount == 0;
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+// Readers on every core pin, check and unpin snapshots while one thread keeps publishing and
+// another keeps reclaiming. Two collections with a different number of objects per layout take
+// turns, so a reader can tell when the snapshot it pinned doesn't match its version. Meant to be
+// run under ThreadSanitizer or AddressSanitizer as well, see LAYOUTPARSER_SANITIZER.
+// Returns false if any reader saw a torn or freed snapshot, or a version going backwards.
+bool RunSnapshotStress(std::chrono::milliseconds duration, uint32_t readerCount = 0);
@@ -1,10 +1,20 @@
 ﻿#include <iostream>
 #include <string>
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
 #include "LayoutParser/LayoutParser.h"
 
 int main()
 {
+#ifdef _WIN32
+	// The tree is drawn with UTF-8 box drawing characters
+	SetConsoleOutputCP(CP_UTF8);
+#endif
+
 	LayoutParser::LayoutCollection layouts = LayoutParser::LayoutCollection::LoadFromFile("test.lp");
 
 	for (const std::string& message : layouts.GetDiagnostics())
@@ -1,5 +1,10 @@
 #pragma once
 
 #include "../../src/Data/LayoutCollection.h"
+#include "../../src/Data/LayoutCache.h"
+#include "../../src/Data/SnapshotStore.h"
 #include "../../src/Data/Object.h"
-#include "../../src/Data/Value.h"
\ No newline at end of file
+#include "../../src/Data/Value.h"
+#include "../../src/Data/SymbolTable.h"
+#include "../../src/Data/ObjectIndex.h"
+#include "../../src/Data/Query.h"
\ No newline at end of file
@@ -0,0 +1,180 @@
+#include "Analysis/CharacterScanner.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include "Analysis/SyntaxFacts.h"
+
+#if !defined(LAYOUTPARSER_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+	#define LAYOUTPARSER_SCANNER_SSE2
+	#include <emmintrin.h>
+#endif
+
+#if !defined(LAYOUTPARSER_NO_SIMD) && defined(__AVX2__)
+	#define LAYOUTPARSER_SCANNER_AVX2
+	#include <immintrin.h>
+#endif
+
+#ifdef _MSC_VER
+	#include <intrin.h>
+#endif
+
+using namespace LayoutParser;
+
+static inline uint32_t CountTrailingZeros(uint32_t mask)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return static_cast<uint32_t>(index);
+#else
+	return static_cast<uint32_t>(__builtin_ctz(mask));
+#endif
+}
+
+// Overloads for both vector widths so the matchers below can be written once.
+// Signed byte compares are fine for the ranges since everything above 127 is negative
+// and none of the classes contain non-ASCII characters anyway.
+#ifdef LAYOUTPARSER_SCANNER_SSE2
+static inline __m128i InRange(__m128i characters, char low, char high)
+{
+	return _mm_and_si128(
+		_mm_cmpgt_epi8(characters, _mm_set1_epi8(static_cast<char>(low - 1))),
+		_mm_cmplt_epi8(characters, _mm_set1_epi8(static_cast<char>(high + 1))));
+}
+
+static inline __m128i Equals(__m128i characters, char character) { return _mm_cmpeq_epi8(characters, _mm_set1_epi8(character)); }
+static inline __m128i Or(__m128i left, __m128i right) { return _mm_or_si128(left, right); }
+
+// Setting the 0x20 bit folds upper case letters onto lower case ones
+static inline __m128i FoldCase(__m128i characters) { return _mm_or_si128(characters, _mm_set1_epi8(0x20)); }
+#endif
+
+#ifdef LAYOUTPARSER_SCANNER_AVX2
+static inline __m256i InRange(__m256i characters, char low, char high)
+{
+	return _mm256_and_si256(
+		_mm256_cmpgt_epi8(characters, _mm256_set1_epi8(static_cast<char>(low - 1))),
+		_mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(high + 1)), characters));
+}
+
+static inline __m256i Equals(__m256i characters, char character) { return _mm256_cmpeq_epi8(characters, _mm256_set1_epi8(character)); }
+static inline __m256i Or(__m256i left, __m256i right) { return _mm256_or_si256(left, right); }
+static inline __m256i FoldCase(__m256i characters) { return _mm256_or_si256(characters, _mm256_set1_epi8(0x20)); }
+#endif
+
+struct WhitespaceMatcher
+{
+	static inline bool MatchScalar(char character)
+	{
+		return SyntaxFacts::IsWhitespaceCharacter(character) || character == '\n';
+	}
+
+	// \t \n \v \f \r are contiguous
+	template<typename Vector>
+	static inline Vector Match(Vector characters)
+	{
+		return Or(Equals(characters, ' '), InRange(characters, '\t', '\r'));
+	}
+};
+
+struct IdentifierMatcher
+{
+	static inline bool MatchScalar(char character)
+	{
+		return SyntaxFacts::IsIdentifierCharacter(character);
+	}
+
+	template<typename Vector>
+	static inline Vector Match(Vector characters)
+	{
+		return Or(Or(InRange(FoldCase(characters), 'a', 'z'), InRange(characters, '0', '9')), Equals(characters, '_'));
+	}
+};
+
+struct NumberMatcher
+{
+	static inline bool MatchScalar(char character)
+	{
+		return SyntaxFacts::IsDigitAnyBase(character);
+	}
+
+	template<typename Vector>
+	static inline Vector Match(Vector characters)
+	{
+		return Or(Or(InRange(FoldCase(characters), 'a', 'f'), InRange(characters, '0', '9')), Equals(characters, '.'));
+	}
+};
+
+template<typename Matcher>
+static size_t SkipWhile(std::string_view text, size_t position)
+{
+	const char* data = text.data();
+	const size_t length = text.length();
+
+#ifdef LAYOUTPARSER_SCANNER_AVX2
+	while (position + 32 <= length)
+	{
+		__m256i characters = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + position));
+		uint32_t mismatches = ~static_cast<uint32_t>(_mm256_movemask_epi8(Matcher::Match(characters)));
+		if (mismatches != 0)
+			return position + CountTrailingZeros(mismatches);
+		position += 32;
+	}
+#endif
+
+#ifdef LAYOUTPARSER_SCANNER_SSE2
+	while (position + 16 <= length)
+	{
+		__m128i characters = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + position));
+		uint32_t mismatches = ~static_cast<uint32_t>(_mm_movemask_epi8(Matcher::Match(characters))) & 0xFFFF;
+		if (mismatches != 0)
+			return position + CountTrailingZeros(mismatches);
+		position += 16;
+	}
+#endif
+
+	while (position < length && Matcher::MatchScalar(data[position]))
+		position++;
+
+	return position;
+}
+
+size_t CharacterScanner::SkipWhitespace(std::string_view text, size_t position)
+{
+	return SkipWhile<WhitespaceMatcher>(text, position);
+}
+
+size_t CharacterScanner::SkipIdentifierCharacters(std::string_view text, size_t position)
+{
+	return SkipWhile<IdentifierMatcher>(text, position);
+}
+
+size_t CharacterScanner::SkipNumberCharacters(std::string_view text, size_t position)
+{
+	return SkipWhile<NumberMatcher>(text, position);
+}
+
+size_t CharacterScanner::FindCharacter(std::string_view text, size_t position, char character)
+{
+	// memchr is already vectorized by every C runtime we care about
+	if (position >= text.length())
+		return text.length();
+
+	const void* found = std::memchr(text.data() + position, character, text.length() - position);
+	if (found == nullptr)
+		return text.length();
+
+	return static_cast<size_t>(static_cast<const char*>(found) - text.data());
+}
+
+const char* CharacterScanner::GetImplementationName()
+{
+#if defined(LAYOUTPARSER_SCANNER_AVX2)
+	return "AVX2";
+#elif defined(LAYOUTPARSER_SCANNER_SSE2)
+	return "SSE2";
+#else
+	return "Scalar";
+#endif
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string_view>
+#include <cstddef>
+
+namespace LayoutParser
+{
+	// Bulk versions of the SyntaxFacts character checks for skipping long runs in the lexer.
+	// They look at 32 bytes at a time with AVX2, 16 with SSE2, and fall back to the character
+	// class table for the tail or on targets without either. The SIMD level is picked at compile
+	// time, so build with /arch:AVX2 (or -mavx2) to get the wide path. Define
+	// LAYOUTPARSER_NO_SIMD to force the scalar version.
+	//
+	// Every function returns the index of the first character at or after position that ends
+	// the run, or text.length() if the run goes to the end of the text.
+	namespace CharacterScanner
+	{
+		// Whitespace and newlines
+		size_t SkipWhitespace(std::string_view text, size_t position);
+
+		// a-z A-Z 0-9 _
+		size_t SkipIdentifierCharacters(std::string_view text, size_t position);
+
+		// 0-9 a-f A-F . (anything that can continue a number in any base)
+		size_t SkipNumberCharacters(std::string_view text, size_t position);
+
+		// Used for comment and string bodies
+		size_t FindCharacter(std::string_view text, size_t position, char character);
+
+		// Which of the implementations above got compiled in
+		const char* GetImplementationName();
+	}
+}
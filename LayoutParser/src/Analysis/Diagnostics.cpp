@@ -4,61 +4,217 @@
 
 using namespace LayoutParser;
 
-void DiagnosticCollection::ReportInvalidBinaryNumber(const std::string& numberText)
+void DiagnosticCollection::ReportInvalidBinaryNumber(TextSpan span, std::string_view numberText)
 {
-	std::stringstream errorText = std::stringstream();
-	errorText << "Failed to parse binary number '" << numberText << "'.";
-	m_Diagnostics.push_back(errorText.str());
+	Report(DiagnosticCode::InvalidBinaryNumber, span).Text = AddArgument(numberText);
 }
 
-void DiagnosticCollection::ReportInvalidHexNumber(const std::string& numberText)
+void DiagnosticCollection::ReportInvalidHexNumber(TextSpan span, std::string_view numberText)
 {
-	std::stringstream errorText = std::stringstream();
-	errorText << "Failed to parse hexidecimal number '" << numberText << "'.";
-	m_Diagnostics.push_back(errorText.str());
+	Report(DiagnosticCode::InvalidHexNumber, span).Text = AddArgument(numberText);
 }
 
-void DiagnosticCollection::ReportInvalidNumber(const std::string& numberText)
+void DiagnosticCollection::ReportInvalidNumber(TextSpan span, std::string_view numberText)
 {
-	std::stringstream errorText = std::stringstream();
-	errorText << "Failed to parse number '" << numberText << "'.";
-	m_Diagnostics.push_back(errorText.str());
+	Report(DiagnosticCode::InvalidNumber, span).Text = AddArgument(numberText);
 }
 
-void DiagnosticCollection::ReportMissingDoubleQuote()
+void DiagnosticCollection::ReportNumberOutOfRange(TextSpan span, std::string_view numberText)
 {
-	m_Diagnostics.push_back("Missing double quotation mark when parsing string literal.");
+	Report(DiagnosticCode::NumberOutOfRange, span).Text = AddArgument(numberText);
 }
 
-void DiagnosticCollection::ReportInvalidHexColorString(char character)
+void DiagnosticCollection::ReportMissingDoubleQuote(TextSpan span)
 {
-	std::stringstream errorText = std::stringstream();
-	errorText << "Expected hexidecimal digit while parsing hex color but found '" << character << "' instead.";
-	m_Diagnostics.push_back(errorText.str());
+	Report(DiagnosticCode::MissingDoubleQuote, span);
 }
 
-void DiagnosticCollection::ReportBadCharacter(char character)
+void DiagnosticCollection::ReportInvalidHexColorString(TextSpan span, char character)
 {
-	std::stringstream errorText = std::stringstream();
-	errorText << "Bad character found: '" << character << "'.";
-	m_Diagnostics.push_back(errorText.str());
+	Report(DiagnosticCode::InvalidHexColorString, span).Character = character;
 }
 
-void DiagnosticCollection::ReportUnexpectedToken(SyntaxKind token, SyntaxKind expectedToken)
+void DiagnosticCollection::ReportBadCharacter(TextSpan span, char character)
 {
-	std::stringstream errorText = std::stringstream();
-	errorText << "Unexpected token found <" << GetSyntaxKindName(token) << ">. Expected <" << GetSyntaxKindName(expectedToken) << ">.";
-	m_Diagnostics.push_back(errorText.str());
+	Report(DiagnosticCode::BadCharacter, span).Character = character;
+}
+
+void DiagnosticCollection::ReportUnexpectedToken(TextSpan span, SyntaxKind token, SyntaxKind expectedToken)
+{
+	Diagnostic& diagnostic = Report(DiagnosticCode::UnexpectedToken, span);
+	diagnostic.Token = token;
+	diagnostic.ExpectedToken = expectedToken;
+}
+
+void DiagnosticCollection::ReportMismatchedParentheses(TextSpan span)
+{
+	Report(DiagnosticCode::MismatchedParentheses, span);
+}
+
+void DiagnosticCollection::ReportUnexpectedTokenInExpression(TextSpan span, SyntaxKind token)
+{
+	Report(DiagnosticCode::UnexpectedTokenInExpression, span).Token = token;
+}
+
+void DiagnosticCollection::ReportMissingOperator(TextSpan span, SyntaxKind token)
+{
+	Report(DiagnosticCode::MissingOperator, span).Token = token;
+}
+
+void DiagnosticCollection::ReportInvalidBinaryFile(std::string_view reason)
+{
+	Report(DiagnosticCode::InvalidBinaryFile, TextSpan(-1, 0)).Text = AddArgument(reason);
+}
+
+void DiagnosticCollection::ReportInvalidJson(TextSpan span, std::string_view reason)
+{
+	Report(DiagnosticCode::InvalidJson, span).Text = AddArgument(reason);
+}
+
+void DiagnosticCollection::ReportDuplicateLayout(TextSpan span, std::string_view layoutName, std::string_view firstDefinition)
+{
+	Diagnostic& diagnostic = Report(DiagnosticCode::DuplicateLayout, span);
+	diagnostic.Text = AddArgument(layoutName);
+	diagnostic.Detail = AddArgument(firstDefinition);
+}
+
+void DiagnosticCollection::ReportDuplicateKey(TextSpan span, std::string_view property, std::string_view key)
+{
+	Diagnostic& diagnostic = Report(DiagnosticCode::DuplicateKey, span);
+	diagnostic.Text = AddArgument(key);
+	diagnostic.Detail = AddArgument(property);
+}
+
+void DiagnosticCollection::ReportTooManyErrors(TextSpan span, uint64_t maxErrors)
+{
+	Report(DiagnosticCode::TooManyErrors, span).Limit = maxErrors;
 }
 
-void DiagnosticCollection::ReportMismatchedParentheses()
+void DiagnosticCollection::ReportNestingTooDeep(TextSpan span, uint64_t maxDepth)
 {
-	m_Diagnostics.push_back("Mismatched parentheses found while evaluating number value.");
+	Report(DiagnosticCode::NestingTooDeep, span).Limit = maxDepth;
+}
+
+void DiagnosticCollection::ReportInputTooLarge(uint64_t maxInputSize)
+{
+	Report(DiagnosticCode::InputTooLarge, TextSpan(-1, 0)).Limit = maxInputSize;
+}
+
+void DiagnosticCollection::Append(const DiagnosticCollection& other, std::string_view source)
+{
+	m_Diagnostics.reserve(m_Diagnostics.size() + other.m_Diagnostics.size());
+	for (const Diagnostic& diagnostic : other.m_Diagnostics)
+	{
+		Diagnostic& copy = m_Diagnostics.emplace_back(diagnostic);
+		copy.Text = AddArgument(other.GetArgument(diagnostic.Text));
+		copy.Detail = AddArgument(other.GetArgument(diagnostic.Detail));
+
+		// A source that already had one goes in front of it
+		std::string_view previousSource = other.GetArgument(diagnostic.Source);
+		copy.Source = AddArgument(source);
+		if (!previousSource.empty())
+		{
+			AddArgument(": ");
+			AddArgument(previousSource);
+			copy.Source.Length += static_cast<uint32_t>(2 + previousSource.length());
+		}
+	}
+}
+
+void DiagnosticCollection::ResolveLocations(const LineIndex& lines)
+{
+	for (Diagnostic& diagnostic : m_Diagnostics)
+	{
+		if (diagnostic.Span.Start >= 0 && !diagnostic.Location.IsKnown())
+			diagnostic.Location = lines.GetLocation(diagnostic.Span.Start);
+	}
+}
+
+std::string DiagnosticCollection::Format(const Diagnostic& diagnostic) const
+{
+	std::stringstream errorText = std::stringstream();
+
+	std::string_view source = GetArgument(diagnostic.Source);
+	if (!source.empty())
+		errorText << source << ": ";
+	if (diagnostic.Location.IsKnown())
+		errorText << diagnostic.Location.Line << ":" << diagnostic.Location.Column << ": ";
+
+	std::string_view text = GetArgument(diagnostic.Text);
+	switch (diagnostic.Code)
+	{
+	case DiagnosticCode::InvalidBinaryNumber:
+		errorText << "Failed to parse binary number '" << text << "'.";
+		break;
+	case DiagnosticCode::InvalidHexNumber:
+		errorText << "Failed to parse hexidecimal number '" << text << "'.";
+		break;
+	case DiagnosticCode::InvalidNumber:
+		errorText << "Failed to parse number '" << text << "'.";
+		break;
+	case DiagnosticCode::NumberOutOfRange:
+		errorText << "Number '" << text << "' is out of range.";
+		break;
+	case DiagnosticCode::MissingDoubleQuote:
+		errorText << "Missing double quotation mark when parsing string literal.";
+		break;
+	case DiagnosticCode::InvalidHexColorString:
+		errorText << "Expected hexidecimal digit while parsing hex color but found '" << diagnostic.Character << "' instead.";
+		break;
+	case DiagnosticCode::BadCharacter:
+		errorText << "Bad character found: '" << diagnostic.Character << "'.";
+		break;
+	case DiagnosticCode::UnexpectedToken:
+		errorText << "Unexpected token found <" << GetSyntaxKindName(diagnostic.Token) << ">. Expected <" << GetSyntaxKindName(diagnostic.ExpectedToken) << ">.";
+		break;
+	case DiagnosticCode::MismatchedParentheses:
+		errorText << "Mismatched parentheses found while evaluating number value.";
+		break;
+	case DiagnosticCode::UnexpectedTokenInExpression:
+		errorText << "Unexpected token <" << GetSyntaxKindName(diagnostic.Token) << "> in number expression. Expected a number, '(' or '-'.";
+		break;
+	case DiagnosticCode::MissingOperator:
+		errorText << "Missing operator before <" << GetSyntaxKindName(diagnostic.Token) << "> in number expression.";
+		break;
+	case DiagnosticCode::InvalidBinaryFile:
+		errorText << "Failed to load compiled layouts: " << text << ".";
+		break;
+	case DiagnosticCode::InvalidJson:
+		errorText << "Failed to load layouts from JSON: " << text << ".";
+		break;
+	case DiagnosticCode::DuplicateLayout:
+	{
+		std::string_view firstDefinition = GetArgument(diagnostic.Detail);
+		errorText << "Layout '" << text << "' is already defined";
+		if (!firstDefinition.empty())
+			errorText << " in '" << firstDefinition << "'";
+		errorText << ". The first definition is kept.";
+		break;
+	}
+	case DiagnosticCode::DuplicateKey:
+		errorText << "Another object in this layout already has " << GetArgument(diagnostic.Detail) << " = \"" << text << "\", the index keeps that one.";
+		break;
+	case DiagnosticCode::TooManyErrors:
+		errorText << "Too many errors, parsing stopped after " << diagnostic.Limit << ".";
+		break;
+	case DiagnosticCode::NestingTooDeep:
+		errorText << "Nesting is deeper than the limit of " << diagnostic.Limit << " levels, parsing stopped.";
+		break;
+	case DiagnosticCode::InputTooLarge:
+		errorText << "Input is larger than the limit of " << diagnostic.Limit << " bytes, nothing was parsed.";
+		break;
+	}
+
+	return errorText.str();
 }
 
-void DiagnosticCollection::ReportInvalidNumberExpression()
+DiagnosticArgument DiagnosticCollection::AddArgument(std::string_view text)
 {
-	m_Diagnostics.push_back("Invalid expression encountered evaluating number value");
+	DiagnosticArgument argument;
+	argument.Start = static_cast<uint32_t>(m_Arguments.length());
+	argument.Length = static_cast<uint32_t>(text.length());
+	m_Arguments.append(text);
+	return argument;
 }
 
 const char* DiagnosticCollection::GetSyntaxKindName(SyntaxKind kind)
@@ -2,50 +2,185 @@
 
 #include <vector>
 #include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
 
 #include "SyntaxKind.h"
+#include "LineIndex.h"
+#include "../Data/TextSpan.h"
 
 namespace LayoutParser
 {
+	enum class DiagnosticCode : uint8_t
+	{
+		InvalidBinaryNumber,
+		InvalidHexNumber,
+		InvalidNumber,
+		NumberOutOfRange,
+
+		MissingDoubleQuote,
+		InvalidHexColorString,
+		BadCharacter,
+
+		UnexpectedToken,
+		MismatchedParentheses,
+		UnexpectedTokenInExpression,
+		MissingOperator,
+
+		InvalidBinaryFile,
+		InvalidJson,
+		DuplicateLayout,
+		DuplicateKey,
+
+		TooManyErrors,
+		NestingTooDeep,
+		InputTooLarge,
+	};
+
+	// Slice of the argument text owned by the collection
+	struct DiagnosticArgument
+	{
+		uint32_t Start = 0;
+		uint32_t Length = 0;
+	};
+
+	// A reported problem as it was found, the message is only put together when somebody reads it.
+	// Which of the arguments are used depends on the code.
+	struct Diagnostic
+	{
+		DiagnosticCode Code;
+		SyntaxKind Token = SyntaxKind::BadToken;
+		SyntaxKind ExpectedToken = SyntaxKind::BadToken;
+		char Character = '\0';
+
+		// Start is negative for problems that aren't in the source text, like a bad binary file
+		TextSpan Span;
+		SourceLocation Location;
+
+		DiagnosticArgument Text; // number text, layout name or reason
+		DiagnosticArgument Detail; // where a duplicate layout was first defined, the property of a duplicate key
+		DiagnosticArgument Source; // prefix from Append, like the file or layout the problem is in
+
+		uint64_t Limit = 0; // for the codes about ParseOptions limits
+	};
+
 	class DiagnosticCollection
 	{
 	public:
+		// Formats each diagnostic as it is dereferenced, so reading them is the only place
+		// messages are built. The message lives in the iterator until it moves on.
+		class Iterator
+		{
+		public:
+			using iterator_category = std::input_iterator_tag;
+			using value_type = std::string;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const std::string*;
+			using reference = const std::string&;
+
+			Iterator(const DiagnosticCollection& collection, size_t index)
+				: m_Collection(&collection), m_Index(index) {}
+
+			inline reference operator*() const
+			{
+				m_Message = m_Collection->Format(m_Collection->m_Diagnostics[m_Index]);
+				return m_Message;
+			}
+			inline pointer operator->() const { return &**this; }
+
+			inline Iterator& operator++() { m_Index++; return *this; }
+			inline bool operator==(const Iterator& other) const { return m_Index == other.m_Index; }
+			inline bool operator!=(const Iterator& other) const { return m_Index != other.m_Index; }
+
+		private:
+			const DiagnosticCollection* m_Collection;
+			size_t m_Index;
+			mutable std::string m_Message;
+		};
+
 		DiagnosticCollection() = default;
 		DiagnosticCollection(const DiagnosticCollection& other)
-			: m_Diagnostics(other.m_Diagnostics) {}
+			: m_Diagnostics(other.m_Diagnostics), m_Arguments(other.m_Arguments) {}
 
 		DiagnosticCollection(DiagnosticCollection&& other) noexcept
-			: m_Diagnostics(std::move(other.m_Diagnostics)) {}
+			: m_Diagnostics(std::move(other.m_Diagnostics)), m_Arguments(std::move(other.m_Arguments)) {}
 
+		inline DiagnosticCollection& operator=(const DiagnosticCollection& other) = default;
 		inline DiagnosticCollection& operator=(DiagnosticCollection&& other) noexcept
 		{
 			if (this != &other)
+			{
 				m_Diagnostics = std::move(other.m_Diagnostics);
+				m_Arguments = std::move(other.m_Arguments);
+			}
 			return *this;
 		}
 
 		bool inline IsEmpty() const { return m_Diagnostics.empty(); }
+		inline size_t Size() const { return m_Diagnostics.size(); }
+
+		void ReportInvalidBinaryNumber(TextSpan span, std::string_view numberText);
+		void ReportInvalidHexNumber(TextSpan span, std::string_view numberText);
+		void ReportInvalidNumber(TextSpan span, std::string_view numberText);
+		void ReportNumberOutOfRange(TextSpan span, std::string_view numberText);
+
+		void ReportMissingDoubleQuote(TextSpan span);
+		void ReportInvalidHexColorString(TextSpan span, char character);
+		void ReportBadCharacter(TextSpan span, char character);
+
+		void ReportUnexpectedToken(TextSpan span, SyntaxKind token, SyntaxKind expectedToken);
+		void ReportMismatchedParentheses(TextSpan span);
+		void ReportUnexpectedTokenInExpression(TextSpan span, SyntaxKind token);
+		void ReportMissingOperator(TextSpan span, SyntaxKind token);
+
+		void ReportInvalidBinaryFile(std::string_view reason);
+		void ReportInvalidJson(TextSpan span, std::string_view reason);
 
-		void ReportInvalidBinaryNumber(const std::string& numberText);
-		void ReportInvalidHexNumber(const std::string& numberText);
-		void ReportInvalidNumber(const std::string& numberText);
+		// The first definition is left out for duplicates within one file
+		void ReportDuplicateLayout(TextSpan span, std::string_view layoutName, std::string_view firstDefinition = std::string_view());
 
-		void ReportMissingDoubleQuote();
-		void ReportInvalidHexColorString(char character);
-		void ReportBadCharacter(char character);
+		// Another object of the layout already has the same value for the property the ObjectIndex uses
+		void ReportDuplicateKey(TextSpan span, std::string_view property, std::string_view key);
 
-		void ReportUnexpectedToken(SyntaxKind token, SyntaxKind expectedToken);
-		void ReportMismatchedParentheses();
-		void ReportInvalidNumberExpression();
+		// Parsing stopped at one of the ParseOptions limits
+		void ReportTooManyErrors(TextSpan span, uint64_t maxErrors);
+		void ReportNestingTooDeep(TextSpan span, uint64_t maxDepth);
+		void ReportInputTooLarge(uint64_t maxInputSize);
 
-		auto begin() { return m_Diagnostics.begin(); }
-		auto end() { return m_Diagnostics.end(); }
+		// Copies every diagnostic of the other collection, each one prefixed with "<source>: "
+		void Append(const DiagnosticCollection& other, std::string_view source);
+
+		// Fills in the line and column of every diagnostic that has a span but no location yet.
+		// Has to be called with the text the spans point into while it's still around.
+		void ResolveLocations(const LineIndex& lines);
+
+		inline const Diagnostic& operator[](size_t index) const { return m_Diagnostics[index]; }
+		inline std::string_view GetArgument(DiagnosticArgument argument) const { return std::string_view(m_Arguments).substr(argument.Start, argument.Length); }
+
+		// "<source>: <line>:<column>: <message>", leaving out whatever isn't known
+		std::string Format(const Diagnostic& diagnostic) const;
+
+		inline Iterator begin() const { return Iterator(*this, 0); }
+		inline Iterator end() const { return Iterator(*this, m_Diagnostics.size()); }
+
+		static const char* GetSyntaxKindName(SyntaxKind kind);
 
 	private:
-		std::vector<std::string> m_Diagnostics;
+		std::vector<Diagnostic> m_Diagnostics;
+
+		// Every text argument back to back, so a report doesn't allocate once this has grown
+		std::string m_Arguments;
 
-		inline void Report(std::string&& diagnostic) { m_Diagnostics.emplace_back(diagnostic); }
+		DiagnosticArgument AddArgument(std::string_view text);
 
-		const char* GetSyntaxKindName(SyntaxKind kind);
+		inline Diagnostic& Report(DiagnosticCode code, TextSpan span)
+		{
+			Diagnostic& diagnostic = m_Diagnostics.emplace_back();
+			diagnostic.Code = code;
+			diagnostic.Span = span;
+			return diagnostic;
+		}
 	};
-}
\ No newline at end of file
+}
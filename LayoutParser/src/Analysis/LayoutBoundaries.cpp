@@ -0,0 +1,28 @@
+#include "Analysis/LayoutBoundaries.h"
+
+#include "Analysis/StructuralIndex.h"
+
+using namespace LayoutParser;
+
+bool LayoutBoundaries::FindLayoutEnds(std::string_view text, std::vector<size_t>& layoutEnds)
+{
+	// The index already left out strings, comments and hex colors, so only braces are left to look at
+	StructuralIndex index(text);
+
+	size_t depth = 0;
+	for (uint32_t position : index)
+	{
+		if (text[position] == '{')
+			depth++;
+		else if (text[position] == '}')
+		{
+			if (depth == 0)
+				return false;
+
+			if (--depth == 0)
+				layoutEnds.push_back(static_cast<size_t>(position) + 1);
+		}
+	}
+
+	return depth == 0;
+}
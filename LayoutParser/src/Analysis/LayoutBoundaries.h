@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+namespace LayoutParser
+{
+	// Quick structural pass used to split a file into top-level layouts before parsing them in
+	// parallel. It only matches braces, skipping strings, comments and hex colors the same way
+	// the lexer does, so it knows nothing about the grammar and the parser has the final say.
+	namespace LayoutBoundaries
+	{
+		// Appends the offset just past the closing brace of every top-level layout. Returns false
+		// if the braces don't balance, in which case the text has to be parsed in one piece.
+		bool FindLayoutEnds(std::string_view text, std::vector<size_t>& layoutEnds);
+	}
+}
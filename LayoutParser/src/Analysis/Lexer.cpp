@@ -1,100 +1,75 @@
 #include "Analysis/Lexer.h"
 
-#include <sstream>
+#include <charconv>
+#include <system_error>
 
 #include "Analysis/SyntaxFacts.h"
+#include "Analysis/CharacterScanner.h"
 
 using namespace LayoutParser;
 
+void Lexer::SkipTrivia()
+{
+	while (true)
+	{
+		if (SyntaxFacts::IsWhitespaceCharacter(Current()) || Current() == '\n')
+		{
+			m_Position = static_cast<int32_t>(CharacterScanner::SkipWhitespace(m_Text, m_Position));
+		}
+		else if (Current() == '/' && Lookahead() == '/')
+		{
+			// Comment runs to the end of the line, the newline itself gets skipped as whitespace
+			m_Position = static_cast<int32_t>(CharacterScanner::FindCharacter(m_Text, static_cast<size_t>(m_Position) + 2, '\n'));
+		}
+		else
+			return;
+	}
+}
+
 SyntaxToken Lexer::Lex()
 {
-	if (m_Position >= m_Text.length())
-	return SyntaxToken(SyntaxKind::EndOfFileToken, m_Position, "\0");
+	SkipTrivia();
+
+	if (static_cast<size_t>(m_Position) >= m_Text.length())
+		return SyntaxToken(SyntaxKind::EndOfFileToken, m_Position, 0);
 
 	int32_t start = m_Position;
 
-	// This is kinda overkill but I like it
+	// 0x and 0b prefixes pick the base, everything else is a decimal float
 	if (SyntaxFacts::IdentifyNumberLiteral(Current()))
 	{
-		char baseIdentifier = Lookahead();
+		int32_t base = 10;
+		if (Current() == '0' && (Lookahead() == 'x' || Lookahead() == 'X'))
+			base = 16;
+		else if (Current() == '0' && (Lookahead() == 'b' || Lookahead() == 'B'))
+			base = 2;
 
-		Next();
-		while (SyntaxFacts::IsDigitAnyBase(Current()))
-			Next();
+		size_t digitsStart = static_cast<size_t>(start) + (base == 10 ? 0 : 2);
+		m_Position = static_cast<int32_t>(CharacterScanner::SkipNumberCharacters(m_Text, (base == 10) ? digitsStart + 1 : digitsStart));
 
 		int32_t length = m_Position - start;
-		switch (baseIdentifier)
-		{
-		case 'b':
-		{
-			std::string tokenText = m_Text.substr(start, length);
-			float value = 0.0f;
-			try
-			{
-				std::string numberText = m_Text.substr(static_cast<size_t>(start) + 2, static_cast<size_t>(length) - 2);
-				value = static_cast<float>(std::stoi(numberText, nullptr, 2));
-			}
-			catch (std::exception)
-			{
-				m_Diagnostics.ReportInvalidBinaryNumber(tokenText);
-				
-			}
+		std::string_view tokenText = m_Text.substr(start, length);
 
-			return SyntaxToken(SyntaxKind::NumberToken, start, tokenText, value);
-		}
-		case 'x':
-		{
-			std::string tokenText = m_Text.substr(start, length);
-			float value = 0.0f;
-			try
-			{
-				std::string numberText = m_Text.substr(static_cast<size_t>(start) + 2, static_cast<size_t>(length) - 2);
-				value = static_cast<float>(std::stoi(numberText, nullptr, 16));
-			}
-			catch (std::exception)
-			{
-				m_Diagnostics.ReportInvalidHexNumber(tokenText);
-			}
-
-			return SyntaxToken(SyntaxKind::NumberToken, start, tokenText, value);
-		}
-		default:
-		{
-			std::string tokenText = m_Text.substr(start, length);
-			float value = 0.0f;
-			try
-			{
-				value = std::stof(tokenText);
-			}
-			catch (std::exception)
-			{
-				m_Diagnostics.ReportInvalidNumber(tokenText);
-			}
+		float value = (base == 10) ?
+			ParseDecimalLiteral(tokenText) :
+			ParseIntegerLiteral(tokenText, m_Text.substr(digitsStart, m_Position - digitsStart), base);
 
-			return SyntaxToken(SyntaxKind::NumberToken, start, tokenText, value);
-		}
-		}
+		return SyntaxToken(SyntaxKind::NumberToken, start, length, value);
 	}
 
 	// String literals
 	if (Current() == '"')
 	{
-		Next();
-		while (Current() != '"')
+		size_t closingQuote = CharacterScanner::FindCharacter(m_Text, static_cast<size_t>(m_Position) + 1, '"');
+		if (closingQuote >= m_Text.length())
 		{
-			if (Current() == '\0')
-			{
-				m_Diagnostics.ReportMissingDoubleQuote();
-				break;
-			}
-			else
-				Next();
+			m_Diagnostics.ReportMissingDoubleQuote(TextSpan(start, static_cast<int32_t>(m_Text.length()) - start));
+			m_Position = static_cast<int32_t>(m_Text.length());
 		}
-		Next();
+		else
+			m_Position = static_cast<int32_t>(closingQuote) + 1;
 
-		int32_t length = m_Position - start;
-		std::string text = m_Text.substr(start, length);
-		return SyntaxToken(SyntaxKind::StringToken, start, text);
+		return SyntaxToken(SyntaxKind::StringToken, start, m_Position - start);
 	}
 
 	// Hex color
@@ -105,100 +80,131 @@ SyntaxToken Lexer::Lex()
 		{
 			if (!SyntaxFacts::IsDigitHex(Current()))
 			{
-				m_Diagnostics.ReportInvalidHexColorString(Current());
+				m_Diagnostics.ReportInvalidHexColorString(TextSpan(m_Position, 1), Current());
 			}
-			Next();
+
+			// A color cut off by the end of the text must not leave the position past it
+			if (static_cast<size_t>(m_Position) < m_Text.length())
+				Next();
 		}
 
-		int32_t length = m_Position - start;
-		std::string text = m_Text.substr(start, length);
-		return SyntaxToken(SyntaxKind::HexColorToken, start, text);
+		return SyntaxToken(SyntaxKind::HexColorToken, start, m_Position - start);
 	}
 
 	// Identifiers
 	if (SyntaxFacts::IdentifyIdentifier(Current()))
 	{
-		Next();
-		while (SyntaxFacts::IsIdentifierCharacter(Current()))
-			Next();
-
-		int32_t length = m_Position - start;
-		std::string text = m_Text.substr(start, length);
-		return SyntaxToken(SyntaxFacts::ParseKeywordKind(text), start, text);
-	}
-
-	// Whitespace
-	if (SyntaxFacts::IsWhitespaceCharacter(Current()))
-	{
-		Next();
-		while (SyntaxFacts::IsWhitespaceCharacter(Current()))
-			Next();
-
-		int32_t length = m_Position - start;
-		std::string text = m_Text.substr(start, length);
-		return SyntaxToken(SyntaxKind::WhitespaceToken, start, text);
-	}
-
-	// Comments
-	if (Current() == '/' && Lookahead() == '/')
-	{
-		m_Position += 2;
-		while (Current() != '\n' && Current() != '\0')
-			Next();
+		m_Position = static_cast<int32_t>(CharacterScanner::SkipIdentifierCharacters(m_Text, static_cast<size_t>(m_Position) + 1));
 
 		int32_t length = m_Position - start;
-		std::string text = m_Text.substr(start, length);
-		return SyntaxToken(SyntaxKind::CommentToken, start, text);
+		return SyntaxToken(SyntaxFacts::ParseKeywordKind(m_Text.substr(start, length)), start, length);
 	}
 
 	switch (Current())
 	{
-	case '\n':
-		return SyntaxToken(SyntaxKind::NewlineToken, m_Position++, "\n");
-
 	case '+':
-		return SyntaxToken(SyntaxKind::PlusToken, m_Position++, "+");
+		return SyntaxToken(SyntaxKind::PlusToken, m_Position++, 1);
 	case '-':
-		return SyntaxToken(SyntaxKind::MinusToken, m_Position++, "-");
+		return SyntaxToken(SyntaxKind::MinusToken, m_Position++, 1);
 	case '*':
-		return SyntaxToken(SyntaxKind::StarToken, m_Position++, "*");
+		return SyntaxToken(SyntaxKind::StarToken, m_Position++, 1);
 	case '/':
-		return SyntaxToken(SyntaxKind::SlashToken, m_Position++, "/");
+		return SyntaxToken(SyntaxKind::SlashToken, m_Position++, 1);
 	case '^':
-		return SyntaxToken(SyntaxKind::CaretToken, m_Position++, "^");
+		return SyntaxToken(SyntaxKind::CaretToken, m_Position++, 1);
 
 	case '<':
-		return SyntaxToken(SyntaxKind::OpenAngleBracketToken, m_Position++, "<");
+		return SyntaxToken(SyntaxKind::OpenAngleBracketToken, m_Position++, 1);
 	case '>':
-		return SyntaxToken(SyntaxKind::CloseAngleBracketToken, m_Position++, ">");
+		return SyntaxToken(SyntaxKind::CloseAngleBracketToken, m_Position++, 1);
 	case '{':
-		return SyntaxToken(SyntaxKind::OpenSquigglyBracketToken, m_Position++, "{");
+		return SyntaxToken(SyntaxKind::OpenSquigglyBracketToken, m_Position++, 1);
 	case '}':
-		return SyntaxToken(SyntaxKind::CloseSquigglyBracketToken, m_Position++, "}");
+		return SyntaxToken(SyntaxKind::CloseSquigglyBracketToken, m_Position++, 1);
 	case '[':
-		return SyntaxToken(SyntaxKind::OpenSquareBracketToken, m_Position++, "[");
+		return SyntaxToken(SyntaxKind::OpenSquareBracketToken, m_Position++, 1);
 	case ']':
-		return SyntaxToken(SyntaxKind::CloseSquareBracketToken, m_Position++, "]");
+		return SyntaxToken(SyntaxKind::CloseSquareBracketToken, m_Position++, 1);
 	case '(':
-		return SyntaxToken(SyntaxKind::OpenParenthesisToken, m_Position++, "(");
+		return SyntaxToken(SyntaxKind::OpenParenthesisToken, m_Position++, 1);
 	case ')':
-		return SyntaxToken(SyntaxKind::CloseParenthesisToken, m_Position++, ")");
+		return SyntaxToken(SyntaxKind::CloseParenthesisToken, m_Position++, 1);
 
 	case '=':
-		return SyntaxToken(SyntaxKind::EqualsToken, m_Position++, "=");
+		return SyntaxToken(SyntaxKind::EqualsToken, m_Position++, 1);
 	case ',':
-		return SyntaxToken(SyntaxKind::CommaToken, m_Position++, ",");
+		return SyntaxToken(SyntaxKind::CommaToken, m_Position++, 1);
 	}
 
-	m_Diagnostics.ReportBadCharacter(Current());
+	m_Diagnostics.ReportBadCharacter(TextSpan(m_Position, 1), Current());
+
+	return SyntaxToken(SyntaxKind::BadToken, m_Position++, 1);
+}
+
+void Lexer::LexAll(TokenBuffer& tokens)
+{
+	// Rough guess based on the layouts we have, saves most of the regrowth
+	tokens.Reserve(m_Text.length() / 4 + 1);
+
+	SyntaxToken token;
+	do
+	{
+		token = Lex();
+
+		if (token.Kind != SyntaxKind::BadToken)
+			tokens.Push(token);
+	} while (token.Kind != SyntaxKind::EndOfFileToken);
+}
+
+// Both number parsers work on the source bytes directly and report problems through the
+// diagnostics, so bad literals don't cost an allocation or an exception
+float Lexer::ParseDecimalLiteral(std::string_view tokenText)
+{
+	float value = 0.0f;
+	const char* end = tokenText.data() + tokenText.length();
+	std::from_chars_result result = std::from_chars(tokenText.data(), end, value);
+
+	if (result.ec == std::errc::result_out_of_range)
+	{
+		m_Diagnostics.ReportNumberOutOfRange(GetSpan(tokenText), tokenText);
+		return 0.0f;
+	}
+	if (result.ec != std::errc() || result.ptr != end)
+	{
+		m_Diagnostics.ReportInvalidNumber(GetSpan(tokenText), tokenText);
+		return 0.0f;
+	}
+
+	return value;
+}
+
+float Lexer::ParseIntegerLiteral(std::string_view tokenText, std::string_view digits, int32_t base)
+{
+	uint64_t value = 0;
+	const char* end = digits.data() + digits.length();
+	std::from_chars_result result = std::from_chars(digits.data(), end, value, base);
+
+	if (result.ec == std::errc::result_out_of_range)
+	{
+		m_Diagnostics.ReportNumberOutOfRange(GetSpan(tokenText), tokenText);
+		return 0.0f;
+	}
+	if (digits.empty() || result.ec != std::errc() || result.ptr != end)
+	{
+		if (base == 2)
+			m_Diagnostics.ReportInvalidBinaryNumber(GetSpan(tokenText), tokenText);
+		else
+			m_Diagnostics.ReportInvalidHexNumber(GetSpan(tokenText), tokenText);
+		return 0.0f;
+	}
 
-	return SyntaxToken(SyntaxKind::BadToken, m_Position++, m_Text.substr(static_cast<size_t>(m_Position) - 1, 1));
+	return static_cast<float>(value);
 }
 
 char Lexer::Peek(int32_t offset) const
 {
 	int32_t index = m_Position + offset;
-	if (index >= m_Text.length())
+	if (static_cast<size_t>(index) >= m_Text.length())
 		return '\0';
 
 	return m_Text[index];
@@ -1,9 +1,9 @@
 #pragma once
 
-#include <string>
-#include <vector>
+#include <string_view>
 
 #include "Analysis/SyntaxToken.h"
+#include "Analysis/TokenBuffer.h"
 #include "Analysis/Diagnostics.h"
 
 namespace LayoutParser
@@ -11,20 +11,40 @@ namespace LayoutParser
 	class Lexer
 	{
 	public:
-		Lexer(const std::string& text)
-			: m_Text(text), m_Position(0) {}
-
+		// The lexer doesn't copy the text so the caller has to keep it alive while tokens are in use.
+		// Problems are reported straight into the given collection so they stay in source order
+		// with whatever the consumer of the tokens reports.
+		// Lexing can start part way into the text, token positions are always relative to its start.
+		Lexer(std::string_view text, DiagnosticCollection& diagnostics, int32_t startPosition = 0)
+			: m_Text(text), m_Position(startPosition), m_Diagnostics(diagnostics) {}
+
+		// Whitespace, newlines and comments are skipped here and never become tokens.
+		// Keeps returning the end of file token once the text runs out.
 		SyntaxToken Lex();
 
+		// Lexes to the end of the file, dropping bad tokens. The end of file token is kept.
+		void LexAll(TokenBuffer& tokens);
+
 		inline DiagnosticCollection& GetDiagnostics() { return m_Diagnostics; }
 
 	private:
-		const std::string m_Text;
+		std::string_view m_Text;
 		int32_t m_Position;
-		DiagnosticCollection m_Diagnostics;
+		DiagnosticCollection& m_Diagnostics;
+
+		void SkipTrivia();
+
+		float ParseDecimalLiteral(std::string_view tokenText);
+		float ParseIntegerLiteral(std::string_view tokenText, std::string_view digits, int32_t base);
 
 		char Peek(int32_t offset) const;
 
+		// Span of a piece of the text, for reporting on number literals
+		inline TextSpan GetSpan(std::string_view tokenText) const
+		{
+			return TextSpan(static_cast<int32_t>(tokenText.data() - m_Text.data()), static_cast<int32_t>(tokenText.length()));
+		}
+
 		inline void Next()
 		{
 			m_Position++;
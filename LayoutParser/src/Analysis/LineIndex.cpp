@@ -0,0 +1,36 @@
+#include "Analysis/LineIndex.h"
+
+#include <algorithm>
+
+#include "Analysis/CharacterScanner.h"
+
+using namespace LayoutParser;
+
+SourceLocation LineIndex::GetLocation(int32_t position) const
+{
+	if (position < 0 || static_cast<size_t>(position) > m_Text.length())
+		return SourceLocation();
+
+	if (m_LineStarts.empty())
+		Build();
+
+	// The last line starting at or before the position
+	auto line = std::upper_bound(m_LineStarts.begin(), m_LineStarts.end(), position) - 1;
+
+	SourceLocation location;
+	location.Line = static_cast<int32_t>(line - m_LineStarts.begin()) + 1;
+	location.Column = position - *line + 1;
+	return location;
+}
+
+void LineIndex::Build() const
+{
+	m_LineStarts.push_back(0);
+
+	size_t newline = CharacterScanner::FindCharacter(m_Text, 0, '\n');
+	while (newline < m_Text.length())
+	{
+		m_LineStarts.push_back(static_cast<int32_t>(newline) + 1);
+		newline = CharacterScanner::FindCharacter(m_Text, newline + 1, '\n');
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+namespace LayoutParser
+{
+	// Both 1-based, zero if the position isn't known
+	struct SourceLocation
+	{
+		int32_t Line = 0;
+		int32_t Column = 0;
+
+		inline bool IsKnown() const { return Line > 0; }
+	};
+
+	// Turns source positions into lines and columns. The line starts are only found the first time
+	// a location is asked for, so text that never needs one doesn't pay for the scan. Columns count
+	// bytes. Not safe to use from several threads at once, the first lookup builds the index.
+	class LineIndex
+	{
+	public:
+		// The text has to stay alive while the index is used
+		explicit LineIndex(std::string_view text)
+			: m_Text(text) {}
+
+		SourceLocation GetLocation(int32_t position) const;
+
+	private:
+		std::string_view m_Text;
+		mutable std::vector<int32_t> m_LineStarts;
+
+		void Build() const;
+	};
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace LayoutParser
+{
+	// Limits that keep parse time and memory bounded on hostile or badly broken input. The
+	// defaults are far above anything a hand written layout needs.
+	struct ParseOptions
+	{
+		// Parsing stops once this many problems have been reported, a last diagnostic says so
+		size_t MaxErrors = 100;
+
+		// Objects, lists, dictionaries and number expressions nested inside each other.
+		// Deeper input stops the parse instead of running out of stack.
+		int32_t MaxDepth = 256;
+
+		// Larger text isn't parsed at all. Positions are 32 bit, so this can't go past INT32_MAX.
+		size_t MaxInputSize = INT32_MAX;
+
+		// Build an ObjectIndex while parsing, see ObjectIndex.h. Objects are indexed by type and
+		// by the string value of the IndexKey property; other objects with a key that is already
+		// taken are reported.
+		bool BuildIndex = false;
+		std::string_view IndexKey = "ID";
+	};
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "SyntaxKind.h"
+#include "../Data/Value.h"
+
+// Build the library with LAYOUTPARSER_ENABLE_STATS defined to collect ParseStats. Without it
+// every counter and timer below compiles away and LayoutCollection::GetStats returns null.
+#ifdef LAYOUTPARSER_ENABLE_STATS
+#define LAYOUTPARSER_STATS(...) __VA_ARGS__
+#else
+#define LAYOUTPARSER_STATS(...)
+#endif
+
+namespace LayoutParser
+{
+	constexpr size_t SyntaxKindCount = static_cast<size_t>(SyntaxKind::FalseKeyword) + 1;
+	constexpr size_t ValueKindCount = static_cast<size_t>(ValueKind::Dictionary) + 1;
+
+	// Where the time and memory of one load went
+	struct ParseStats
+	{
+		size_t BytesRead = 0;
+
+		// Indexed by SyntaxKind, bad tokens included
+		std::array<size_t, SyntaxKindCount> Tokens = {};
+
+		// Indexed by ValueKind. Objects counts every object, the ones directly in a layout too.
+		std::array<size_t, ValueKindCount> Values = {};
+		size_t Objects = 0;
+		size_t Layouts = 0;
+
+		// From the arena of the collection
+		size_t Allocations = 0;
+		size_t BytesAllocated = 0;
+		size_t BytesReserved = 0;
+
+		// Objects, lists, dictionaries and number expressions, like ParseOptions::MaxDepth
+		int32_t MaxDepth = 0;
+
+		// The lexer runs on demand inside the parser, so the parse time is what's left once
+		// the lexer's share is taken out. Timing every token makes a stats build slower overall.
+		double ReadMilliseconds = 0.0; // mapping or reading the file, zero for text
+		double LexMilliseconds = 0.0;
+		double ParseMilliseconds = 0.0;
+		double BuildMilliseconds = 0.0; // line numbers for diagnostics and putting the collection together
+
+		inline size_t GetTokenCount(SyntaxKind kind) const { return Tokens[static_cast<size_t>(kind)]; }
+		inline size_t GetValueCount(ValueKind kind) const { return Values[static_cast<size_t>(kind)]; }
+
+		inline double GetTotalMilliseconds() const { return ReadMilliseconds + LexMilliseconds + ParseMilliseconds + BuildMilliseconds; }
+	};
+}
@@ -1,97 +1,223 @@
 #include "Analysis/Parser.h"
 
-#include <stack>
+#include <cmath>
+#include <algorithm>
+#include <cassert>
+#include <chrono>
 
 #include "Analysis/Lexer.h"
 #include "Analysis/SyntaxFacts.h"
 
+#include "Data/Arena.h"
 #include "Data/Object.h"
 #include "Data/Value.h"
 
 using namespace LayoutParser;
 
-Parser::Parser(const std::string& text)
-	: m_Tokens(), m_Position(0)
+Parser::Parser(std::string_view text, Arena& arena, SymbolTable& symbols, int32_t startPosition, const ParseOptions& options)
+	: m_Text(text), m_Diagnostics(), m_Lexer(text, m_Diagnostics, startPosition), m_Arena(arena), m_Symbols(symbols), m_Options(options),
+	m_LexedCount(0), m_Position(0), m_IsRecovering(false), m_IsAborted(false), m_Depth(0)
 {
-	Lexer lexer(text);
-	SyntaxToken token;
-	do
+	if (text.length() > std::min(m_Options.MaxInputSize, static_cast<size_t>(INT32_MAX)))
 	{
-		token = lexer.Lex();
-
-		if (token.Kind != SyntaxKind::WhitespaceToken &&
-			token.Kind != SyntaxKind::CommentToken &&
-			token.Kind != SyntaxKind::NewlineToken &&
-			token.Kind != SyntaxKind::BadToken)
-		{
-			m_Tokens.push_back(token);
-		}
-	} while (token.Kind != SyntaxKind::EndOfFileToken);
+		m_Diagnostics.ReportInputTooLarge(std::min(m_Options.MaxInputSize, static_cast<size_t>(INT32_MAX)));
+		m_IsAborted = true;
+	}
 
-	if (!lexer.GetDiagnostics().IsEmpty())
-		m_Diagnostics = std::move(lexer.GetDiagnostics());
+	if (m_Options.BuildIndex)
+		m_IndexKey = m_Symbols.Intern(m_Options.IndexKey);
 }
 
 // Helpers
-const SyntaxToken& Parser::Peek(int32_t offset) const
+SyntaxToken Parser::Peek(int32_t offset)
 {
+	if (m_IsAborted)
+		return SyntaxToken(SyntaxKind::EndOfFileToken, static_cast<int32_t>(m_Text.length()), 0);
+
 	int32_t index = m_Position + offset;
-	if (index >= m_Tokens.size())
-		return m_Tokens[m_Tokens.size() - 1];
+	if (index < 0)
+		return SyntaxToken();
+
+	assert(index > m_LexedCount - LookaheadSize && "Token fell out of the lookahead ring");
+
+	while (m_LexedCount <= index)
+	{
+		LAYOUTPARSER_STATS(auto lexStart = std::chrono::steady_clock::now());
+
+		SyntaxToken token;
+		do
+		{
+			token = m_Lexer.Lex();
+			LAYOUTPARSER_STATS(m_Stats.Tokens[static_cast<size_t>(token.Kind)]++);
+		}
+		while (token.Kind == SyntaxKind::BadToken);
+
+		LAYOUTPARSER_STATS(m_Stats.LexMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - lexStart).count());
+
+		m_Lookahead[m_LexedCount % LookaheadSize] = token;
+		m_LexedCount++;
+
+		// The lexer reports straight into the collection, so this is where the count is seen
+		if (m_Diagnostics.Size() >= m_Options.MaxErrors)
+		{
+			m_Diagnostics.ReportTooManyErrors(token.GetSpan(), m_Options.MaxErrors);
+			m_IsAborted = true;
+			return Peek(offset);
+		}
+	}
 
-	return m_Tokens[index];
+	return m_Lookahead[index % LookaheadSize];
 }
 
 SyntaxToken Parser::MatchToken(SyntaxKind kind)
 {
-	// Kinda an expensive function since it always creates a new string
 	if (Current().Kind == kind)
+	{
+		m_IsRecovering = false;
 		return NextToken();
+	}
 
-	m_Diagnostics.ReportUnexpectedToken(Current().Kind, kind);
-	return SyntaxToken(kind, Current().Position, "");
+	if (ShouldReport())
+		m_Diagnostics.ReportUnexpectedToken(Current().GetSpan(), Current().Kind, kind);
+	return SyntaxToken(kind, Current().Position, 0);
+}
+
+void Parser::Synchronize(SyntaxKind separatorKind, SyntaxKind closingKind)
+{
+	if (ShouldReport())
+		m_Diagnostics.ReportUnexpectedToken(Current().GetSpan(), Current().Kind, closingKind);
+
+	// Only the brackets that make up constructs count, parentheses are left to the expressions
+	int32_t depth = 0;
+	while (Current().Kind != SyntaxKind::EndOfFileToken)
+	{
+		SyntaxKind kind = Current().Kind;
+		if (depth == 0)
+		{
+			if (kind == separatorKind || kind == closingKind)
+			{
+				m_IsRecovering = false;
+				return;
+			}
+
+			// Belongs to something further out, which gets to recover from it
+			bool isEnclosing = std::find(m_ClosingTokens.begin(), m_ClosingTokens.end(), kind) != m_ClosingTokens.end();
+			if (isEnclosing)
+				return;
+		}
+
+		if (kind == SyntaxKind::OpenAngleBracketToken || kind == SyntaxKind::OpenSquigglyBracketToken || kind == SyntaxKind::OpenSquareBracketToken)
+			depth++;
+		else if (depth > 0 && (kind == SyntaxKind::CloseAngleBracketToken || kind == SyntaxKind::CloseSquigglyBracketToken || kind == SyntaxKind::CloseSquareBracketToken))
+			depth--;
+
+		NextToken();
+	}
+}
+
+void Parser::EnterNesting()
+{
+	LAYOUTPARSER_STATS(m_Stats.MaxDepth = std::max(m_Stats.MaxDepth, m_Depth + 1));
+
+	if (++m_Depth <= m_Options.MaxDepth || m_IsAborted)
+		return;
+
+	// Everything after this is the end of the file, so the recursion unwinds right away
+	m_Diagnostics.ReportNestingTooDeep(Current().GetSpan(), m_Options.MaxDepth);
+	m_IsAborted = true;
 }
 
 // Parse logic
-std::unordered_map<std::string, Layout> Parser::Parse()
+FlatMap<Layout> Parser::Parse()
 {
-	std::unordered_map<std::string, Layout> layouts;
+	FlatMap<Layout> layouts;
 	do
 	{
 		if (Current().Kind == SyntaxKind::EndOfFileToken)
 			break;
 
-		SyntaxToken layoutIdentifier = MatchToken(SyntaxKind::IdentifierToken);
-		layouts.emplace(layoutIdentifier.Text, std::move(ParseLayoutBody()));
+		InternedSymbol layoutName;
+		Layout layout = ParseLayout(layoutName);
+		TextSpan nameSpan(layout.GetSpan().Start, static_cast<int32_t>(layoutName.Name.length()));
+		bool isAdded = layouts.Emplace(layoutName.Id, layoutName.Name, std::move(layout));
+		if (!isAdded)
+			m_Diagnostics.ReportDuplicateLayout(nameSpan, layoutName.Name);
+
+		// A layout that lost its name to an earlier one isn't in the collection, so neither are its objects
+		if (m_Options.BuildIndex)
+		{
+			if (isAdded)
+				m_Index.CommitLayout(layoutName.Id);
+			else
+				m_Index.RollbackLayout();
+		}
 
 	} while (Current().Kind == SyntaxKind::IdentifierToken);
 
+	if (m_Options.BuildIndex)
+		m_Index.Finish();
+
 	return layouts;
 }
 
-std::vector<Object*> Parser::ParseLayoutBody()
+Layout Parser::ParseLayout(InternedSymbol& name)
+{
+	SyntaxToken layoutIdentifier = MatchToken(SyntaxKind::IdentifierToken);
+	name = m_Symbols.Intern(GetText(layoutIdentifier));
+	if (m_Options.BuildIndex)
+		m_Index.BeginLayout();
+
+	return ParseLayoutBody(layoutIdentifier.Position);
+}
+
+Layout Parser::ParseLayoutBody(int32_t layoutStart)
 {
 	MatchToken(SyntaxKind::OpenSquigglyBracketToken);
 
-	std::vector<Object*> objects;
-	do
+	m_LayoutObjects.clear();
+	m_LayoutObjectSpans.clear();
+	m_ClosingTokens.push_back(SyntaxKind::CloseSquigglyBracketToken);
+	while (Current().Kind != SyntaxKind::CloseSquigglyBracketToken && Current().Kind != SyntaxKind::EndOfFileToken)
 	{
-		if (Current().Kind == SyntaxKind::CloseSquigglyBracketToken)
-			break;
+		// Anything between objects is skipped up to the next one
+		if (Current().Kind != SyntaxKind::OpenAngleBracketToken)
+		{
+			Synchronize(SyntaxKind::OpenAngleBracketToken, SyntaxKind::CloseSquigglyBracketToken);
+			continue;
+		}
 
-		objects.push_back(ParseObject());
+		TextSpan span;
+		m_LayoutObjects.push_back(ParseLayoutObject(layoutStart, span));
+		m_LayoutObjectSpans.push_back(span);
+	}
+	m_ClosingTokens.pop_back();
 
-	} while (Current().Kind == SyntaxKind::OpenAngleBracketToken);
+	SyntaxToken closingBracket = MatchToken(SyntaxKind::CloseSquigglyBracketToken);
 
-	MatchToken(SyntaxKind::CloseSquigglyBracketToken);
+	return Layout(
+		m_Arena.CopyArray(m_LayoutObjects.data(), m_LayoutObjects.size()),
+		m_Arena.CopyArray(m_LayoutObjectSpans.data(), m_LayoutObjectSpans.size()),
+		m_LayoutObjects.size(),
+		TextSpan(layoutStart, closingBracket.Position + closingBracket.Length - layoutStart));
+}
+
+Object* Parser::ParseLayoutObject(int32_t layoutStart, TextSpan& span)
+{
+	int32_t start = Current().Position;
+	Object* object = ParseObject();
 
-	return objects;
+	SyntaxToken last = Peek(-1);
+	span = TextSpan(start - layoutStart, last.Position + last.Length - start);
+	return object;
 }
 
 Object* Parser::ParseObject()
 {
+	EnterNesting();
 	MatchToken(SyntaxKind::OpenAngleBracketToken);
 	SyntaxToken identifier = MatchToken(SyntaxKind::IdentifierToken);
+	InternedSymbol symbol = m_Symbols.Intern(GetText(identifier));
+	size_t indexSlot = m_Options.BuildIndex ? m_Index.ReserveObject(symbol.Id) : 0;
 
 	MatchToken(SyntaxKind::OpenParenthesisToken);
 	Value* constructor = nullptr;
@@ -99,229 +225,275 @@ Object* Parser::ParseObject()
 		constructor = ParseValue();
 	MatchToken(SyntaxKind::CloseParenthesisToken);
 
-	std::unordered_map<std::string, Value*> properties;
+	const Value* key = nullptr;
+	TextSpan keySpan;
+
+	size_t stackStart = m_PropertyStack.size();
+	m_ClosingTokens.push_back(SyntaxKind::CloseAngleBracketToken);
 	do
 	{
 		if (Current().Kind == SyntaxKind::CommaToken)
-			NextToken();
+			MatchToken(SyntaxKind::CommaToken);
 		else if (Current().Kind == SyntaxKind::CloseAngleBracketToken)
 			break;
 
 		SyntaxToken propertyName = MatchToken(SyntaxKind::IdentifierToken);
+		InternedSymbol propertySymbol = m_Symbols.Intern(GetText(propertyName));
 		MatchToken(SyntaxKind::EqualsToken);
-		properties[propertyName.Text] = ParseValue();
+		int32_t valueStart = Current().Position;
+		Value* value = ParseValue();
+		m_PropertyStack.emplace_back(propertySymbol, value);
+
+		// A repeated key overwrites, so the last one is what the object ends up with
+		if (propertySymbol.Id == m_IndexKey.Id)
+		{
+			SyntaxToken last = Peek(-1);
+			key = value;
+			keySpan = TextSpan(valueStart, last.Position + last.Length - valueStart);
+		}
+
+		if (Current().Kind != SyntaxKind::CommaToken && Current().Kind != SyntaxKind::CloseAngleBracketToken)
+			Synchronize(SyntaxKind::CommaToken, SyntaxKind::CloseAngleBracketToken);
 
 	} while (Current().Kind == SyntaxKind::CommaToken);
+	m_ClosingTokens.pop_back();
 
 	MatchToken(SyntaxKind::CloseAngleBracketToken);
+	ExitNesting();
+
+	FlatMap<Value*> properties = PopProperties<Value*>(stackStart);
+	LAYOUTPARSER_STATS(m_Stats.Objects++);
+	Object* object = m_Arena.New<Object>(symbol.Id, symbol.Name, constructor, std::move(properties));
+
+	if (m_Options.BuildIndex)
+		IndexObject(indexSlot, object, key, keySpan);
+	return object;
+}
+
+void Parser::IndexObject(size_t slot, const Object* object, const Value* key, TextSpan keySpan)
+{
+	m_Index.SetObject(slot, object);
 
-	return new Object(identifier.Text, constructor, std::move(properties));
+	// Only string values are keys. Objects are added once they are complete, so of two with the
+	// same key in each other, the inner one is kept.
+	const StringValue* keyString = (key != nullptr) ? key->AsString() : nullptr;
+	if (keyString != nullptr && !m_Index.AddKey(keyString->GetValue(), object) && !m_IsAborted)
+		m_Diagnostics.ReportDuplicateKey(keySpan, m_IndexKey.Name, keyString->GetValue());
 }
 
 Value* Parser::ParseValue()
 {
+	Value* value;
 	switch (Current().Kind)
 	{
 	case SyntaxKind::OpenAngleBracketToken:
-		return new ObjectValue(ParseObject());
+		value = m_Arena.New<ObjectValue>(ParseObject());
+		break;
 	case SyntaxKind::StringToken:
 	{
-		// Using pointer to avoid copies. Not sure if this is the best solution
-		const std::string* tokenText = &NextToken().Text;
-		return new StringValue(tokenText->substr(1, tokenText->length() - 2));
+		std::string_view tokenText = GetText(NextToken());
+		value = m_Arena.New<StringValue>(m_Arena.CopyString(tokenText.substr(1, tokenText.length() - 2)));
+		break;
 	}
 	case SyntaxKind::TrueKeyword:
 	case SyntaxKind::FalseKeyword:
-		return new BooleanValue(NextToken().Kind == SyntaxKind::TrueKeyword);
+		value = m_Arena.New<BooleanValue>(NextToken().Kind == SyntaxKind::TrueKeyword);
+		break;
 	case SyntaxKind::HexColorToken:
-		return new HexColorValue(NextToken().Text);
+		value = m_Arena.New<HexColorValue>(GetText(NextToken()));
+		break;
 	case SyntaxKind::OpenSquareBracketToken:
-		return ParseDictionary();
+		value = ParseDictionary();
+		break;
 	case SyntaxKind::OpenSquigglyBracketToken:
-		return ParseList();
+		value = ParseList();
+		break;
 	default:
-		return ParseNumber();
+		value = ParseNumber();
+		break;
 	}
+
+	LAYOUTPARSER_STATS(m_Stats.Values[static_cast<size_t>(value->GetKind())]++);
+	return value;
 }
 
 ListValue* Parser::ParseList()
 {
+	EnterNesting();
 	MatchToken(SyntaxKind::OpenSquigglyBracketToken);
 
-	std::vector<const Value*> listValues;
+	std::pmr::vector<const Value*> listValues(&m_Arena);
+	m_ClosingTokens.push_back(SyntaxKind::CloseSquigglyBracketToken);
 	do
 	{
 		if (Current().Kind == SyntaxKind::CommaToken)
-			NextToken();
+			MatchToken(SyntaxKind::CommaToken);
 		else if (Current().Kind == SyntaxKind::CloseSquigglyBracketToken)
 			break;
 
 		listValues.push_back(ParseValue());
 
+		if (Current().Kind != SyntaxKind::CommaToken && Current().Kind != SyntaxKind::CloseSquigglyBracketToken)
+			Synchronize(SyntaxKind::CommaToken, SyntaxKind::CloseSquigglyBracketToken);
+
 	} while (Current().Kind == SyntaxKind::CommaToken);
+	m_ClosingTokens.pop_back();
 
 	MatchToken(SyntaxKind::CloseSquigglyBracketToken);
+	ExitNesting();
 
-	return new ListValue(std::move(listValues));
+	return m_Arena.New<ListValue>(std::move(listValues));
 }
 
 DictionaryValue* Parser::ParseDictionary()
 {
+	EnterNesting();
 	MatchToken(SyntaxKind::OpenSquareBracketToken);
 
-	std::unordered_map<std::string, const Value*> dictionaryValues;
+	size_t stackStart = m_PropertyStack.size();
+	m_ClosingTokens.push_back(SyntaxKind::CloseSquareBracketToken);
 	do
 	{
 		if (Current().Kind == SyntaxKind::CommaToken)
-			NextToken();
+			MatchToken(SyntaxKind::CommaToken);
 		else if (Current().Kind == SyntaxKind::CloseSquareBracketToken)
 			break;
 
 		SyntaxToken keyIdentifier = MatchToken(SyntaxKind::IdentifierToken);
+		InternedSymbol keySymbol = m_Symbols.Intern(GetText(keyIdentifier));
 		MatchToken(SyntaxKind::EqualsToken);
-		dictionaryValues[keyIdentifier.Text] = ParseValue();
+		m_PropertyStack.emplace_back(keySymbol, ParseValue());
+
+		if (Current().Kind != SyntaxKind::CommaToken && Current().Kind != SyntaxKind::CloseSquareBracketToken)
+			Synchronize(SyntaxKind::CommaToken, SyntaxKind::CloseSquareBracketToken);
 
 	} while (Current().Kind == SyntaxKind::CommaToken);
+	m_ClosingTokens.pop_back();
 
 	MatchToken(SyntaxKind::CloseSquareBracketToken);
+	ExitNesting();
 
-	return new DictionaryValue(std::move(dictionaryValues));
+	return m_Arena.New<DictionaryValue>(PopProperties<const Value*>(stackStart));
 }
 
-NumberValue* Parser::ParseNumber()
+template<typename TValue>
+FlatMap<TValue> Parser::PopProperties(size_t stackStart)
 {
-	// Get a list of expression tokens
-	int32_t parenthesisDepth = 0;
-	std::vector<const SyntaxToken*> expressionTokens;
-	while (SyntaxFacts::IsExpressionToken(Current().Kind) &&
-		(Current().Kind != SyntaxKind::CloseParenthesisToken || parenthesisDepth != 0))
+	FlatMap<TValue> properties(&m_Arena);
+	properties.Reserve(m_PropertyStack.size() - stackStart);
+
+	for (size_t i = stackStart; i < m_PropertyStack.size(); i++)
 	{
-		if (Current().Kind == SyntaxKind::OpenParenthesisToken)
-			parenthesisDepth++;
-		else if (Current().Kind == SyntaxKind::CloseParenthesisToken)
-			parenthesisDepth--;
-		expressionTokens.push_back(&NextToken());
+		const InternedSymbol& symbol = m_PropertyStack[i].first;
+		properties.Set(symbol.Id, symbol.Name, m_PropertyStack[i].second);
 	}
 
-	// Convert infix to postfix
-	std::vector<const SyntaxToken*> postfixResult;
+	m_PropertyStack.resize(stackStart);
+	return properties;
+}
 
+NumberValue* Parser::ParseNumber()
+{
+	float value = ParseExpression(0);
+
+	// Two operands in a row, like "1 2" or "2 (3)". Skip the rest of the expression so the
+	// caller doesn't trip over it as well.
+	if (Current().Kind == SyntaxKind::NumberToken || Current().Kind == SyntaxKind::OpenParenthesisToken)
 	{
-		std::stack<const SyntaxToken*> algorithmStack;
+		if (ShouldReport())
+			m_Diagnostics.ReportMissingOperator(Current().GetSpan(), Current().Kind);
 
-		for (const SyntaxToken* token : expressionTokens)
+		int32_t parenthesisDepth = 0;
+		while (SyntaxFacts::IsExpressionToken(Current().Kind) &&
+			(Current().Kind != SyntaxKind::CloseParenthesisToken || parenthesisDepth != 0))
 		{
-			switch (token->Kind)
-			{
-			case SyntaxKind::NumberToken:
-				postfixResult.push_back(token);
-				break;
-			case SyntaxKind::OpenParenthesisToken:
-				algorithmStack.push(token);
-				break;
-			case SyntaxKind::CloseParenthesisToken:
-				while (!algorithmStack.empty() && algorithmStack.top()->Kind != SyntaxKind::OpenParenthesisToken)
-				{
-					postfixResult.push_back(algorithmStack.top());
-					algorithmStack.pop();
-				}
-				algorithmStack.pop();
-				break;
-			default: // Operator token
-			{
-				const SyntaxKind currentKind = token->Kind;
-				while (!algorithmStack.empty())
-				{
-					const SyntaxKind topKind = algorithmStack.top()->Kind;
-					if ((SyntaxFacts::IsOperatorLeftAssociative(currentKind) &&
-						SyntaxFacts::GetOperatorPrecedence(currentKind) <= SyntaxFacts::GetOperatorPrecedence(topKind)) ||
-						(!SyntaxFacts::IsOperatorLeftAssociative(currentKind) &&
-							SyntaxFacts::GetOperatorPrecedence(currentKind) < SyntaxFacts::GetOperatorPrecedence(topKind)))
-					{
-						postfixResult.push_back(algorithmStack.top());
-						algorithmStack.pop();
-						continue;
-					}
-					break;
-				}
-				algorithmStack.push(token);
-				break;
-			}
-			}
+			if (Current().Kind == SyntaxKind::OpenParenthesisToken)
+				parenthesisDepth++;
+			else if (Current().Kind == SyntaxKind::CloseParenthesisToken)
+				parenthesisDepth--;
+			NextToken();
 		}
 
-		while (!algorithmStack.empty())
-		{
-			if (algorithmStack.top()->Kind == SyntaxKind::OpenParenthesisToken)
-			{
-				m_Diagnostics.ReportMismatchedParentheses();
-				return new NumberValue(0.0f);
-			}
-
-			postfixResult.push_back(algorithmStack.top());
-			algorithmStack.pop();
-		}
+		value = 0.0f;
 	}
 
-	// Evaluate postfix
+	return m_Arena.New<NumberValue>(value);
+}
 
-	std::stack<float> evaluationStack;
+// Precedence climbing. The value is folded as the expression is parsed so nothing needs to
+// be buffered, the only state is the call stack.
+float Parser::ParseExpression(int32_t minimumPrecedence)
+{
+	EnterNesting();
+	float left = ParsePrimaryExpression();
 
-	for (const SyntaxToken* token : postfixResult)
+	while (true)
 	{
-		switch (token->Kind)
-		{
-		case SyntaxKind::NumberToken:
-			evaluationStack.push(token->Value);
+		const SyntaxKind operatorKind = Current().Kind;
+		const int32_t precedence = SyntaxFacts::GetOperatorPrecedence(operatorKind);
+		if (precedence < 0 || precedence < minimumPrecedence)
 			break;
-		case SyntaxKind::OpenParenthesisToken:
-			m_Diagnostics.ReportMismatchedParentheses();
-			return new NumberValue(0.0f);
-		case SyntaxKind::CloseParenthesisToken:
-			m_Diagnostics.ReportMismatchedParentheses();
-			return new NumberValue(0.0f);
-		default: // Operator
-		{
-			if (evaluationStack.size() < 2)
-			{
-				m_Diagnostics.ReportInvalidNumberExpression();
-				return new NumberValue(0.0f);
-			}
 
-			float right = evaluationStack.top();
-			evaluationStack.pop();
-			float left = evaluationStack.top();
-			evaluationStack.pop();
+		NextToken();
 
-			switch (token->Kind)
-			{
-			case SyntaxKind::CaretToken: // Exponent
-				evaluationStack.push(std::powf(left, right));
-				break;
-			case SyntaxKind::StarToken: // Multiplication
-				evaluationStack.push(left * right);
-				break;
-			case SyntaxKind::SlashToken: // Division
-				evaluationStack.push(left / right);
-				break;
-			case SyntaxKind::PlusToken: // Addition
-				evaluationStack.push(left + right);
-				break;
-			case SyntaxKind::MinusToken: // Subtraction
-				evaluationStack.push(left - right);
-				break;
-			default:
-				break;
-			}
+		// Left associative operators only let tighter operators into their right hand side
+		int32_t rightPrecedence = SyntaxFacts::IsOperatorLeftAssociative(operatorKind) ? precedence + 1 : precedence;
+		float right = ParseExpression(rightPrecedence);
+
+		switch (operatorKind)
+		{
+		case SyntaxKind::CaretToken: // Exponent
+			left = std::pow(left, right);
+			break;
+		case SyntaxKind::StarToken: // Multiplication
+			left = left * right;
+			break;
+		case SyntaxKind::SlashToken: // Division
+			left = left / right;
+			break;
+		case SyntaxKind::PlusToken: // Addition
+			left = left + right;
+			break;
+		case SyntaxKind::MinusToken: // Subtraction
+			left = left - right;
+			break;
+		default:
 			break;
-		}
 		}
 	}
 
-	if (evaluationStack.size() == 1)
-		return new NumberValue(evaluationStack.top());
-	else if (evaluationStack.size() != 0)
-		m_Diagnostics.ReportInvalidNumberExpression();
+	ExitNesting();
+	return left;
+}
+
+float Parser::ParsePrimaryExpression()
+{
+	switch (Current().Kind)
+	{
+	case SyntaxKind::NumberToken:
+		return NextToken().Value;
+	case SyntaxKind::MinusToken:
+	{
+		// Negation binds tighter than everything but exponents, so -2^2 is -4
+		NextToken();
+		return -ParseExpression(SyntaxFacts::GetUnaryOperatorPrecedence(SyntaxKind::MinusToken));
+	}
+	case SyntaxKind::OpenParenthesisToken:
+	{
+		NextToken();
+		float value = ParseExpression(0);
+
+		if (Current().Kind == SyntaxKind::CloseParenthesisToken)
+			NextToken();
+		else if (ShouldReport())
+			m_Diagnostics.ReportMismatchedParentheses(Current().GetSpan());
 
-	return new NumberValue(0.0f);
-}
\ No newline at end of file
+		return value;
+	}
+	default:
+		// Don't consume it, whatever called ParseValue knows better what to do with it
+		if (ShouldReport())
+			m_Diagnostics.ReportUnexpectedTokenInExpression(Current().GetSpan(), Current().Kind);
+		return 0.0f;
+	}
+}
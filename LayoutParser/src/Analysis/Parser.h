@@ -1,13 +1,22 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
-#include <unordered_map>
+#include <utility>
+#include <memory_resource>
 
 #include "Analysis/SyntaxToken.h"
+#include "Analysis/Lexer.h"
 #include "Analysis/Diagnostics.h"
+#include "Analysis/ParseOptions.h"
+#include "Analysis/ParseStats.h"
 
 #include "Data/LayoutCollection.h"
+#include "Data/FlatMap.h"
+#include "Data/ObjectIndex.h"
+#include "Data/SymbolTable.h"
+#include "Data/TextSpan.h"
 
 namespace LayoutParser
 {
@@ -17,38 +26,121 @@ namespace LayoutParser
 	struct ListValue;
 	struct DictionaryValue;
 	struct NumberValue;
+	class Arena;
 
 	class Parser
 	{
 	public:
-		Parser(const std::string& text);
+		// Every node, string and container is allocated from the arena and every name is
+		// interned into the symbol table. The text is not copied, so it has to outlive the parser.
+		// Several parsers can share one symbol table across threads, but not an arena.
+		// Parsing starts at startPosition, which lets a parser work on one range of a larger text
+		// (cut the text off at the end of the range) while positions stay relative to the whole.
+		Parser(std::string_view text, Arena& arena, SymbolTable& symbols, int32_t startPosition = 0, const ParseOptions& options = ParseOptions());
 
 		inline DiagnosticCollection& GetDiagnostics() { return m_Diagnostics; }
 
-		std::unordered_map<std::string, Layout> Parse();
+		// Parse stops at the first token that can't start a layout, this tells whether that was the end.
+		// Never true once a limit stopped the parse.
+		inline bool IsAtEnd() { return !m_IsAborted && Current().Kind == SyntaxKind::EndOfFileToken; }
+
+		FlatMap<Layout> Parse();
+
+		// Only filled in with ParseOptions::BuildIndex, and finished once Parse returns
+		inline ObjectIndex& GetIndex() { return m_Index; }
+
+#ifdef LAYOUTPARSER_ENABLE_STATS
+		// Tokens, nodes, depth and lexing time so far. The rest of ParseStats is up to the caller.
+		inline const ParseStats& GetStats() const { return m_Stats; }
+#endif
+
+		// Single steps of Parse for LayoutCollection::Reparse, which parses one top-level layout
+		// or layout object at a time and stops once the next token lines up with unchanged text
+		inline SyntaxToken PeekToken() { return Current(); }
+		inline void SkipToken() { NextToken(); }
+
+		Layout ParseLayout(InternedSymbol& name);
+
+		// The span is relative to layoutStart
+		Object* ParseLayoutObject(int32_t layoutStart, TextSpan& span);
 
 	private:
-		std::vector<SyntaxToken> m_Tokens;
+		// The grammar never looks further than one token back or ahead, so tokens are pulled
+		// from the lexer on demand through this ring instead of lexing the whole file up front
+		static constexpr int32_t LookaheadSize = 4;
+
+		std::string_view m_Text;
 		DiagnosticCollection m_Diagnostics;
+		Lexer m_Lexer;
+		Arena& m_Arena;
+		SymbolCache m_Symbols;
+		ParseOptions m_Options;
 
+		SyntaxToken m_Lookahead[LookaheadSize];
+		int32_t m_LexedCount;
 		int32_t m_Position;
 
-		// Returning const because vector is returning that and the parser shouldn't edit anything anyway
-		const SyntaxToken& Peek(int32_t offset) const;
+		// Panic mode. After an error only the first problem is reported until the parser has
+		// skipped to a token it can continue from, so one mistake doesn't cascade.
+		bool m_IsRecovering;
+
+		// Set once a limit is hit, from then on every token is the end of the file
+		bool m_IsAborted;
+		int32_t m_Depth;
+
+#ifdef LAYOUTPARSER_ENABLE_STATS
+		ParseStats m_Stats;
+#endif
+
+		// Closing tokens of the objects, lists and dictionaries the parser is inside of
+		std::vector<SyntaxKind> m_ClosingTokens;
+
+		// Properties of the objects and dictionaries currently being parsed. Nested ones push
+		// on top and pop their own back off, so each map gets copied into the arena at its final size.
+		std::vector<std::pair<InternedSymbol, Value*>> m_PropertyStack;
 
-		inline const SyntaxToken& Current() const { return Peek(0); }
+		// Objects of the layout being parsed, copied into the arena once it is done
+		std::vector<Object*> m_LayoutObjects;
+		std::vector<TextSpan> m_LayoutObjectSpans;
 
-		inline const SyntaxToken& NextToken()
+		// Filled in as objects complete when ParseOptions::BuildIndex is set
+		ObjectIndex m_Index;
+		InternedSymbol m_IndexKey;
+
+		// Tokens are only 16 bytes now so they are cheap to hand out by value
+		SyntaxToken Peek(int32_t offset);
+
+		inline SyntaxToken Current() { return Peek(0); }
+
+		inline SyntaxToken NextToken()
 		{
 			m_Position++;
-			return Peek(-1); // Kinda hacky but should save a constructor call in theory
+			return Peek(-1);
 		}
 
+		inline std::string_view GetText(const SyntaxToken& token) const { return token.GetText(m_Text); }
+
 		SyntaxToken MatchToken(SyntaxKind kind);
 
-		std::vector<Object*> ParseLayoutBody();
+		// Reports are only made outside of panic mode, every call enters it
+		inline bool ShouldReport()
+		{
+			bool shouldReport = !m_IsRecovering && !m_IsAborted;
+			m_IsRecovering = true;
+			return shouldReport;
+		}
+
+		// Skips to the next separator or closing token of the innermost construct, stepping over
+		// anything nested. Stops early at a closing token of an enclosing construct.
+		void Synchronize(SyntaxKind separatorKind, SyntaxKind closingKind);
+
+		void EnterNesting();
+		inline void ExitNesting() { m_Depth--; }
+
+		Layout ParseLayoutBody(int32_t layoutStart);
 
 		Object* ParseObject();
+		void IndexObject(size_t slot, const Object* object, const Value* key, TextSpan keySpan);
 
 		Value* ParseValue();
 
@@ -56,6 +148,11 @@ namespace LayoutParser
 
 		DictionaryValue* ParseDictionary();
 
+		template<typename TValue>
+		FlatMap<TValue> PopProperties(size_t stackStart);
+
 		NumberValue* ParseNumber();
+		float ParseExpression(int32_t minimumPrecedence);
+		float ParsePrimaryExpression();
 	};
 }
\ No newline at end of file
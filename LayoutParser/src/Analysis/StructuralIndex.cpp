@@ -0,0 +1,271 @@
+#include "Analysis/StructuralIndex.h"
+
+#include "Analysis/SyntaxFacts.h"
+
+#if !defined(LAYOUTPARSER_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+	#define LAYOUTPARSER_INDEX_SSE2
+	#include <emmintrin.h>
+#endif
+
+#if !defined(LAYOUTPARSER_NO_SIMD) && defined(__AVX2__)
+	#define LAYOUTPARSER_INDEX_AVX2
+	#include <immintrin.h>
+#endif
+
+#ifdef _MSC_VER
+	#include <intrin.h>
+#endif
+
+using namespace LayoutParser;
+
+namespace
+{
+	constexpr size_t BlockSize = 64;
+
+	enum class ScanMode
+	{
+		Normal,
+		String,
+		Comment
+	};
+
+	struct ScanState
+	{
+		ScanMode Mode = ScanMode::Normal;
+		int32_t HexColorRemaining = 0;
+	};
+
+	inline bool IsStructural(char character)
+	{
+		switch (character)
+		{
+		case '<': case '>': case '{': case '}': case '[': case ']': case '(': case ')': case '=': case ',':
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	// Mirrors what the lexer skips, so it agrees with it on where strings and comments are
+	size_t ScanScalar(std::string_view text, size_t position, size_t end, ScanState& state, uint32_t* output)
+	{
+		size_t count = 0;
+		for (; position < end; position++)
+		{
+			char character = text[position];
+			if (state.HexColorRemaining > 0)
+			{
+				state.HexColorRemaining--;
+				continue;
+			}
+
+			switch (state.Mode)
+			{
+			case ScanMode::String:
+				if (character == '"')
+					state.Mode = ScanMode::Normal;
+				break;
+			case ScanMode::Comment:
+				if (character == '\n')
+					state.Mode = ScanMode::Normal;
+				break;
+			case ScanMode::Normal:
+				if (character == '"')
+					state.Mode = ScanMode::String;
+				else if (character == '/' && position + 1 < text.length() && text[position + 1] == '/')
+				{
+					state.Mode = ScanMode::Comment;
+					position++;
+				}
+				else if (character == '#')
+					state.HexColorRemaining = 6;
+				else if (IsStructural(character))
+					output[count++] = static_cast<uint32_t>(position);
+				break;
+			}
+		}
+		return count;
+	}
+
+#if defined(LAYOUTPARSER_INDEX_SSE2) || defined(LAYOUTPARSER_INDEX_AVX2)
+	inline uint32_t CountTrailingZeros(uint64_t mask)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward64(&index, mask);
+		return static_cast<uint32_t>(index);
+#else
+		return static_cast<uint32_t>(__builtin_ctzll(mask));
+#endif
+	}
+
+	// Every bit from an opening quote up to (not including) its closing quote ends up set
+	inline uint64_t PrefixXor(uint64_t bits)
+	{
+		bits ^= bits << 1;
+		bits ^= bits << 2;
+		bits ^= bits << 4;
+		bits ^= bits << 8;
+		bits ^= bits << 16;
+		bits ^= bits << 32;
+		return bits;
+	}
+
+	struct BlockMasks
+	{
+		uint64_t Structurals;
+		uint64_t Quotes;
+		uint64_t Slashes;
+		uint64_t Hashes;
+	};
+
+#ifdef LAYOUTPARSER_INDEX_AVX2
+	inline uint64_t MoveMask(__m256i low, __m256i high)
+	{
+		return static_cast<uint32_t>(_mm256_movemask_epi8(low)) | (static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(high))) << 32);
+	}
+
+	inline __m256i Equals(__m256i characters, char character) { return _mm256_cmpeq_epi8(characters, _mm256_set1_epi8(character)); }
+
+	inline __m256i MatchStructurals(__m256i characters)
+	{
+		// ( ) and < = > are contiguous, the rest are checked one by one
+		__m256i parentheses = _mm256_or_si256(Equals(characters, '('), Equals(characters, ')'));
+		__m256i angles = _mm256_or_si256(_mm256_or_si256(Equals(characters, '<'), Equals(characters, '=')), Equals(characters, '>'));
+		__m256i brackets = _mm256_or_si256(Equals(characters, '['), Equals(characters, ']'));
+		__m256i braces = _mm256_or_si256(Equals(characters, '{'), Equals(characters, '}'));
+		return _mm256_or_si256(_mm256_or_si256(parentheses, angles), _mm256_or_si256(_mm256_or_si256(brackets, braces), Equals(characters, ',')));
+	}
+
+	inline BlockMasks ComputeMasks(const char* block)
+	{
+		__m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+		__m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32));
+
+		BlockMasks masks;
+		masks.Structurals = MoveMask(MatchStructurals(low), MatchStructurals(high));
+		masks.Quotes = MoveMask(Equals(low, '"'), Equals(high, '"'));
+		masks.Slashes = MoveMask(Equals(low, '/'), Equals(high, '/'));
+		masks.Hashes = MoveMask(Equals(low, '#'), Equals(high, '#'));
+		return masks;
+	}
+#else
+	inline uint64_t MoveMask(__m128i a, __m128i b, __m128i c, __m128i d)
+	{
+		return static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(a))) |
+			(static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(b))) << 16) |
+			(static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(c))) << 32) |
+			(static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(d))) << 48);
+	}
+
+	inline __m128i Equals(__m128i characters, char character) { return _mm_cmpeq_epi8(characters, _mm_set1_epi8(character)); }
+
+	inline __m128i MatchStructurals(__m128i characters)
+	{
+		__m128i parentheses = _mm_or_si128(Equals(characters, '('), Equals(characters, ')'));
+		__m128i angles = _mm_or_si128(_mm_or_si128(Equals(characters, '<'), Equals(characters, '=')), Equals(characters, '>'));
+		__m128i brackets = _mm_or_si128(Equals(characters, '['), Equals(characters, ']'));
+		__m128i braces = _mm_or_si128(Equals(characters, '{'), Equals(characters, '}'));
+		return _mm_or_si128(_mm_or_si128(parentheses, angles), _mm_or_si128(_mm_or_si128(brackets, braces), Equals(characters, ',')));
+	}
+
+	inline BlockMasks ComputeMasks(const char* block)
+	{
+		__m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+		__m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16));
+		__m128i v2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 32));
+		__m128i v3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 48));
+
+		BlockMasks masks;
+		masks.Structurals = MoveMask(MatchStructurals(v0), MatchStructurals(v1), MatchStructurals(v2), MatchStructurals(v3));
+		masks.Quotes = MoveMask(Equals(v0, '"'), Equals(v1, '"'), Equals(v2, '"'), Equals(v3, '"'));
+		masks.Slashes = MoveMask(Equals(v0, '/'), Equals(v1, '/'), Equals(v2, '/'), Equals(v3, '/'));
+		masks.Hashes = MoveMask(Equals(v0, '#'), Equals(v1, '#'), Equals(v2, '#'), Equals(v3, '#'));
+		return masks;
+	}
+#endif
+
+	// The bit tricks only cover quotes. A block can't take the fast path if it might start a
+	// comment, or if a hex color could swallow something the masks counted.
+	inline bool IsSimpleBlock(std::string_view text, size_t position, const BlockMasks& masks)
+	{
+		uint64_t slashes = masks.Slashes;
+		if ((slashes & (slashes >> 1)) != 0)
+			return false;
+		if ((slashes >> 63) != 0 && position + BlockSize < text.length() && text[position + BlockSize] == '/')
+			return false;
+
+		for (uint64_t hashes = masks.Hashes; hashes != 0; hashes &= hashes - 1)
+		{
+			size_t hash = position + CountTrailingZeros(hashes);
+			if (hash + 6 >= text.length())
+				return false;
+
+			for (size_t i = 1; i <= 6; i++)
+			{
+				if (!SyntaxFacts::IsDigitHex(text[hash + i]))
+					return false;
+			}
+		}
+		return true;
+	}
+#endif
+}
+
+void StructuralIndex::Build(std::string_view text)
+{
+	// Every block can add at most BlockSize positions, so keep that much room ahead of the
+	// write cursor and trim at the end
+	m_Positions.resize(text.length() / 4 + BlockSize);
+	size_t count = 0;
+
+	ScanState state;
+	size_t position = 0;
+
+#if defined(LAYOUTPARSER_INDEX_SSE2) || defined(LAYOUTPARSER_INDEX_AVX2)
+	for (; position + BlockSize <= text.length(); position += BlockSize)
+	{
+		if (m_Positions.size() < count + BlockSize)
+			m_Positions.resize(m_Positions.size() * 2);
+
+		uint32_t* output = m_Positions.data() + count;
+
+		if (state.Mode != ScanMode::Comment && state.HexColorRemaining == 0)
+		{
+			BlockMasks masks = ComputeMasks(text.data() + position);
+			if (IsSimpleBlock(text, position, masks))
+			{
+				uint64_t inString = PrefixXor(masks.Quotes);
+				if (state.Mode == ScanMode::String)
+					inString = ~inString;
+				state.Mode = ((inString >> 63) != 0) ? ScanMode::String : ScanMode::Normal;
+
+				for (uint64_t structurals = masks.Structurals & ~inString; structurals != 0; structurals &= structurals - 1)
+					*output++ = static_cast<uint32_t>(position + CountTrailingZeros(structurals));
+
+				count = output - m_Positions.data();
+				continue;
+			}
+		}
+
+		count += ScanScalar(text, position, position + BlockSize, state, output);
+	}
+#endif
+
+	if (m_Positions.size() < count + BlockSize)
+		m_Positions.resize(count + BlockSize);
+	count += ScanScalar(text, position, text.length(), state, m_Positions.data() + count);
+
+	m_Positions.resize(count);
+}
+
+const char* StructuralIndex::GetImplementationName()
+{
+#if defined(LAYOUTPARSER_INDEX_AVX2)
+	return "AVX2";
+#elif defined(LAYOUTPARSER_INDEX_SSE2)
+	return "SSE2";
+#else
+	return "scalar";
+#endif
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace LayoutParser
+{
+	// Positions of every structural character (< > { } [ ] ( ) = ,) outside of strings,
+	// comments and hex colors, found 64 bytes at a time. String regions come out of a prefix
+	// xor over the quote bits like in simdjson. Blocks that hold a comment or an odd hex color
+	// go through a byte-at-a-time state machine instead, which is rare in generated layouts.
+	//
+	// Uses the same compile time SIMD selection as CharacterScanner.
+	class StructuralIndex
+	{
+	public:
+		StructuralIndex() = default;
+		StructuralIndex(std::string_view text) { Build(text); }
+
+		// Replaces the contents with the index of the given text
+		void Build(std::string_view text);
+
+		inline size_t Size() const { return m_Positions.size(); }
+		inline bool IsEmpty() const { return m_Positions.empty(); }
+
+		inline uint32_t operator[](size_t index) const { return m_Positions[index]; }
+
+		auto begin() const { return m_Positions.begin(); }
+		auto end() const { return m_Positions.end(); }
+
+		static const char* GetImplementationName();
+
+	private:
+		std::vector<uint32_t> m_Positions;
+	};
+}
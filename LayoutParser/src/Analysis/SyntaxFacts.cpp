@@ -1,39 +1,48 @@
 #include "Analysis/SyntaxFacts.h"
 
-#include <iostream>
-
 using namespace LayoutParser;
 
-SyntaxKind SyntaxFacts::ParseKeywordKind(const std::string& keyword)
+// Keywords are case insensitive
+static bool EqualsIgnoreCase(std::string_view text, std::string_view lowerCaseKeyword)
 {
-	size_t stringSize = keyword.length() + 1;
+	if (text.length() != lowerCaseKeyword.length())
+		return false;
 
-	SyntaxKind returnType = SyntaxKind::IdentifierToken;
-	if (stringSize < 1000) // Completely arbitrary keyword size limit
+	for (size_t i = 0; i < text.length(); i++)
 	{
-		char* lowerCaseString = static_cast<char*>(_malloca(stringSize));
-		if (lowerCaseString == nullptr)
-			return SyntaxKind::IdentifierToken;
+		char character = text[i];
+		if (character >= 'A' && character <= 'Z')
+			character ^= ' ';
+
+		if (character != lowerCaseKeyword[i])
+			return false;
+	}
+
+	return true;
+}
 
-		memcpy(lowerCaseString, keyword.c_str(), stringSize);
+SyntaxKind SyntaxFacts::ParseKeywordKind(std::string_view keyword)
+{
+	if (EqualsIgnoreCase(keyword, "true"))
+		return SyntaxKind::TrueKeyword;
+	else if (EqualsIgnoreCase(keyword, "false"))
+		return SyntaxKind::FalseKeyword;
 
-		// Convert to lowercase
-		for (int32_t i = 0; i < static_cast<int32_t>(stringSize); i++)
-		{
-			char character = lowerCaseString[i];
-			if (character >= 'A' && character <= 'Z')
-				lowerCaseString[i] = character ^ ' ';
-		}
+	return SyntaxKind::IdentifierToken;
+}
 
-		if (!strcmp(lowerCaseString, "true"))
-			returnType = SyntaxKind::TrueKeyword;
-		else if (!strcmp(lowerCaseString, "false"))
-			returnType = SyntaxKind::FalseKeyword;
+bool SyntaxFacts::IsIdentifier(std::string_view text)
+{
+	if (text.empty() || !IdentifyIdentifier(text[0]))
+		return false;
 
-		_freea(lowerCaseString);
+	for (char character : text)
+	{
+		if (!IsIdentifierCharacter(character))
+			return false;
 	}
 
-	return returnType;
+	return ParseKeywordKind(text) == SyntaxKind::IdentifierToken;
 }
 
 bool SyntaxFacts::IsExpressionToken(SyntaxKind kind)
@@ -73,6 +82,17 @@ int32_t SyntaxFacts::GetOperatorPrecedence(SyntaxKind kind)
 	}
 }
 
+int32_t SyntaxFacts::GetUnaryOperatorPrecedence(SyntaxKind kind)
+{
+	switch (kind)
+	{
+	case SyntaxKind::MinusToken: // Negation
+		return 3;
+	default:
+		return -1; // Not a unary operator
+	}
+}
+
 bool SyntaxFacts::IsOperatorLeftAssociative(SyntaxKind kind)
 {
 	switch (kind)
@@ -1,6 +1,7 @@
 #pragma once
 
-#include <string>
+#include <string_view>
+#include <cstdint>
 
 #include "Analysis/SyntaxKind.h"
 
@@ -9,46 +10,106 @@ namespace LayoutParser
 	namespace SyntaxFacts
 	{
 		// Lexer data/helpers
-		const static std::string DIGITS_DEC = "0123456789.";
-		const static std::string DIGITS_HEX = "0123456789abcdefABCDEF";
-		const static std::string DIGITS_ALL = "0123456789abcdefABCDEF.";
+
+		// Bit flags for the character class table. Only ASCII is classified, every byte
+		// above 127 has no class so it ends up reported as a bad character.
+		enum CharacterClass : uint8_t
+		{
+			DigitClass = 1 << 0, // 0-9
+			HexDigitClass = 1 << 1, // 0-9 a-f A-F
+			NumberStartClass = 1 << 2, // 0-9 .
+			NumberBodyClass = 1 << 3, // 0-9 a-f A-F .
+			IdentifierStartClass = 1 << 4, // a-z A-Z _
+			IdentifierClass = 1 << 5, // a-z A-Z 0-9 _
+			WhitespaceClass = 1 << 6 // space \t \v \f \r
+		};
+
+		constexpr uint8_t ClassifyCharacter(unsigned char character)
+		{
+			uint8_t characterClass = 0;
+
+			bool isDigit = character >= '0' && character <= '9';
+			bool isLetter = (character >= 'a' && character <= 'z') || (character >= 'A' && character <= 'Z');
+			bool isHexLetter = (character >= 'a' && character <= 'f') || (character >= 'A' && character <= 'F');
+
+			if (isDigit)
+				characterClass |= DigitClass;
+			if (isDigit || isHexLetter)
+				characterClass |= HexDigitClass;
+			if (isDigit || character == '.')
+				characterClass |= NumberStartClass;
+			if (isDigit || isHexLetter || character == '.')
+				characterClass |= NumberBodyClass;
+			if (isLetter || character == '_')
+				characterClass |= IdentifierStartClass;
+			if (isLetter || isDigit || character == '_')
+				characterClass |= IdentifierClass;
+			if (character == ' ' || character == '\t' || character == '\v' || character == '\f' || character == '\r')
+				characterClass |= WhitespaceClass;
+
+			return characterClass;
+		}
+
+		struct CharacterClassTable
+		{
+			uint8_t Classes[256];
+
+			constexpr CharacterClassTable()
+				: Classes()
+			{
+				for (int32_t i = 0; i < 256; i++)
+					Classes[i] = ClassifyCharacter(static_cast<unsigned char>(i));
+			}
+		};
+
+		inline constexpr CharacterClassTable CHARACTER_CLASSES = CharacterClassTable();
+
+		inline bool HasCharacterClass(char character, CharacterClass characterClass)
+		{
+			return (CHARACTER_CLASSES.Classes[static_cast<unsigned char>(character)] & characterClass) != 0;
+		}
 
 		inline bool IdentifyNumberLiteral(char character)
 		{
-			return DIGITS_DEC.find(character) != std::string::npos;
+			return HasCharacterClass(character, NumberStartClass);
 		}
 
 		inline bool IdentifyIdentifier(char character)
 		{
-			return character == '_' || std::isalpha(character) != 0;
+			return HasCharacterClass(character, IdentifierStartClass);
 		}
 
 		inline bool IsDigitAnyBase(char character)
 		{
-			return DIGITS_ALL.find(character) != std::string::npos;
+			return HasCharacterClass(character, NumberBodyClass);
 		}
 
 		inline bool IsDigitHex(char character)
 		{
-			return DIGITS_HEX.find(character) != std::string::npos;
+			return HasCharacterClass(character, HexDigitClass);
 		}
 
 		inline bool IsIdentifierCharacter(char character)
 		{
-			return character == '_' || std::isalpha(character) != 0 || std::isdigit(character) != 0;
+			return HasCharacterClass(character, IdentifierClass);
 		}
 
+		// Carriage returns count as whitespace since mapped files keep their CRLF line endings
 		inline bool IsWhitespaceCharacter(char character)
 		{
-			return character == ' ' || character == '\t' || character == '\v' || character == '\f';
+			return HasCharacterClass(character, WhitespaceClass);
 		}
 
-		SyntaxKind ParseKeywordKind(const std::string& keyword);
+		SyntaxKind ParseKeywordKind(std::string_view keyword);
+
+		// Whether the text lexes as exactly one identifier, keywords don't count
+		bool IsIdentifier(std::string_view text);
 
 		// Parser data/helpers
 
 		bool IsExpressionToken(SyntaxKind kind);
 		int32_t GetOperatorPrecedence(SyntaxKind kind);
+		int32_t GetUnaryOperatorPrecedence(SyntaxKind kind);
 		bool IsOperatorLeftAssociative(SyntaxKind kind);
 	}
 }
\ No newline at end of file
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <cstdint>
+
 namespace LayoutParser
 {
-	enum class SyntaxKind
+	enum class SyntaxKind : uint8_t
 	{
 		// Tokens
 		BadToken,
@@ -1,46 +1,35 @@
 #pragma once
 
-#include <string>
+#include <string_view>
+#include <cstdint>
 
 #include "Analysis/SyntaxKind.h"
+#include "Data/TextSpan.h"
 
 namespace LayoutParser
 {
+	// Tokens don't own any text, they are just a span into the source buffer the lexer was given
 	struct SyntaxToken
 	{
-		// Regular Constructors
-		SyntaxToken(SyntaxKind kind, int32_t position, const std::string& text, float value)
-			: Kind(kind), Position(position), Text(text), Value(value) {}
+		SyntaxToken(SyntaxKind kind, int32_t position, int32_t length, float value)
+			: Kind(kind), Position(position), Length(length), Value(value) {}
 
-		SyntaxToken(SyntaxKind kind, int32_t position, const std::string& text)
-			: SyntaxToken(kind, position, text, 0.0f) {}
+		SyntaxToken(SyntaxKind kind, int32_t position, int32_t length)
+			: SyntaxToken(kind, position, length, 0.0f) {}
 
 		SyntaxToken()
-			: SyntaxToken(SyntaxKind::BadToken, -1, "", 0.0f) {}
+			: SyntaxToken(SyntaxKind::BadToken, -1, 0, 0.0f) {}
 
-		// Move/Copy Constructors
-
-		SyntaxToken(SyntaxToken&& other) noexcept
-			: Kind(other.Kind), Position(other.Position), Text(std::move(other.Text)), Value(other.Value) {}
-
-		SyntaxToken(const SyntaxToken& other) = default;
-
-		inline SyntaxToken& operator=(SyntaxToken&& other) noexcept
+		inline std::string_view GetText(std::string_view source) const
 		{
-			if (this != &other)
-			{
-				Kind = other.Kind;
-				Position = other.Position;
-				Text = std::move(other.Text);
-				Value = other.Value;
-			}
-
-			return *this;
+			return (Position < 0) ? std::string_view() : source.substr(Position, Length);
 		}
 
+		inline TextSpan GetSpan() const { return TextSpan(Position, Length); }
+
 		SyntaxKind Kind;
 		int32_t Position;
-		std::string Text;
+		int32_t Length;
 		float Value;
 	};
-}
\ No newline at end of file
+}
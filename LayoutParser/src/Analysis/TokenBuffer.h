@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "Analysis/SyntaxToken.h"
+
+namespace LayoutParser
+{
+	// Stores tokens as parallel arrays instead of a vector of SyntaxToken so each token only
+	// costs 13 bytes and scans over a single field (usually the kind) stay in cache
+	class TokenBuffer
+	{
+	public:
+		TokenBuffer() = default;
+
+		inline void Reserve(size_t count)
+		{
+			m_Kinds.reserve(count);
+			m_Positions.reserve(count);
+			m_Lengths.reserve(count);
+			m_Values.reserve(count);
+		}
+
+		inline void Push(const SyntaxToken& token)
+		{
+			m_Kinds.push_back(token.Kind);
+			m_Positions.push_back(token.Position);
+			m_Lengths.push_back(token.Length);
+			m_Values.push_back(token.Value);
+		}
+
+		inline void Clear()
+		{
+			m_Kinds.clear();
+			m_Positions.clear();
+			m_Lengths.clear();
+			m_Values.clear();
+		}
+
+		inline size_t Size() const { return m_Kinds.size(); }
+		inline bool IsEmpty() const { return m_Kinds.empty(); }
+
+		inline SyntaxKind GetKind(size_t index) const { return m_Kinds[index]; }
+		inline int32_t GetPosition(size_t index) const { return m_Positions[index]; }
+		inline int32_t GetLength(size_t index) const { return m_Lengths[index]; }
+		inline float GetValue(size_t index) const { return m_Values[index]; }
+
+		inline SyntaxToken operator[](size_t index) const
+		{
+			return SyntaxToken(m_Kinds[index], m_Positions[index], m_Lengths[index], m_Values[index]);
+		}
+
+		// Bytes actually held by the arrays, for comparing against the old vector<SyntaxToken>
+		inline size_t GetMemoryUsage() const
+		{
+			return m_Kinds.capacity() * sizeof(SyntaxKind) + m_Positions.capacity() * sizeof(int32_t) +
+				m_Lengths.capacity() * sizeof(int32_t) + m_Values.capacity() * sizeof(float);
+		}
+
+	private:
+		std::vector<SyntaxKind> m_Kinds;
+		std::vector<int32_t> m_Positions;
+		std::vector<int32_t> m_Lengths;
+		std::vector<float> m_Values;
+	};
+}
@@ -0,0 +1,75 @@
+#include "Data/Arena.h"
+
+#include <cstring>
+#include <cstdint>
+
+#include "Analysis/ParseStats.h"
+
+using namespace LayoutParser;
+
+std::string_view Arena::CopyString(std::string_view string)
+{
+	if (string.empty())
+		return std::string_view();
+
+	char* characters = static_cast<char*>(allocate(string.length(), 1));
+	std::memcpy(characters, string.data(), string.length());
+	return std::string_view(characters, string.length());
+}
+
+void Arena::Release()
+{
+	Block* block = m_CurrentBlock;
+	while (block != nullptr)
+	{
+		Block* previous = block->Previous;
+		m_Upstream->deallocate(block, block->Size, alignof(Block));
+		block = previous;
+	}
+
+	m_CurrentBlock = nullptr;
+	m_Cursor = nullptr;
+	m_End = nullptr;
+	m_BytesUsed = 0;
+	m_BytesReserved = 0;
+	m_AllocationCount = 0;
+}
+
+void* Arena::do_allocate(size_t bytes, size_t alignment)
+{
+	// Fast path is just a pointer bump inside the current block
+	uintptr_t cursor = reinterpret_cast<uintptr_t>(m_Cursor);
+	uintptr_t aligned = (cursor + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+
+	if (m_Cursor != nullptr && aligned + bytes <= reinterpret_cast<uintptr_t>(m_End))
+	{
+		m_Cursor = reinterpret_cast<char*>(aligned + bytes);
+		m_BytesUsed += bytes;
+		LAYOUTPARSER_STATS(m_AllocationCount++);
+		return reinterpret_cast<void*>(aligned);
+	}
+
+	return AllocateFromNewBlock(bytes, alignment);
+}
+
+void* Arena::AllocateFromNewBlock(size_t bytes, size_t alignment)
+{
+	// Blocks grow geometrically so big files don't end up with thousands of them
+	size_t blockSize = m_NextBlockSize;
+	while (blockSize < sizeof(Block) + bytes + alignment)
+		blockSize *= 2;
+
+	if (m_NextBlockSize < MaxBlockSize)
+		m_NextBlockSize *= 2;
+
+	Block* block = static_cast<Block*>(m_Upstream->allocate(blockSize, alignof(Block)));
+	block->Previous = m_CurrentBlock;
+	block->Size = blockSize;
+
+	m_CurrentBlock = block;
+	m_Cursor = reinterpret_cast<char*>(block + 1);
+	m_End = reinterpret_cast<char*>(block) + blockSize;
+	m_BytesReserved += blockSize;
+
+	return do_allocate(bytes, alignment);
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <cstring>
+#include <type_traits>
+#include <string_view>
+#include <memory_resource>
+
+namespace LayoutParser
+{
+	// Bump allocator that owns every node, string and container of a LayoutCollection.
+	// Deallocation is a no-op and everything is handed back to the upstream resource in
+	// one go when the arena is released, so nothing allocated from it may depend on its
+	// destructor running.
+	class Arena : public std::pmr::memory_resource
+	{
+	public:
+		Arena(std::pmr::memory_resource* upstream = std::pmr::get_default_resource(), size_t initialBlockSize = 16 * 1024)
+			: m_Upstream(upstream), m_CurrentBlock(nullptr), m_Cursor(nullptr), m_End(nullptr),
+			m_NextBlockSize(initialBlockSize), m_BytesUsed(0), m_BytesReserved(0), m_AllocationCount(0) {}
+
+		Arena(const Arena& other) = delete;
+		Arena& operator=(const Arena& other) = delete;
+
+		virtual ~Arena() override { Release(); }
+
+		template<typename T, typename... Args>
+		inline T* New(Args&&... args)
+		{
+			return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+		}
+
+		// Copies the characters into the arena. The returned view lives as long as the arena.
+		std::string_view CopyString(std::string_view string);
+
+		// Same for arrays of pointers and other plain data, nothing gets constructed
+		template<typename T>
+		inline T* CopyArray(const T* elements, size_t count)
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "Arena::CopyArray only copies plain data");
+			if (count == 0)
+				return nullptr;
+
+			T* copy = static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+			std::memcpy(copy, elements, sizeof(T) * count);
+			return copy;
+		}
+
+		// Frees every block at once. Anything previously allocated is invalid afterwards.
+		void Release();
+
+		inline std::pmr::memory_resource* GetUpstream() const { return m_Upstream; }
+
+		inline size_t GetBytesUsed() const { return m_BytesUsed; }
+		inline size_t GetBytesReserved() const { return m_BytesReserved; }
+
+		// Only counted when the library is built with LAYOUTPARSER_ENABLE_STATS, zero otherwise
+		inline size_t GetAllocationCount() const { return m_AllocationCount; }
+
+	private:
+		struct Block
+		{
+			Block* Previous;
+			size_t Size;
+		};
+
+		static constexpr size_t MaxBlockSize = 1024 * 1024;
+
+		std::pmr::memory_resource* m_Upstream;
+
+		Block* m_CurrentBlock;
+		char* m_Cursor;
+		char* m_End;
+
+		size_t m_NextBlockSize;
+		size_t m_BytesUsed;
+		size_t m_BytesReserved;
+		size_t m_AllocationCount;
+
+		void* AllocateFromNewBlock(size_t bytes, size_t alignment);
+
+		virtual void* do_allocate(size_t bytes, size_t alignment) override;
+		virtual void do_deallocate(void*, size_t, size_t) override {}
+		virtual bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+	};
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace LayoutParser
+{
+	// On-disk layout of compiled collections. Everything is little-endian and referenced
+	// by index or by byte offset from the start of the file, so an image can be read in place
+	// from wherever it is mapped.
+	//
+	//   Header
+	//   StringRecord[StringCount]   the first SymbolCount strings are the symbol table in id order
+	//   char[StringDataSize]        string bytes, not null terminated
+	//   LayoutRecord[LayoutCount]
+	//   Node[NodeCount]             children are always written before their parent
+	//   Entry[EntryCount]           properties of objects and dictionaries
+	//   uint32_t[ChildCount]        node indices of list items and layout objects
+	namespace BinaryFormat
+	{
+		constexpr char Magic[4] = { 'L', 'P', 'B', 'C' };
+		constexpr uint32_t Version = 1;
+
+		constexpr uint32_t NoNode = UINT32_MAX;
+
+		struct Section
+		{
+			uint32_t Offset;
+			uint32_t Count;
+		};
+
+		struct Header
+		{
+			char Magic[4];
+			uint32_t Version;
+
+			// See ComputeChecksum, covers every byte after the header
+			uint64_t Checksum;
+			uint64_t FileSize;
+
+			uint32_t SymbolCount;
+			uint32_t Reserved;
+
+			Section Strings;
+			Section StringData;
+			Section Layouts;
+			Section Nodes;
+			Section Entries;
+			Section Children;
+		};
+
+		struct StringRecord
+		{
+			uint32_t Offset; // into the string data
+			uint32_t Length;
+		};
+
+		struct LayoutRecord
+		{
+			uint32_t Name; // symbol
+			uint32_t FirstChild;
+			uint32_t ObjectCount;
+		};
+
+		enum class NodeKind : uint32_t
+		{
+			Object,
+			ObjectValue,
+			String,
+			Number,
+			Boolean,
+			HexColor,
+			List,
+			Dictionary
+		};
+
+		// What the fields mean depends on the kind:
+		//   Object       A = identifier symbol, B = constructor node or NoNode, C = first entry, D = entry count
+		//   ObjectValue  A = object node
+		//   String       A = string index
+		//   Number       A = bits of the float
+		//   Boolean      A = 0 or 1
+		//   HexColor     A = 0x00RRGGBB
+		//   List         A = first child, B = child count
+		//   Dictionary   A = first entry, B = entry count
+		struct Node
+		{
+			NodeKind Kind;
+			uint32_t A;
+			uint32_t B;
+			uint32_t C;
+			uint32_t D;
+		};
+
+		struct Entry
+		{
+			uint32_t Key; // symbol
+			uint32_t Value; // node
+		};
+
+		static_assert(sizeof(Header) == 80, "BinaryFormat::Header is part of the file format");
+		static_assert(sizeof(StringRecord) == 8 && sizeof(LayoutRecord) == 12 && sizeof(Node) == 20 && sizeof(Entry) == 8,
+			"BinaryFormat records are part of the file format");
+
+		// FNV-1a, fed eight bytes at a time so checking a large image doesn't cost more than reading it
+		inline uint64_t ComputeChecksum(const char* data, size_t size)
+		{
+			uint64_t hash = 14695981039346656037ull;
+
+			size_t i = 0;
+			for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+			{
+				uint64_t word;
+				std::memcpy(&word, data + i, sizeof(word));
+				hash ^= word;
+				hash *= 1099511628211ull;
+			}
+			for (; i < size; i++)
+			{
+				hash ^= static_cast<unsigned char>(data[i]);
+				hash *= 1099511628211ull;
+			}
+			return hash;
+		}
+	}
+}
@@ -0,0 +1,87 @@
+#include "Data/BinaryImage.h"
+
+#include <cstring>
+
+using namespace LayoutParser;
+
+BinaryImage::BinaryImage(std::string_view data)
+	: m_Error(nullptr), m_Header(nullptr), m_Strings(nullptr), m_StringData(nullptr),
+	m_Layouts(nullptr), m_Nodes(nullptr), m_Entries(nullptr), m_Children(nullptr)
+{
+	static BinaryFormat::Header emptyHeader = {};
+	m_Header = &emptyHeader;
+
+	if (data.length() < sizeof(BinaryFormat::Header) || reinterpret_cast<uintptr_t>(data.data()) % alignof(BinaryFormat::Header) != 0)
+	{
+		m_Error = "file is too small or misaligned";
+		return;
+	}
+
+	const BinaryFormat::Header* header = reinterpret_cast<const BinaryFormat::Header*>(data.data());
+	if (std::memcmp(header->Magic, BinaryFormat::Magic, sizeof(BinaryFormat::Magic)) != 0)
+	{
+		m_Error = "not a compiled layout file";
+		return;
+	}
+	if (header->Version != BinaryFormat::Version)
+	{
+		m_Error = "unsupported format version";
+		return;
+	}
+	if (header->FileSize != data.length())
+	{
+		m_Error = "file is truncated";
+		return;
+	}
+
+	size_t headerSize = sizeof(BinaryFormat::Header);
+	if (header->Checksum != BinaryFormat::ComputeChecksum(data.data() + headerSize, data.length() - headerSize))
+	{
+		m_Error = "checksum mismatch";
+		return;
+	}
+
+	m_Strings = GetSection<BinaryFormat::StringRecord>(data, header->Strings);
+	m_StringData = GetSection<char>(data, header->StringData);
+	m_Layouts = GetSection<BinaryFormat::LayoutRecord>(data, header->Layouts);
+	m_Nodes = GetSection<BinaryFormat::Node>(data, header->Nodes);
+	m_Entries = GetSection<BinaryFormat::Entry>(data, header->Entries);
+	m_Children = GetSection<uint32_t>(data, header->Children);
+	if (m_Error != nullptr)
+		return;
+
+	if (header->SymbolCount > header->Strings.Count)
+	{
+		m_Error = "symbol table is larger than the string table";
+		return;
+	}
+
+	// Strings are the only records read without going through an index the loader checks,
+	// so make sure none of them point outside the string data
+	for (uint32_t i = 0; i < header->Strings.Count; i++)
+	{
+		if (static_cast<uint64_t>(m_Strings[i].Offset) + m_Strings[i].Length > header->StringData.Count)
+		{
+			m_Error = "string outside of the string data";
+			return;
+		}
+	}
+
+	m_Header = header;
+}
+
+template<typename T>
+const T* BinaryImage::GetSection(std::string_view data, const BinaryFormat::Section& section)
+{
+	if (m_Error != nullptr)
+		return nullptr;
+
+	uint64_t end = static_cast<uint64_t>(section.Offset) + static_cast<uint64_t>(section.Count) * sizeof(T);
+	if (section.Offset % alignof(T) != 0 || section.Offset < sizeof(BinaryFormat::Header) || end > data.length())
+	{
+		m_Error = "section outside of the file";
+		return nullptr;
+	}
+
+	return reinterpret_cast<const T*>(data.data() + section.Offset);
+}
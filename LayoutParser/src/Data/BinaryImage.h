@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include "BinaryFormat.h"
+
+namespace LayoutParser
+{
+	// Read-only view over a compiled collection, usually straight out of a MappedFile.
+	// The constructor checks the header, the section bounds and the checksum; nothing is
+	// copied, so the data has to outlive the view.
+	class BinaryImage
+	{
+	public:
+		BinaryImage(std::string_view data);
+
+		inline bool IsValid() const { return m_Error == nullptr; }
+		inline const char* GetError() const { return m_Error; }
+
+		inline uint32_t GetSymbolCount() const { return m_Header->SymbolCount; }
+		inline uint32_t GetStringCount() const { return m_Header->Strings.Count; }
+		inline uint32_t GetLayoutCount() const { return m_Header->Layouts.Count; }
+		inline uint32_t GetNodeCount() const { return m_Header->Nodes.Count; }
+		inline uint32_t GetEntryCount() const { return m_Header->Entries.Count; }
+		inline uint32_t GetChildCount() const { return m_Header->Children.Count; }
+
+		inline std::string_view GetString(uint32_t index) const
+		{
+			const BinaryFormat::StringRecord& record = m_Strings[index];
+			return std::string_view(m_StringData + record.Offset, record.Length);
+		}
+
+		// All string bytes in one block, GetString views point into it
+		inline std::string_view GetStringData() const { return std::string_view(m_StringData, m_Header->StringData.Count); }
+
+		inline const BinaryFormat::StringRecord& GetStringRecord(uint32_t index) const { return m_Strings[index]; }
+		inline const BinaryFormat::LayoutRecord& GetLayout(uint32_t index) const { return m_Layouts[index]; }
+		inline const BinaryFormat::Node& GetNode(uint32_t index) const { return m_Nodes[index]; }
+		inline const BinaryFormat::Entry& GetEntry(uint32_t index) const { return m_Entries[index]; }
+		inline uint32_t GetChild(uint32_t index) const { return m_Children[index]; }
+
+	private:
+		const char* m_Error;
+
+		const BinaryFormat::Header* m_Header;
+		const BinaryFormat::StringRecord* m_Strings;
+		const char* m_StringData;
+		const BinaryFormat::LayoutRecord* m_Layouts;
+		const BinaryFormat::Node* m_Nodes;
+		const BinaryFormat::Entry* m_Entries;
+		const uint32_t* m_Children;
+
+		template<typename T>
+		const T* GetSection(std::string_view data, const BinaryFormat::Section& section);
+	};
+}
@@ -0,0 +1,193 @@
+#include "Data/BinaryReader.h"
+
+#include <cstring>
+
+#include "Analysis/ParseOptions.h"
+
+#include "Data/Arena.h"
+#include "Data/SymbolTable.h"
+#include "Data/Object.h"
+#include "Data/Value.h"
+
+using namespace LayoutParser;
+
+BinaryReader::BinaryReader(const BinaryImage& image, Arena& arena, SymbolTable& symbols)
+	: m_Image(image), m_Arena(arena), m_Symbols(symbols), m_Error(nullptr), m_Depth(0)
+{
+}
+
+FlatMap<Layout> BinaryReader::Read()
+{
+	FlatMap<Layout> layouts;
+
+	// One copy for every string value in the file
+	m_StringData = m_Arena.CopyString(m_Image.GetStringData());
+
+	for (uint32_t id = 0; id < m_Image.GetSymbolCount(); id++)
+	{
+		if (m_Symbols.Intern(m_Image.GetString(id)).Id != id)
+		{
+			Fail("duplicate name in the symbol table");
+			return FlatMap<Layout>();
+		}
+	}
+
+	layouts.Reserve(m_Image.GetLayoutCount());
+	for (uint32_t i = 0; i < m_Image.GetLayoutCount() && !HasError(); i++)
+	{
+		const BinaryFormat::LayoutRecord& record = m_Image.GetLayout(i);
+		if (record.Name >= m_Image.GetSymbolCount() || !CheckRange(record.FirstChild, record.ObjectCount, m_Image.GetChildCount()))
+		{
+			Fail("layout record out of range");
+			break;
+		}
+
+		// The binary keeps no source text, so there are no spans to go with the objects
+		Object** objects = (record.ObjectCount != 0) ?
+			static_cast<Object**>(m_Arena.allocate(sizeof(Object*) * record.ObjectCount, alignof(Object*))) : nullptr;
+		for (uint32_t child = 0; child < record.ObjectCount; child++)
+			objects[child] = ReadObject(m_Image.GetChild(record.FirstChild + child), m_Image.GetNodeCount());
+
+		Symbol name(record.Name);
+		layouts.Emplace(name, m_Symbols.GetName(name), Layout(objects, nullptr, record.ObjectCount));
+	}
+
+	if (HasError())
+		return FlatMap<Layout>();
+
+	return layouts;
+}
+
+// Children are always written before their parent, so requiring every node index to be
+// below its parent's (the limit) rules out cycles in a tampered file
+Object* BinaryReader::ReadObject(uint32_t node, uint32_t limit)
+{
+	if (node >= limit || m_Image.GetNode(node).Kind != BinaryFormat::NodeKind::Object)
+	{
+		Fail("object node out of range");
+		return nullptr;
+	}
+
+	const BinaryFormat::Node& record = m_Image.GetNode(node);
+	if (record.A >= m_Image.GetSymbolCount())
+	{
+		Fail("object identifier out of range");
+		return nullptr;
+	}
+
+	if (!EnterNesting())
+		return nullptr;
+
+	Value* constructor = (record.B != BinaryFormat::NoNode) ? ReadValue(record.B, node) : nullptr;
+	FlatMap<Value*> properties = ReadEntries<Value*>(record.C, record.D, node);
+	ExitNesting();
+
+	Symbol symbol(record.A);
+	return m_Arena.New<Object>(symbol, m_Symbols.GetName(symbol), constructor, std::move(properties));
+}
+
+Value* BinaryReader::ReadValue(uint32_t node, uint32_t limit)
+{
+	if (node >= limit)
+	{
+		Fail("value node out of range");
+		return nullptr;
+	}
+
+	const BinaryFormat::Node& record = m_Image.GetNode(node);
+	switch (record.Kind)
+	{
+	case BinaryFormat::NodeKind::ObjectValue:
+		return m_Arena.New<ObjectValue>(ReadObject(record.A, node));
+	case BinaryFormat::NodeKind::String:
+	{
+		if (record.A >= m_Image.GetStringCount())
+			break;
+
+		const BinaryFormat::StringRecord& string = m_Image.GetStringRecord(record.A);
+		return m_Arena.New<StringValue>(m_StringData.substr(string.Offset, string.Length));
+	}
+	case BinaryFormat::NodeKind::Number:
+	{
+		float number;
+		std::memcpy(&number, &record.A, sizeof(number));
+		return m_Arena.New<NumberValue>(number);
+	}
+	case BinaryFormat::NodeKind::Boolean:
+		return m_Arena.New<BooleanValue>(record.A != 0);
+	case BinaryFormat::NodeKind::HexColor:
+		return m_Arena.New<HexColorValue>(static_cast<uint8_t>(record.A >> 16), static_cast<uint8_t>(record.A >> 8), static_cast<uint8_t>(record.A));
+	case BinaryFormat::NodeKind::List:
+	{
+		if (!CheckRange(record.A, record.B, m_Image.GetChildCount()))
+			break;
+		if (!EnterNesting())
+			return nullptr;
+
+		std::pmr::vector<const Value*> list(&m_Arena);
+		list.reserve(record.B);
+		for (uint32_t child = 0; child < record.B; child++)
+			list.push_back(ReadValue(m_Image.GetChild(record.A + child), node));
+		ExitNesting();
+
+		return m_Arena.New<ListValue>(std::move(list));
+	}
+	case BinaryFormat::NodeKind::Dictionary:
+	{
+		if (!EnterNesting())
+			return nullptr;
+
+		FlatMap<const Value*> dictionary = ReadEntries<const Value*>(record.A, record.B, node);
+		ExitNesting();
+		return m_Arena.New<DictionaryValue>(std::move(dictionary));
+	}
+	default:
+		break;
+	}
+
+	Fail("invalid value node");
+	return nullptr;
+}
+
+template<typename TValue>
+FlatMap<TValue> BinaryReader::ReadEntries(uint32_t firstEntry, uint32_t entryCount, uint32_t limit)
+{
+	FlatMap<TValue> entries(&m_Arena);
+	if (!CheckRange(firstEntry, entryCount, m_Image.GetEntryCount()))
+	{
+		Fail("entry range out of range");
+		return entries;
+	}
+
+	entries.Reserve(entryCount);
+	for (uint32_t i = firstEntry; i < firstEntry + entryCount; i++)
+	{
+		const BinaryFormat::Entry& entry = m_Image.GetEntry(i);
+		if (entry.Key >= m_Image.GetSymbolCount())
+		{
+			Fail("entry key out of range");
+			break;
+		}
+
+		Symbol key(entry.Key);
+		entries.Set(key, m_Symbols.GetName(key), ReadValue(entry.Value, limit));
+	}
+
+	return entries;
+}
+
+bool BinaryReader::EnterNesting()
+{
+	// Objects, lists and dictionaries count the way they do in the parser, so anything it
+	// produced within the default limit reads back
+	if (++m_Depth <= ParseOptions().MaxDepth)
+		return true;
+
+	Fail("nesting is too deep");
+	return false;
+}
+
+bool BinaryReader::CheckRange(uint32_t first, uint32_t count, uint32_t size)
+{
+	return static_cast<uint64_t>(first) + count <= size;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include "BinaryImage.h"
+#include "FlatMap.h"
+#include "LayoutCollection.h"
+
+namespace LayoutParser
+{
+	class Arena;
+	class SymbolTable;
+	struct Object;
+	struct Value;
+
+	// Builds the tree for a validated BinaryImage. There is no lexing or parsing involved,
+	// every node is one arena allocation. Indices are still checked while walking, so a file
+	// with a valid checksum but bad contents fails with an error instead of crashing.
+	class BinaryReader
+	{
+	public:
+		BinaryReader(const BinaryImage& image, Arena& arena, SymbolTable& symbols);
+
+		FlatMap<Layout> Read();
+
+		inline bool HasError() const { return m_Error != nullptr; }
+		inline const char* GetError() const { return m_Error; }
+
+	private:
+		const BinaryImage& m_Image;
+		Arena& m_Arena;
+		SymbolTable& m_Symbols;
+
+		const char* m_Error;
+		std::string_view m_StringData;
+
+		// Child indices only have to be below their parent's, which rules out cycles but not a
+		// chain deep enough to run out of stack, so nesting is capped like the parsers cap it
+		int32_t m_Depth;
+
+		Object* ReadObject(uint32_t node, uint32_t limit);
+		Value* ReadValue(uint32_t node, uint32_t limit);
+
+		template<typename TValue>
+		FlatMap<TValue> ReadEntries(uint32_t firstEntry, uint32_t entryCount, uint32_t limit);
+
+		bool EnterNesting();
+		inline void ExitNesting() { m_Depth--; }
+
+		static bool CheckRange(uint32_t first, uint32_t count, uint32_t size);
+		inline bool Fail(const char* error)
+		{
+			if (m_Error == nullptr)
+				m_Error = error;
+			return false;
+		}
+	};
+}
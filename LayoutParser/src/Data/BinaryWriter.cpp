@@ -0,0 +1,196 @@
+#include "Data/BinaryWriter.h"
+
+#include <cstring>
+
+#include "Data/LayoutCollection.h"
+#include "Data/Object.h"
+#include "Data/Value.h"
+
+using namespace LayoutParser;
+
+BinaryWriter::BinaryWriter(const LayoutCollection& collection)
+	: m_Collection(collection)
+{
+}
+
+std::vector<char> BinaryWriter::Write()
+{
+	// Layouts of a lazily loaded collection intern their names as they are parsed, so all of
+	// them are parsed before the symbols are counted
+	for (auto& pair : m_Collection)
+		pair.second.Size();
+
+	// Symbols go first so a symbol id is also its string index
+	const SymbolTable& symbols = m_Collection.GetSymbols();
+	uint32_t symbolCount = static_cast<uint32_t>(symbols.Size());
+	for (uint32_t id = 0; id < symbolCount; id++)
+		AddString(symbols.GetName(Symbol(id)));
+
+	for (auto& pair : m_Collection)
+	{
+		const Layout& layout = pair.second;
+
+		BinaryFormat::LayoutRecord record;
+		record.Name = m_Collection.FindSymbol(pair.first).Id;
+		record.FirstChild = static_cast<uint32_t>(m_Children.size());
+		record.ObjectCount = static_cast<uint32_t>(layout.Size());
+
+		// Reserve the slots first, the objects add their own children while being written
+		m_Children.resize(m_Children.size() + record.ObjectCount);
+		uint32_t child = record.FirstChild;
+		for (const Object* object : layout)
+			m_Children[child++] = WriteObject(object);
+
+		m_Layouts.push_back(record);
+	}
+
+	// Lay the sections out back to back, each one aligned for its records
+	BinaryFormat::Header header = {};
+	std::memcpy(header.Magic, BinaryFormat::Magic, sizeof(header.Magic));
+	header.Version = BinaryFormat::Version;
+	header.SymbolCount = symbolCount;
+
+	size_t offset = sizeof(BinaryFormat::Header);
+	auto placeSection = [&offset](BinaryFormat::Section& section, size_t count, size_t recordSize)
+	{
+		offset = (offset + 3) & ~static_cast<size_t>(3);
+		section.Offset = static_cast<uint32_t>(offset);
+		section.Count = static_cast<uint32_t>(count);
+		offset += count * recordSize;
+	};
+
+	placeSection(header.Strings, m_Strings.size(), sizeof(BinaryFormat::StringRecord));
+	placeSection(header.StringData, m_StringData.size(), 1);
+	placeSection(header.Layouts, m_Layouts.size(), sizeof(BinaryFormat::LayoutRecord));
+	placeSection(header.Nodes, m_Nodes.size(), sizeof(BinaryFormat::Node));
+	placeSection(header.Entries, m_Entries.size(), sizeof(BinaryFormat::Entry));
+	placeSection(header.Children, m_Children.size(), sizeof(uint32_t));
+	header.FileSize = offset;
+
+	std::vector<char> output(offset, 0);
+	auto copySection = [&output](const BinaryFormat::Section& section, const void* data, size_t bytes)
+	{
+		if (bytes != 0)
+			std::memcpy(output.data() + section.Offset, data, bytes);
+	};
+
+	copySection(header.Strings, m_Strings.data(), m_Strings.size() * sizeof(BinaryFormat::StringRecord));
+	copySection(header.StringData, m_StringData.data(), m_StringData.size());
+	copySection(header.Layouts, m_Layouts.data(), m_Layouts.size() * sizeof(BinaryFormat::LayoutRecord));
+	copySection(header.Nodes, m_Nodes.data(), m_Nodes.size() * sizeof(BinaryFormat::Node));
+	copySection(header.Entries, m_Entries.data(), m_Entries.size() * sizeof(BinaryFormat::Entry));
+	copySection(header.Children, m_Children.data(), m_Children.size() * sizeof(uint32_t));
+
+	size_t headerSize = sizeof(BinaryFormat::Header);
+	header.Checksum = BinaryFormat::ComputeChecksum(output.data() + headerSize, output.size() - headerSize);
+	std::memcpy(output.data(), &header, headerSize);
+
+	return output;
+}
+
+uint32_t BinaryWriter::AddString(std::string_view string)
+{
+	BinaryFormat::StringRecord record;
+	record.Offset = static_cast<uint32_t>(m_StringData.size());
+	record.Length = static_cast<uint32_t>(string.length());
+
+	m_StringData.append(string.data(), string.length());
+	m_Strings.push_back(record);
+
+	return static_cast<uint32_t>(m_Strings.size() - 1);
+}
+
+// The same string values show up all over a layout so they only get stored once
+uint32_t BinaryWriter::AddStringValue(std::string_view string)
+{
+	auto existing = m_StringValues.find(string);
+	if (existing != m_StringValues.end())
+		return existing->second;
+
+	uint32_t index = AddString(string);
+	m_StringValues.emplace(string, index);
+	return index;
+}
+
+uint32_t BinaryWriter::WriteObject(const Object* object)
+{
+	uint32_t constructor = (object->GetConstructor() != nullptr) ? WriteValue(object->GetConstructor()) : BinaryFormat::NoNode;
+
+	const FlatMap<Value*>& properties = object->GetContainer();
+	uint32_t firstEntry = static_cast<uint32_t>(m_Entries.size());
+	m_Entries.resize(m_Entries.size() + properties.Size());
+
+	uint32_t index = 0;
+	for (auto& pair : properties)
+	{
+		BinaryFormat::Entry entry;
+		entry.Key = properties.GetSymbol(index).Id;
+		entry.Value = WriteValue(pair.second);
+		m_Entries[firstEntry + index++] = entry;
+	}
+
+	return AddNode(BinaryFormat::NodeKind::Object, object->GetSymbol().Id, constructor, firstEntry, static_cast<uint32_t>(properties.Size()));
+}
+
+uint32_t BinaryWriter::WriteValue(const Value* value)
+{
+	switch (value->GetKind())
+	{
+	case ValueKind::Object:
+		return AddNode(BinaryFormat::NodeKind::ObjectValue, WriteObject(value->AsObject()->GetValue()));
+	case ValueKind::String:
+		return AddNode(BinaryFormat::NodeKind::String, AddStringValue(value->AsString()->GetValue()));
+	case ValueKind::Number:
+	{
+		float number = value->AsNumber()->GetValue();
+		uint32_t bits;
+		std::memcpy(&bits, &number, sizeof(bits));
+		return AddNode(BinaryFormat::NodeKind::Number, bits);
+	}
+	case ValueKind::Boolean:
+		return AddNode(BinaryFormat::NodeKind::Boolean, value->AsBoolean()->GetValue() ? 1 : 0);
+	case ValueKind::HexColor:
+	{
+		auto hexColor = value->AsHexColor();
+		return AddNode(BinaryFormat::NodeKind::HexColor, (hexColor->GetR() << 16) | (hexColor->GetG() << 8) | hexColor->GetB());
+	}
+	case ValueKind::List:
+	{
+		auto list = value->AsList();
+		uint32_t firstChild = static_cast<uint32_t>(m_Children.size());
+		uint32_t count = static_cast<uint32_t>(list->GetContainer().size());
+		m_Children.resize(m_Children.size() + count);
+
+		uint32_t child = firstChild;
+		for (const Value* item : *list)
+			m_Children[child++] = WriteValue(item);
+
+		return AddNode(BinaryFormat::NodeKind::List, firstChild, count);
+	}
+	case ValueKind::Dictionary:
+	{
+		const FlatMap<const Value*>& dictionary = value->AsDictionary()->GetContainer();
+		uint32_t firstEntry = static_cast<uint32_t>(m_Entries.size());
+		m_Entries.resize(m_Entries.size() + dictionary.Size());
+
+		uint32_t index = 0;
+		for (auto& pair : dictionary)
+		{
+			BinaryFormat::Entry entry;
+			entry.Key = dictionary.GetSymbol(index).Id;
+			entry.Value = WriteValue(pair.second);
+			m_Entries[firstEntry + index++] = entry;
+		}
+
+		return AddNode(BinaryFormat::NodeKind::Dictionary, firstEntry, static_cast<uint32_t>(dictionary.Size()));
+	}
+	}
+
+	return AddNode(BinaryFormat::NodeKind::Boolean, 0);
+}
+
+uint32_t BinaryWriter::AddNode(BinaryFormat::NodeKind kind, uint32_t a, uint32_t b, uint32_t c, uint32_t d)
+{
+	m_Nodes.push_back({ kind, a, b, c, d });
+	return static_cast<uint32_t>(m_Nodes.size() - 1);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+
+#include "BinaryFormat.h"
+
+namespace LayoutParser
+{
+	class LayoutCollection;
+	struct Object;
+	struct Value;
+
+	// Flattens a collection into the format described in BinaryFormat.h
+	class BinaryWriter
+	{
+	public:
+		BinaryWriter(const LayoutCollection& collection);
+
+		std::vector<char> Write();
+
+	private:
+		const LayoutCollection& m_Collection;
+
+		std::vector<BinaryFormat::StringRecord> m_Strings;
+		std::string m_StringData;
+		std::unordered_map<std::string_view, uint32_t> m_StringValues;
+
+		std::vector<BinaryFormat::LayoutRecord> m_Layouts;
+		std::vector<BinaryFormat::Node> m_Nodes;
+		std::vector<BinaryFormat::Entry> m_Entries;
+		std::vector<uint32_t> m_Children;
+
+		uint32_t AddString(std::string_view string);
+		uint32_t AddStringValue(std::string_view string);
+
+		uint32_t WriteObject(const Object* object);
+		uint32_t WriteValue(const Value* value);
+		uint32_t AddNode(BinaryFormat::NodeKind kind, uint32_t a = 0, uint32_t b = 0, uint32_t c = 0, uint32_t d = 0);
+	};
+}
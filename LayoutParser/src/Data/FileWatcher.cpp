@@ -0,0 +1,110 @@
+#include "Data/FileWatcher.h"
+
+#include <filesystem>
+
+#ifdef __linux__
+	#include <poll.h>
+	#include <unistd.h>
+	#include <sys/inotify.h>
+#endif
+
+using namespace LayoutParser;
+
+#ifdef __linux__
+
+FileWatcher::FileWatcher()
+	: m_Descriptor(inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+{
+}
+
+FileWatcher::~FileWatcher()
+{
+	if (m_Descriptor >= 0)
+		close(m_Descriptor);
+}
+
+void FileWatcher::Watch(const std::string& filePath)
+{
+	if (m_Descriptor < 0)
+		return;
+
+	std::filesystem::path path(filePath);
+	std::string directory = path.has_parent_path() ? path.parent_path().string() : std::string(".");
+
+	// Only finished writes and renames, a file that is still being written would parse half way
+	int watch = inotify_add_watch(m_Descriptor, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+	if (watch < 0)
+		return;
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	for (const WatchedFile& file : m_Files)
+	{
+		if (file.Path == filePath)
+			return;
+	}
+	m_Files.push_back({ watch, path.filename().string(), filePath });
+}
+
+void FileWatcher::ReadChanges(std::vector<std::string>& changedPaths, std::chrono::milliseconds timeout)
+{
+	if (m_Descriptor < 0)
+		return;
+
+	pollfd descriptor = { m_Descriptor, POLLIN, 0 };
+	if (poll(&descriptor, 1, static_cast<int>(timeout.count())) <= 0)
+		return;
+
+	alignas(inotify_event) char buffer[4096];
+	while (true)
+	{
+		ssize_t length = read(m_Descriptor, buffer, sizeof(buffer));
+		if (length <= 0)
+			return;
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		for (ssize_t offset = 0; offset < length;)
+		{
+			const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+			offset += sizeof(inotify_event) + event->len;
+
+			// Events got dropped, any of the files could have changed
+			if (event->mask & IN_Q_OVERFLOW)
+			{
+				for (const WatchedFile& file : m_Files)
+					changedPaths.push_back(file.Path);
+				continue;
+			}
+
+			if (event->len == 0)
+				continue;
+
+			for (const WatchedFile& file : m_Files)
+			{
+				if (file.Directory == event->wd && file.Name == event->name)
+					changedPaths.push_back(file.Path);
+			}
+		}
+	}
+}
+
+#else
+
+// No notifications, IsActive() tells the caller to poll
+FileWatcher::FileWatcher()
+	: m_Descriptor(-1)
+{
+}
+
+FileWatcher::~FileWatcher()
+{
+}
+
+void FileWatcher::Watch(const std::string& filePath)
+{
+}
+
+void FileWatcher::ReadChanges(std::vector<std::string>& changedPaths, std::chrono::milliseconds timeout)
+{
+}
+
+#endif
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <mutex>
+
+namespace LayoutParser
+{
+	// Change notifications for a set of files, through inotify on Linux. Anywhere else IsActive()
+	// is false and the caller has to poll. The directories are watched rather than the files
+	// themselves, editors like to save by writing a new file and renaming it over the old one.
+	// Watch and ReadChanges can be called from different threads.
+	class FileWatcher
+	{
+	public:
+		FileWatcher();
+		~FileWatcher();
+
+		FileWatcher(const FileWatcher& other) = delete;
+		FileWatcher& operator=(const FileWatcher& other) = delete;
+
+		inline bool IsActive() const { return m_Descriptor >= 0; }
+
+		// Watching the same path twice is fine
+		void Watch(const std::string& filePath);
+
+		// Waits up to timeout for something to happen (zero only checks) and appends every watched
+		// path that was written or replaced since the last call. A path can show up more than once.
+		void ReadChanges(std::vector<std::string>& changedPaths, std::chrono::milliseconds timeout);
+
+	private:
+		struct WatchedFile
+		{
+			int Directory;
+			std::string Name;
+			std::string Path;
+		};
+
+		int m_Descriptor;
+
+		std::mutex m_Mutex;
+		std::vector<WatchedFile> m_Files;
+	};
+}
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <functional>
+#include <stdexcept>
+#include <cstdint>
+#include <memory_resource>
+
+#include "Symbol.h"
+
+namespace LayoutParser
+{
+	// Name to value map that keeps entries in insertion order in one contiguous array.
+	// Objects rarely have more than a dozen properties so lookups just scan the keys, only
+	// once a map grows past IndexThreshold entries open addressing indexes are built next to it,
+	// one by name and one by symbol id. Every key is interned, the symbols sit in their own
+	// array so a symbol lookup in a small map is a tight scan over 32-bit integers.
+	template<typename TValue>
+	class FlatMap
+	{
+	public:
+		using Entry = std::pair<std::string_view, TValue>;
+		using const_iterator = typename std::pmr::vector<Entry>::const_iterator;
+
+		static constexpr size_t IndexThreshold = 16;
+
+		explicit FlatMap(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+			: m_Entries(resource), m_Symbols(resource), m_Index(resource), m_SymbolIndex(resource) {}
+
+		inline void Reserve(size_t capacity)
+		{
+			m_Entries.reserve(capacity);
+			m_Symbols.reserve(capacity);
+		}
+
+		// The key has to be the interned name of the symbol.
+		// A repeated key overwrites the value but keeps the position of the first one.
+		void Set(Symbol symbol, std::string_view key, TValue value)
+		{
+			size_t index = FindIndex(symbol);
+			if (index != NotFound)
+				m_Entries[index].second = std::move(value);
+			else
+				Append(symbol, key, std::move(value));
+		}
+
+		// Leaves an existing entry alone, returns false if the key was already there
+		bool Emplace(Symbol symbol, std::string_view key, TValue&& value)
+		{
+			if (FindIndex(symbol) != NotFound)
+				return false;
+
+			Append(symbol, key, std::move(value));
+			return true;
+		}
+
+		template<typename TKey>
+		inline const TValue* Find(TKey key) const
+		{
+			size_t index = FindIndex(key);
+			return (index != NotFound) ? &m_Entries[index].second : nullptr;
+		}
+
+		// Throws like std::unordered_map::at did
+		template<typename TKey>
+		inline const TValue& At(TKey key) const
+		{
+			size_t index = FindIndex(key);
+			if (index == NotFound)
+				throw std::out_of_range("FlatMap::At: key not found");
+
+			return m_Entries[index].second;
+		}
+
+		template<typename TKey>
+		inline bool Contains(TKey key) const { return FindIndex(key) != NotFound; }
+
+		inline Symbol GetSymbol(size_t index) const { return m_Symbols[index]; }
+		inline const Entry& GetEntry(size_t index) const { return m_Entries[index]; }
+
+		// Values can be changed or moved out in place, the keys can't
+		inline TValue& GetValue(size_t index) { return m_Entries[index].second; }
+
+		inline const Entry& Front() const { return m_Entries.front(); }
+		inline const Entry& Back() const { return m_Entries.back(); }
+
+		inline size_t Size() const { return m_Entries.size(); }
+		inline bool IsEmpty() const { return m_Entries.empty(); }
+
+		const_iterator begin() const { return m_Entries.begin(); }
+		const_iterator end() const { return m_Entries.end(); }
+
+	private:
+		static constexpr size_t NotFound = static_cast<size_t>(-1);
+
+		size_t FindIndex(Symbol symbol) const
+		{
+			if (m_SymbolIndex.empty())
+			{
+				for (size_t i = 0; i < m_Symbols.size(); i++)
+				{
+					if (m_Symbols[i] == symbol)
+						return i;
+				}
+				return NotFound;
+			}
+
+			size_t mask = m_SymbolIndex.size() - 1;
+			for (size_t slot = HashSymbol(symbol) & mask; m_SymbolIndex[slot] != 0; slot = (slot + 1) & mask)
+			{
+				size_t index = m_SymbolIndex[slot] - 1;
+				if (m_Symbols[index] == symbol)
+					return index;
+			}
+			return NotFound;
+		}
+
+		size_t FindIndex(std::string_view key) const
+		{
+			if (m_Index.empty())
+			{
+				for (size_t i = 0; i < m_Entries.size(); i++)
+				{
+					if (m_Entries[i].first == key)
+						return i;
+				}
+				return NotFound;
+			}
+
+			// Slots hold entry index + 1 so zero can mean empty
+			size_t mask = m_Index.size() - 1;
+			for (size_t slot = std::hash<std::string_view>()(key) & mask; m_Index[slot] != 0; slot = (slot + 1) & mask)
+			{
+				size_t index = m_Index[slot] - 1;
+				if (m_Entries[index].first == key)
+					return index;
+			}
+			return NotFound;
+		}
+
+		void Append(Symbol symbol, std::string_view key, TValue&& value)
+		{
+			m_Entries.emplace_back(key, std::move(value));
+			m_Symbols.push_back(symbol);
+
+			if (m_Entries.size() <= IndexThreshold)
+				return;
+
+			// Keep the index at most half full
+			if (m_Entries.size() * 2 > m_Index.size())
+				Rehash();
+			else
+				InsertIndex(m_Entries.size() - 1);
+		}
+
+		void Rehash()
+		{
+			size_t capacity = IndexThreshold * 4;
+			while (capacity < m_Entries.size() * 2)
+				capacity *= 2;
+
+			m_Index.assign(capacity, 0);
+			m_SymbolIndex.assign(capacity, 0);
+			for (size_t i = 0; i < m_Entries.size(); i++)
+				InsertIndex(i);
+		}
+
+		// Ids are dense so they'd all land next to each other, spread them out first
+		static inline size_t HashSymbol(Symbol symbol) { return static_cast<size_t>(symbol.Id * 2654435761u); }
+
+		void InsertIndex(size_t index)
+		{
+			size_t mask = m_Index.size() - 1;
+			size_t slot = std::hash<std::string_view>()(m_Entries[index].first) & mask;
+			while (m_Index[slot] != 0)
+				slot = (slot + 1) & mask;
+
+			m_Index[slot] = static_cast<uint32_t>(index + 1);
+
+			slot = HashSymbol(m_Symbols[index]) & mask;
+			while (m_SymbolIndex[slot] != 0)
+				slot = (slot + 1) & mask;
+
+			m_SymbolIndex[slot] = static_cast<uint32_t>(index + 1);
+		}
+
+		std::pmr::vector<Entry> m_Entries;
+		std::pmr::vector<Symbol> m_Symbols;
+		std::pmr::vector<uint32_t> m_Index;
+		std::pmr::vector<uint32_t> m_SymbolIndex;
+	};
+}
@@ -0,0 +1,726 @@
+#include "Data/JsonReader.h"
+
+#include <algorithm>
+#include <charconv>
+#include <limits>
+
+#include "Analysis/CharacterScanner.h"
+#include "Analysis/ParseOptions.h"
+#include "Analysis/SyntaxFacts.h"
+
+#include "Data/Arena.h"
+#include "Data/Object.h"
+#include "Data/Value.h"
+
+using namespace LayoutParser;
+
+namespace
+{
+	inline int32_t GetHexDigit(char character)
+	{
+		if (character >= '0' && character <= '9')
+			return character - '0';
+		if (character >= 'a' && character <= 'f')
+			return character - 'a' + 10;
+		if (character >= 'A' && character <= 'F')
+			return character - 'A' + 10;
+		return -1;
+	}
+
+	inline bool IsNumberCharacter(char character)
+	{
+		return (character >= '0' && character <= '9') || character == '-' || character == '+' || character == '.' || character == 'e' || character == 'E';
+	}
+
+	void AppendUtf8(std::string& text, uint32_t codePoint)
+	{
+		if (codePoint < 0x80)
+			text += static_cast<char>(codePoint);
+		else if (codePoint < 0x800)
+		{
+			text += static_cast<char>(0xC0 | (codePoint >> 6));
+			text += static_cast<char>(0x80 | (codePoint & 0x3F));
+		}
+		else if (codePoint < 0x10000)
+		{
+			text += static_cast<char>(0xE0 | (codePoint >> 12));
+			text += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+			text += static_cast<char>(0x80 | (codePoint & 0x3F));
+		}
+		else
+		{
+			text += static_cast<char>(0xF0 | (codePoint >> 18));
+			text += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+			text += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+			text += static_cast<char>(0x80 | (codePoint & 0x3F));
+		}
+	}
+}
+
+JsonReader::JsonReader(std::string_view text, Arena& arena, SymbolTable& symbols)
+	: m_Text(text), m_Position(0), m_Arena(arena), m_Symbols(symbols), m_Depth(0), m_Error(nullptr)
+{
+}
+
+FlatMap<Layout> JsonReader::Read(std::vector<std::pair<TextSpan, InternedSymbol>>& duplicates)
+{
+	FlatMap<Layout> layouts;
+
+	// Spans are 32 bit like everywhere else
+	if (m_Text.length() > static_cast<size_t>(INT32_MAX))
+	{
+		Fail("input is too large", 0, 0);
+		return layouts;
+	}
+
+	bool isFirst = true;
+	if (!BeginObject())
+		return layouts;
+
+	while (NextMember('}', isFirst))
+	{
+		std::string_view key;
+		if (!ReadString(key) || !Match(':'))
+			break;
+
+		if (key != "layouts")
+		{
+			SkipValue();
+			continue;
+		}
+
+		bool isFirstLayout = true;
+		if (!BeginArray())
+			break;
+
+		while (NextMember(']', isFirstLayout))
+		{
+			InternedSymbol name;
+			TextSpan nameSpan;
+			Layout layout = ReadLayout(name, nameSpan);
+			if (HasError())
+				break;
+
+			if (!layouts.Emplace(name.Id, name.Name, std::move(layout)))
+				duplicates.emplace_back(nameSpan, name);
+		}
+	}
+
+	SkipWhitespace();
+	if (!HasError() && m_Position != m_Text.length())
+		Fail("text after the end of the collection");
+
+	if (HasError())
+		return FlatMap<Layout>();
+
+	return layouts;
+}
+
+Layout JsonReader::ReadLayout(InternedSymbol& name, TextSpan& nameSpan)
+{
+	bool hasName = false;
+	size_t layoutStart = m_Position;
+
+	m_LayoutObjects.clear();
+
+	bool isFirst = true;
+	if (!BeginObject())
+		return Layout();
+
+	while (NextMember('}', isFirst))
+	{
+		std::string_view key;
+		if (!ReadString(key) || !Match(':'))
+			break;
+
+		if (key == "name")
+		{
+			SkipWhitespace();
+			size_t nameStart = m_Position;
+			name = ReadName();
+			nameSpan = TextSpan(static_cast<int32_t>(nameStart), static_cast<int32_t>(m_Position - nameStart));
+			hasName = true;
+		}
+		else if (key == "objects")
+		{
+			bool isFirstObject = true;
+			if (!BeginArray())
+				break;
+
+			while (NextMember(']', isFirstObject))
+			{
+				Object* object = ReadObject();
+				if (object != nullptr)
+					m_LayoutObjects.push_back(object);
+			}
+		}
+		else
+			SkipValue();
+	}
+
+	if (!HasError() && !hasName)
+		Fail("layout without a name", layoutStart, m_Position);
+	if (HasError())
+		return Layout();
+
+	// The JSON keeps no .lp source, so like a binary there are no spans to go with the objects
+	return Layout(m_Arena.CopyArray(m_LayoutObjects.data(), m_LayoutObjects.size()), nullptr, m_LayoutObjects.size());
+}
+
+Object* JsonReader::ReadObject()
+{
+	SkipWhitespace();
+	size_t objectStart = m_Position;
+
+	InternedSymbol type;
+	bool hasType = false;
+	Value* constructor = nullptr;
+	size_t stackStart = m_PropertyStack.size();
+
+	bool isFirst = true;
+	if (!EnterNesting() || !BeginObject())
+		return nullptr;
+
+	while (NextMember('}', isFirst))
+	{
+		std::string_view key;
+		if (!ReadString(key) || !Match(':'))
+			break;
+
+		if (key == "type")
+		{
+			type = ReadName();
+			hasType = true;
+		}
+		else if (key == "constructor")
+		{
+			SkipWhitespace();
+			if (Current() == 'n')
+				MatchKeyword("null");
+			else
+				constructor = ReadValue();
+		}
+		else if (key == "properties")
+			ReadProperties();
+		else
+			SkipValue();
+	}
+	ExitNesting();
+
+	if (!HasError() && !hasType)
+		Fail("object without a type", objectStart, m_Position);
+	if (HasError())
+	{
+		m_PropertyStack.resize(stackStart);
+		return nullptr;
+	}
+
+	FlatMap<Value*> properties = PopProperties<Value*>(stackStart);
+	return m_Arena.New<Object>(type.Id, type.Name, constructor, std::move(properties));
+}
+
+Value* JsonReader::ReadValue()
+{
+	SkipWhitespace();
+	switch (Current())
+	{
+	case '"':
+	{
+		// .lp strings have no escapes, so there is no way to write one with a quote in it
+		size_t stringStart = m_Position;
+		std::string_view string;
+		if (!ReadString(string))
+			return nullptr;
+		if (string.find('"') != std::string_view::npos)
+		{
+			Fail("a string can't contain '\"'", stringStart, m_Position);
+			return nullptr;
+		}
+		return m_Arena.New<StringValue>(m_Arena.CopyString(string));
+	}
+	case 't':
+		return MatchKeyword("true") ? m_Arena.New<BooleanValue>(true) : nullptr;
+	case 'f':
+		return MatchKeyword("false") ? m_Arena.New<BooleanValue>(false) : nullptr;
+	case '[':
+	{
+		if (!EnterNesting())
+			return nullptr;
+
+		size_t stackStart = m_ListStack.size();
+
+		bool isFirst = true;
+		BeginArray();
+		while (NextMember(']', isFirst))
+		{
+			Value* element = ReadValue();
+			if (element == nullptr)
+				break;
+			m_ListStack.push_back(element);
+		}
+		ExitNesting();
+
+		if (HasError())
+		{
+			m_ListStack.resize(stackStart);
+			return nullptr;
+		}
+
+		std::pmr::vector<const Value*> list(m_ListStack.begin() + stackStart, m_ListStack.end(), &m_Arena);
+		m_ListStack.resize(stackStart);
+		return m_Arena.New<ListValue>(std::move(list));
+	}
+	case '{':
+		return ReadTaggedValue();
+	case 'n':
+		Fail("null is not a value");
+		return nullptr;
+	default:
+	{
+		float number;
+		if (Current() != '-' && (Current() < '0' || Current() > '9'))
+		{
+			Fail("expected a value");
+			return nullptr;
+		}
+		return ReadNumber(number) ? m_Arena.New<NumberValue>(number) : nullptr;
+	}
+	}
+}
+
+Value* JsonReader::ReadTaggedValue()
+{
+	size_t valueStart = m_Position;
+	if (!EnterNesting() || !BeginObject())
+		return nullptr;
+
+	bool isFirst = true;
+	if (!NextMember('}', isFirst))
+	{
+		if (!HasError())
+			Fail("empty object where a value was expected", valueStart, m_Position);
+		return nullptr;
+	}
+
+	std::string_view tag;
+	if (!ReadString(tag) || !Match(':'))
+		return nullptr;
+
+	Value* value = nullptr;
+	if (tag == "object")
+	{
+		Object* object = ReadObject();
+		if (object != nullptr)
+			value = m_Arena.New<ObjectValue>(object);
+	}
+	else if (tag == "dictionary")
+	{
+		size_t stackStart = m_PropertyStack.size();
+		ReadProperties();
+		if (!HasError())
+			value = m_Arena.New<DictionaryValue>(PopProperties<const Value*>(stackStart));
+		else
+			m_PropertyStack.resize(stackStart);
+	}
+	else if (tag == "color")
+	{
+		SkipWhitespace();
+		size_t colorStart = m_Position;
+
+		std::string_view color;
+		if (ReadString(color))
+		{
+			bool isValid = color.length() == 7 && color[0] == '#';
+			for (size_t i = 1; isValid && i < color.length(); i++)
+				isValid = GetHexDigit(color[i]) >= 0;
+
+			if (isValid)
+				value = m_Arena.New<HexColorValue>(color);
+			else
+				Fail("a color has to be \"#RRGGBB\"", colorStart, m_Position);
+		}
+	}
+	else if (tag == "number")
+	{
+		SkipWhitespace();
+		size_t numberStart = m_Position;
+
+		std::string_view number;
+		if (ReadString(number))
+		{
+			if (number == "inf")
+				value = m_Arena.New<NumberValue>(std::numeric_limits<float>::infinity());
+			else if (number == "-inf")
+				value = m_Arena.New<NumberValue>(-std::numeric_limits<float>::infinity());
+			else if (number == "nan")
+				value = m_Arena.New<NumberValue>(std::numeric_limits<float>::quiet_NaN());
+			else
+				Fail("a number in quotes has to be \"inf\", \"-inf\" or \"nan\"", numberStart, m_Position);
+		}
+	}
+	else
+		Fail("unknown kind of value, expected \"object\", \"dictionary\", \"color\" or \"number\"");
+
+	if (!HasError() && NextMember('}', isFirst))
+		Fail("a value object has exactly one key");
+
+	ExitNesting();
+	return HasError() ? nullptr : value;
+}
+
+void JsonReader::ReadProperties()
+{
+	bool isFirst = true;
+	if (!BeginObject())
+		return;
+
+	while (NextMember('}', isFirst))
+	{
+		InternedSymbol key = ReadName();
+		if (HasError() || !Match(':'))
+			break;
+
+		Value* value = ReadValue();
+		if (value == nullptr)
+			break;
+
+		m_PropertyStack.emplace_back(key, value);
+	}
+}
+
+bool JsonReader::ReadString(std::string_view& string)
+{
+	SkipWhitespace();
+	size_t start = m_Position;
+	if (!Match('"'))
+		return false;
+
+	size_t closingQuote = CharacterScanner::FindCharacter(m_Text, m_Position, '"');
+	if (closingQuote >= m_Text.length())
+	{
+		Fail("missing closing quote", start, m_Text.length());
+		return false;
+	}
+
+	// Most strings have nothing escaped and are just a view into the text
+	std::string_view raw = m_Text.substr(m_Position, closingQuote - m_Position);
+	size_t backslash = raw.find('\\');
+	if (backslash == std::string_view::npos)
+	{
+		string = raw;
+		m_Position = closingQuote + 1;
+		return true;
+	}
+
+	m_Unescaped.assign(raw.substr(0, backslash));
+	m_Position += backslash;
+
+	while (true)
+	{
+		if (m_Position >= m_Text.length())
+		{
+			Fail("missing closing quote", start, m_Text.length());
+			return false;
+		}
+
+		char character = m_Text[m_Position++];
+		if (character == '"')
+			break;
+		if (character != '\\')
+		{
+			m_Unescaped += character;
+			continue;
+		}
+
+		size_t escapeStart = m_Position - 1;
+		char escape = Current();
+		m_Position++;
+		switch (escape)
+		{
+		case '"': m_Unescaped += '"'; break;
+		case '\\': m_Unescaped += '\\'; break;
+		case '/': m_Unescaped += '/'; break;
+		case 'b': m_Unescaped += '\b'; break;
+		case 'f': m_Unescaped += '\f'; break;
+		case 'n': m_Unescaped += '\n'; break;
+		case 'r': m_Unescaped += '\r'; break;
+		case 't': m_Unescaped += '\t'; break;
+		case 'u':
+		{
+			// Surrogate pairs come as two escapes in a row
+			uint32_t codePoint = 0;
+			for (int32_t unit = 0; unit < 2; unit++)
+			{
+				if (unit == 1 && (m_Text.substr(m_Position, 2) != "\\u"))
+				{
+					Fail("unpaired surrogate in a \\u escape", escapeStart, m_Position);
+					return false;
+				}
+				if (unit == 1)
+					m_Position += 2;
+
+				uint32_t codeUnit = 0;
+				for (int32_t digit = 0; digit < 4; digit++)
+				{
+					int32_t value = GetHexDigit(Current());
+					if (value < 0)
+					{
+						Fail("\\u needs four hex digits", escapeStart, m_Position);
+						return false;
+					}
+					codeUnit = codeUnit * 16 + static_cast<uint32_t>(value);
+					m_Position++;
+				}
+
+				if (unit == 0)
+				{
+					codePoint = codeUnit;
+					if (codeUnit >= 0xDC00 && codeUnit <= 0xDFFF)
+					{
+						Fail("unpaired surrogate in a \\u escape", escapeStart, m_Position);
+						return false;
+					}
+					if (codeUnit < 0xD800 || codeUnit > 0xDBFF)
+						break;
+				}
+				else
+				{
+					if (codeUnit < 0xDC00 || codeUnit > 0xDFFF)
+					{
+						Fail("unpaired surrogate in a \\u escape", escapeStart, m_Position);
+						return false;
+					}
+					codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (codeUnit - 0xDC00);
+				}
+			}
+
+			AppendUtf8(m_Unescaped, codePoint);
+			break;
+		}
+		default:
+			Fail("unknown escape", escapeStart, m_Position);
+			return false;
+		}
+	}
+
+	string = m_Unescaped;
+	return true;
+}
+
+InternedSymbol JsonReader::ReadName()
+{
+	SkipWhitespace();
+	size_t nameStart = m_Position;
+
+	std::string_view name;
+	if (!ReadString(name))
+		return InternedSymbol();
+
+	// Layout names, types and keys have to read back from .lp source as well
+	if (!SyntaxFacts::IsIdentifier(name))
+	{
+		Fail("a name has to be an identifier", nameStart, m_Position);
+		return InternedSymbol();
+	}
+	return m_Symbols.Intern(name);
+}
+
+bool JsonReader::ReadNumber(float& number)
+{
+	size_t start = m_Position;
+	while (IsNumberCharacter(Current()))
+		m_Position++;
+
+	const char* end = m_Text.data() + m_Position;
+	std::from_chars_result result = std::from_chars(m_Text.data() + start, end, number);
+	if (result.ec == std::errc::result_out_of_range)
+	{
+		Fail("number out of range for a float", start, m_Position);
+		return false;
+	}
+	if (result.ec != std::errc() || result.ptr != end)
+	{
+		Fail("invalid number", start, m_Position);
+		return false;
+	}
+	return true;
+}
+
+void JsonReader::SkipValue()
+{
+	SkipWhitespace();
+	switch (Current())
+	{
+	case '"':
+	{
+		std::string_view string;
+		ReadString(string);
+		break;
+	}
+	case '{':
+	case '[':
+	{
+		if (!EnterNesting())
+			return;
+
+		char close = (Current() == '{') ? '}' : ']';
+		m_Position++;
+
+		bool isFirst = true;
+		while (NextMember(close, isFirst))
+		{
+			if (close == '}')
+			{
+				std::string_view key;
+				if (!ReadString(key) || !Match(':'))
+					break;
+			}
+			SkipValue();
+		}
+		ExitNesting();
+		break;
+	}
+	case 't':
+		MatchKeyword("true");
+		break;
+	case 'f':
+		MatchKeyword("false");
+		break;
+	case 'n':
+		MatchKeyword("null");
+		break;
+	default:
+	{
+		float number;
+		if (Current() == '-' || (Current() >= '0' && Current() <= '9'))
+			ReadNumber(number);
+		else
+			Fail("expected a value");
+		break;
+	}
+	}
+}
+
+bool JsonReader::BeginObject()
+{
+	SkipWhitespace();
+	if (Current() != '{')
+	{
+		Fail("expected '{'");
+		return false;
+	}
+	m_Position++;
+	return true;
+}
+
+bool JsonReader::BeginArray()
+{
+	SkipWhitespace();
+	if (Current() != '[')
+	{
+		Fail("expected '['");
+		return false;
+	}
+	m_Position++;
+	return true;
+}
+
+bool JsonReader::NextMember(char close, bool& isFirst)
+{
+	if (HasError())
+		return false;
+
+	SkipWhitespace();
+	if (m_Position >= m_Text.length())
+	{
+		Fail(close == '}' ? "missing '}'" : "missing ']'");
+		return false;
+	}
+
+	if (Current() == close)
+	{
+		m_Position++;
+		return false;
+	}
+
+	if (!isFirst && !Match(','))
+		return false;
+
+	isFirst = false;
+	return true;
+}
+
+bool JsonReader::Match(char character)
+{
+	SkipWhitespace();
+	if (Current() != character || m_Position >= m_Text.length())
+	{
+		Fail(character == ':' ? "expected ':'" : character == ',' ? "expected ','" : "expected '\"'");
+		return false;
+	}
+	m_Position++;
+	return true;
+}
+
+bool JsonReader::MatchKeyword(std::string_view keyword)
+{
+	if (m_Text.substr(m_Position, keyword.length()) != keyword)
+	{
+		Fail("expected a value");
+		return false;
+	}
+	m_Position += keyword.length();
+	return true;
+}
+
+void JsonReader::SkipWhitespace()
+{
+	while (m_Position < m_Text.length())
+	{
+		char character = m_Text[m_Position];
+		if (character != ' ' && character != '\n' && character != '\r' && character != '\t')
+			return;
+		m_Position++;
+	}
+}
+
+bool JsonReader::EnterNesting()
+{
+	// A nested object takes two levels here, the {"object": ...} around it and the object itself
+	if (++m_Depth <= 2 * ParseOptions().MaxDepth)
+		return true;
+
+	Fail("nesting is too deep");
+	return false;
+}
+
+void JsonReader::Fail(const char* error)
+{
+	Fail(error, m_Position, std::min(m_Position + 1, m_Text.length()));
+}
+
+void JsonReader::Fail(const char* error, size_t start, size_t end)
+{
+	// Only the first problem is kept, everything after it follows from it
+	if (HasError())
+		return;
+
+	m_Error = error;
+	m_ErrorSpan = TextSpan(static_cast<int32_t>(start), static_cast<int32_t>(end - start));
+}
+
+template<typename TValue>
+FlatMap<TValue> JsonReader::PopProperties(size_t stackStart)
+{
+	FlatMap<TValue> properties(&m_Arena);
+	properties.Reserve(m_PropertyStack.size() - stackStart);
+
+	for (size_t i = stackStart; i < m_PropertyStack.size(); i++)
+	{
+		const InternedSymbol& symbol = m_PropertyStack[i].first;
+		properties.Set(symbol.Id, symbol.Name, m_PropertyStack[i].second);
+	}
+
+	m_PropertyStack.resize(stackStart);
+	return properties;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+#include "FlatMap.h"
+#include "LayoutCollection.h"
+#include "SymbolTable.h"
+#include "TextSpan.h"
+
+namespace LayoutParser
+{
+	class Arena;
+	struct Object;
+	struct Value;
+
+	// Builds the tree for JSON in the schema described in JsonWriter.h as it reads, there is no
+	// document in between. Strings without escapes are copied into the arena once, names are
+	// interned. Keys of layouts and objects can come in any order and unknown keys are skipped.
+	// The first problem stops the read, the error says what and where.
+	class JsonReader
+	{
+	public:
+		JsonReader(std::string_view text, Arena& arena, SymbolTable& symbols);
+
+		// Layout names that are already taken go to duplicates, the first definition is kept
+		FlatMap<Layout> Read(std::vector<std::pair<TextSpan, InternedSymbol>>& duplicates);
+
+		inline bool HasError() const { return m_Error != nullptr; }
+		inline const char* GetError() const { return m_Error; }
+		inline TextSpan GetErrorSpan() const { return m_ErrorSpan; }
+
+	private:
+		std::string_view m_Text;
+		size_t m_Position;
+
+		Arena& m_Arena;
+		SymbolCache m_Symbols;
+		int32_t m_Depth;
+
+		const char* m_Error;
+		TextSpan m_ErrorSpan;
+
+		// Scratch for strings with escapes in them
+		std::string m_Unescaped;
+
+		// Same as in the Parser, each map gets copied into the arena at its final size
+		std::vector<std::pair<InternedSymbol, Value*>> m_PropertyStack;
+		std::vector<Object*> m_LayoutObjects;
+		std::vector<const Value*> m_ListStack;
+
+		Layout ReadLayout(InternedSymbol& name, TextSpan& nameSpan);
+		Object* ReadObject();
+		Value* ReadValue();
+		Value* ReadTaggedValue();
+		void ReadProperties();
+
+		// The next value has to be a string, escapes are resolved. The view is only good until
+		// the next string is read.
+		bool ReadString(std::string_view& string);
+		InternedSymbol ReadName();
+		bool ReadNumber(float& number);
+		void SkipValue();
+
+		// Steps into an object or array and tells when the next member is there. Stops at the
+		// closing bracket and at errors.
+		bool BeginObject();
+		bool BeginArray();
+		bool NextMember(char close, bool& isFirst);
+
+		bool Match(char character);
+		bool MatchKeyword(std::string_view keyword);
+		void SkipWhitespace();
+		inline char Current() const { return m_Position < m_Text.length() ? m_Text[m_Position] : '\0'; }
+
+		bool EnterNesting();
+		inline void ExitNesting() { m_Depth--; }
+
+		void Fail(const char* error);
+		void Fail(const char* error, size_t start, size_t end);
+
+		template<typename TValue>
+		FlatMap<TValue> PopProperties(size_t stackStart);
+	};
+}
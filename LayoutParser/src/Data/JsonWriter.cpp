@@ -0,0 +1,198 @@
+#include "Data/JsonWriter.h"
+
+#include <cmath>
+
+#include "Data/LayoutCollection.h"
+#include "Data/Object.h"
+#include "Data/Value.h"
+
+using namespace LayoutParser;
+
+namespace
+{
+	constexpr char HexDigits[] = "0123456789ABCDEF";
+}
+
+JsonWriter::JsonWriter(OutputBuffer& output)
+	: m_Output(output)
+{
+}
+
+void JsonWriter::Write(const LayoutCollection& collection)
+{
+	m_Output.Write("{\"layouts\":[");
+
+	bool isFirst = true;
+	for (auto& pair : collection)
+	{
+		if (!isFirst)
+			m_Output.Write(',');
+		isFirst = false;
+
+		WriteLayout(pair.first, pair.second);
+	}
+
+	m_Output.Write("]}\n");
+}
+
+void JsonWriter::WriteLayout(std::string_view name, const Layout& layout)
+{
+	m_Output.Write("{\"name\":");
+	WriteString(name);
+	m_Output.Write(",\"objects\":[");
+
+	bool isFirst = true;
+	for (const Object* object : layout)
+	{
+		if (!isFirst)
+			m_Output.Write(',');
+		isFirst = false;
+
+		WriteObject(object);
+	}
+
+	m_Output.Write("]}");
+}
+
+void JsonWriter::WriteObject(const Object* object)
+{
+	m_Output.Write("{\"type\":");
+	WriteString(object->GetIdentifier());
+
+	if (object->GetConstructor() != nullptr)
+	{
+		m_Output.Write(",\"constructor\":");
+		WriteValue(object->GetConstructor());
+	}
+
+	m_Output.Write(",\"properties\":{");
+
+	bool isFirst = true;
+	for (auto& pair : *object)
+	{
+		if (!isFirst)
+			m_Output.Write(',');
+		isFirst = false;
+
+		WriteString(pair.first);
+		m_Output.Write(':');
+		WriteValue(pair.second);
+	}
+
+	m_Output.Write("}}");
+}
+
+void JsonWriter::WriteValue(const Value* value)
+{
+	switch (value->GetKind())
+	{
+	case ValueKind::Object:
+		m_Output.Write("{\"object\":");
+		WriteObject(value->AsObject()->GetValue());
+		m_Output.Write('}');
+		break;
+	case ValueKind::String:
+		WriteString(value->AsString()->GetValue());
+		break;
+	case ValueKind::Number:
+		WriteNumber(value->AsNumber()->GetValue());
+		break;
+	case ValueKind::Boolean:
+		m_Output.Write(value->AsBoolean()->GetValue() ? "true" : "false");
+		break;
+	case ValueKind::HexColor:
+	{
+		const HexColorValue* hexColor = value->AsHexColor();
+		const uint8_t channels[] = { hexColor->GetR(), hexColor->GetG(), hexColor->GetB() };
+
+		m_Output.Write("{\"color\":\"#");
+		for (uint8_t channel : channels)
+		{
+			m_Output.Write(HexDigits[channel >> 4]);
+			m_Output.Write(HexDigits[channel & 0xF]);
+		}
+		m_Output.Write("\"}");
+		break;
+	}
+	case ValueKind::List:
+	{
+		m_Output.Write('[');
+
+		bool isFirst = true;
+		for (const Value* element : *value->AsList())
+		{
+			if (!isFirst)
+				m_Output.Write(',');
+			isFirst = false;
+
+			WriteValue(element);
+		}
+
+		m_Output.Write(']');
+		break;
+	}
+	case ValueKind::Dictionary:
+	{
+		m_Output.Write("{\"dictionary\":{");
+
+		bool isFirst = true;
+		for (auto& pair : *value->AsDictionary())
+		{
+			if (!isFirst)
+				m_Output.Write(',');
+			isFirst = false;
+
+			WriteString(pair.first);
+			m_Output.Write(':');
+			WriteValue(pair.second);
+		}
+
+		m_Output.Write("}}");
+		break;
+	}
+	}
+}
+
+void JsonWriter::WriteNumber(float number)
+{
+	if (std::isnan(number))
+		m_Output.Write("{\"number\":\"nan\"}");
+	else if (std::isinf(number))
+		m_Output.Write(number > 0.0f ? "{\"number\":\"inf\"}" : "{\"number\":\"-inf\"}");
+	else
+		m_Output.WriteNumber(number);
+}
+
+void JsonWriter::WriteString(std::string_view string)
+{
+	m_Output.Write('"');
+
+	// Runs without anything to escape are copied in one go
+	size_t runStart = 0;
+	for (size_t i = 0; i < string.length(); i++)
+	{
+		unsigned char character = static_cast<unsigned char>(string[i]);
+		if (character >= 0x20 && character != '"' && character != '\\')
+			continue;
+
+		m_Output.Write(string.substr(runStart, i - runStart));
+		runStart = i + 1;
+
+		switch (character)
+		{
+		case '"': m_Output.Write("\\\""); break;
+		case '\\': m_Output.Write("\\\\"); break;
+		case '\n': m_Output.Write("\\n"); break;
+		case '\r': m_Output.Write("\\r"); break;
+		case '\t': m_Output.Write("\\t"); break;
+		default:
+			m_Output.Write("\\u00");
+			m_Output.Write(HexDigits[character >> 4]);
+			m_Output.Write(HexDigits[character & 0xF]);
+			break;
+		}
+	}
+
+	m_Output.Write(string.substr(runStart));
+	m_Output.Write('"');
+}
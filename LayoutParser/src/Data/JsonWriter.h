@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string_view>
+
+#include "OutputBuffer.h"
+
+namespace LayoutParser
+{
+	class LayoutCollection;
+	struct Layout;
+	struct Object;
+	struct Value;
+
+	// Writes a collection as JSON in one pass, straight into the buffer. The schema:
+	//
+	//   collection  { "layouts": [ layout, ... ] }
+	//   layout      { "name": "Main", "objects": [ object, ... ] }
+	//   object      { "type": "Frame", "constructor": value, "properties": { "ID": value, ... } }
+	//               "constructor" is left out when the object has none
+	//
+	//   value       "text"                          string
+	//               0.5                             number, shortest text that reads back as the same float
+	//               true / false                    boolean
+	//               [ value, ... ]                  list
+	//               { "object": object }            object
+	//               { "dictionary": { "Key": value, ... } }
+	//               { "color": "#RRGGBB" }          hex color
+	//               { "number": "inf" }             infinity, "-inf" and "nan", which JSON has no numbers for
+	//
+	// Layouts, properties and dictionary entries keep their order. The output is compact, one
+	// line for the whole collection. Names are .lp identifiers and strings never hold a '"',
+	// JSON that breaks either is rejected on the way back in.
+	class JsonWriter
+	{
+	public:
+		explicit JsonWriter(OutputBuffer& output);
+
+		void Write(const LayoutCollection& collection);
+
+	private:
+		OutputBuffer& m_Output;
+
+		void WriteLayout(std::string_view name, const Layout& layout);
+		void WriteObject(const Object* object);
+		void WriteValue(const Value* value);
+		void WriteNumber(float number);
+
+		// Quotes and escapes, anything at or above 0x80 is passed through as UTF-8
+		void WriteString(std::string_view string);
+	};
+}
@@ -0,0 +1,218 @@
+#include "Data/LayoutCache.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <system_error>
+
+#include "Data/BinaryFormat.h"
+
+using namespace LayoutParser;
+
+LayoutCache::LayoutCache(std::pmr::memory_resource* resource)
+	: m_Resource(resource), m_Generation(0), m_StopWatching(false)
+{
+}
+
+LayoutCache::~LayoutCache()
+{
+	StopWatching();
+}
+
+std::shared_ptr<const LayoutCollection> LayoutCache::Load(const std::string& filePath)
+{
+	if (std::shared_ptr<const LayoutCollection> collection = Get(filePath))
+		return collection;
+
+	std::lock_guard<std::mutex> refreshLock(m_RefreshMutex);
+
+	// Somebody else could have loaded it while this waited for the lock
+	if (std::shared_ptr<const LayoutCollection> collection = Get(filePath))
+		return collection;
+
+	std::shared_ptr<Entry> entry = std::make_shared<Entry>();
+	entry->Path = filePath;
+
+	// Watch before reading so a write that lands during the load isn't missed
+	m_Watcher.Watch(filePath);
+
+	// A file that can't be read loads empty like it would through LoadFromFile, and
+	// gets loaded for real once it shows up
+	if (!Reload(*entry, false))
+	{
+		std::atomic_store(&entry->Collection, std::make_shared<const LayoutCollection>(LayoutCollection::LoadFromString("", m_Resource)));
+		m_Generation.fetch_add(1, std::memory_order_release);
+	}
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Entries.emplace(filePath, entry);
+	return std::atomic_load(&entry->Collection);
+}
+
+void LayoutCache::Unload(const std::string& filePath)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Entries.erase(filePath);
+}
+
+std::shared_ptr<const LayoutCollection> LayoutCache::Get(const std::string& filePath) const
+{
+	std::shared_ptr<Entry> entry;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		auto found = m_Entries.find(filePath);
+		if (found == m_Entries.end())
+			return nullptr;
+		entry = found->second;
+	}
+	return std::atomic_load(&entry->Collection);
+}
+
+size_t LayoutCache::Refresh()
+{
+	if (!m_Watcher.IsActive())
+		return RefreshAll();
+
+	std::vector<std::string> changedPaths;
+	m_Watcher.ReadChanges(changedPaths, std::chrono::milliseconds(0));
+	return RefreshChanged(changedPaths);
+}
+
+void LayoutCache::StartWatching(std::chrono::milliseconds pollInterval)
+{
+	if (m_WatchThread.joinable())
+		return;
+
+	m_StopWatching = false;
+	m_WatchThread = std::thread(&LayoutCache::Watch, this, pollInterval);
+}
+
+void LayoutCache::StopWatching()
+{
+	if (!m_WatchThread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_WatchMutex);
+		m_StopWatching = true;
+	}
+	m_WatchCondition.notify_all();
+	m_WatchThread.join();
+}
+
+void LayoutCache::Watch(std::chrono::milliseconds pollInterval)
+{
+	while (true)
+	{
+		// inotify can't be woken by StopWatching, so it waits at most one interval at a time
+		std::vector<std::string> changedPaths;
+		if (m_Watcher.IsActive())
+			m_Watcher.ReadChanges(changedPaths, pollInterval);
+
+		{
+			std::unique_lock<std::mutex> lock(m_WatchMutex);
+			if (!m_Watcher.IsActive())
+				m_WatchCondition.wait_for(lock, pollInterval, [&]() { return m_StopWatching; });
+
+			if (m_StopWatching)
+				return;
+		}
+
+		if (m_Watcher.IsActive())
+			RefreshChanged(changedPaths);
+		else
+			RefreshAll();
+	}
+}
+
+size_t LayoutCache::RefreshAll()
+{
+	std::lock_guard<std::mutex> refreshLock(m_RefreshMutex);
+
+	std::vector<std::shared_ptr<Entry>> entries;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		entries.reserve(m_Entries.size());
+		for (auto& pair : m_Entries)
+			entries.push_back(pair.second);
+	}
+
+	size_t reloadCount = 0;
+	for (const std::shared_ptr<Entry>& entry : entries)
+	{
+		if (Reload(*entry, true))
+			reloadCount++;
+	}
+	return reloadCount;
+}
+
+size_t LayoutCache::RefreshChanged(const std::vector<std::string>& changedPaths)
+{
+	if (changedPaths.empty())
+		return 0;
+
+	std::lock_guard<std::mutex> refreshLock(m_RefreshMutex);
+
+	// Paths that were unloaded in the meantime just drop out here
+	std::vector<std::shared_ptr<Entry>> entries;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		for (const std::string& path : changedPaths)
+		{
+			auto found = m_Entries.find(path);
+			if (found != m_Entries.end() && std::find(entries.begin(), entries.end(), found->second) == entries.end())
+				entries.push_back(found->second);
+		}
+	}
+
+	size_t reloadCount = 0;
+	for (const std::shared_ptr<Entry>& entry : entries)
+	{
+		if (Reload(*entry, false))
+			reloadCount++;
+	}
+	return reloadCount;
+}
+
+bool LayoutCache::Reload(Entry& entry, bool checkModifiedTime)
+{
+	bool isLoaded = std::atomic_load(&entry.Collection) != nullptr;
+
+	std::error_code error;
+	std::filesystem::file_time_type modifiedTime = std::filesystem::last_write_time(entry.Path, error);
+	if (error)
+		return false;
+
+	uintmax_t size = std::filesystem::file_size(entry.Path, error);
+	if (error)
+		return false;
+
+	if (checkModifiedTime && isLoaded && modifiedTime == entry.ModifiedTime && size == entry.Size)
+		return false;
+
+	// Read into a buffer of our own rather than mapped like LoadFromFile does. These are the
+	// files being edited, an in place save that truncates a mapping while it's hashed or parsed
+	// would crash, and the hash and the parse could see different bytes.
+	std::ifstream inputFile(entry.Path, std::ios::in | std::ios::binary);
+	if (!inputFile)
+		return false;
+
+	std::stringstream fileTextStream;
+	fileTextStream << inputFile.rdbuf();
+	std::string text = fileTextStream.str();
+
+	entry.ModifiedTime = modifiedTime;
+	entry.Size = size;
+
+	uint64_t contentHash = BinaryFormat::ComputeChecksum(text.data(), text.length());
+	if (isLoaded && contentHash == entry.ContentHash)
+		return false;
+
+	// Built completely before anyone can see it
+	std::shared_ptr<const LayoutCollection> collection = std::make_shared<const LayoutCollection>(LayoutCollection::LoadFromString(text, m_Resource));
+	entry.ContentHash = contentHash;
+
+	std::atomic_store(&entry.Collection, std::move(collection));
+	m_Generation.fetch_add(1, std::memory_order_release);
+	return true;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <memory_resource>
+
+#include "LayoutCollection.h"
+#include "FileWatcher.h"
+
+namespace LayoutParser
+{
+	// Keeps the collections of a set of files up to date while the files change on disk.
+	// A changed file is parsed into a new collection on the side, and the new collection replaces
+	// the old one with a single atomic store. Readers of Get never wait for a reload and never see
+	// a tree that is still being built. Anyone still holding the old collection keeps it alive
+	// until they let go.
+	//
+	// Files are only parsed again when their content hash changes. A touch or a save without
+	// changes costs a read and a hash. A reload that fails to read the file keeps the old
+	// collection, a file with errors is swapped in like LoadFromFile would return it.
+	class LayoutCache
+	{
+	public:
+		// With StartWatching the resource is used from the watching thread, so it has to be thread safe
+		LayoutCache(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+		~LayoutCache();
+
+		LayoutCache(const LayoutCache& other) = delete;
+		LayoutCache& operator=(const LayoutCache& other) = delete;
+
+		// Loads the file and tracks it from now on. Paths are compared as given, without
+		// resolving them, and loading a path that is already tracked just returns its collection.
+		std::shared_ptr<const LayoutCollection> Load(const std::string& filePath);
+		void Unload(const std::string& filePath);
+
+		// The current collection of a tracked file, nullptr if the path isn't tracked
+		std::shared_ptr<const LayoutCollection> Get(const std::string& filePath) const;
+
+		// Reloads the tracked files whose content changed and returns how many were swapped. With
+		// inotify only files that had events are read, otherwise the modification time and size
+		// of every file are checked first.
+		size_t Refresh();
+
+		// Runs Refresh on a background thread, woken by inotify or every pollInterval without it
+		void StartWatching(std::chrono::milliseconds pollInterval = std::chrono::milliseconds(250));
+		void StopWatching();
+
+		// Goes up by one for every collection loaded or swapped in, so readers can cheaply tell
+		// whether anything was reloaded
+		inline uint64_t GetGeneration() const { return m_Generation.load(std::memory_order_acquire); }
+
+	private:
+		struct Entry
+		{
+			std::string Path;
+
+			// Only touched while holding m_RefreshMutex
+			std::filesystem::file_time_type ModifiedTime;
+			uintmax_t Size = 0;
+			uint64_t ContentHash = 0;
+
+			// Only read and written through std::atomic_load and std::atomic_store
+			std::shared_ptr<const LayoutCollection> Collection;
+		};
+
+		std::pmr::memory_resource* m_Resource;
+
+		// Guards the table only, it is never held while a file is read or parsed
+		mutable std::mutex m_Mutex;
+		std::unordered_map<std::string, std::shared_ptr<Entry>> m_Entries;
+
+		// One reload at a time
+		std::mutex m_RefreshMutex;
+
+		FileWatcher m_Watcher;
+		std::atomic<uint64_t> m_Generation;
+
+		std::thread m_WatchThread;
+		std::mutex m_WatchMutex;
+		std::condition_variable m_WatchCondition;
+		bool m_StopWatching;
+
+		size_t RefreshAll();
+		size_t RefreshChanged(const std::vector<std::string>& changedPaths);
+
+		// Returns true if a new collection was swapped in
+		bool Reload(Entry& entry, bool checkModifiedTime);
+
+		void Watch(std::chrono::milliseconds pollInterval);
+	};
+}
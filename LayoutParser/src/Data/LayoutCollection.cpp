@@ -2,210 +2,864 @@
 
 #include <fstream>
 #include <sstream>
+#include <algorithm>
+#include <chrono>
+#include <unordered_set>
 
+#include "Analysis/Lexer.h"
 #include "Analysis/Parser.h"
-
+#include "Analysis/LayoutBoundaries.h"
+#include "Analysis/LineIndex.h"
+#include "Analysis/ParseStats.h"
+
+#include "Data/Arena.h"
+#include "Data/BinaryImage.h"
+#include "Data/BinaryReader.h"
+#include "Data/BinaryWriter.h"
+#include "Data/JsonReader.h"
+#include "Data/JsonWriter.h"
+#include "Data/LayoutWriter.h"
+#include "Data/LazyLayouts.h"
+#include "Data/MappedFile.h"
+#include "Data/OutputBuffer.h"
+#include "Data/SymbolTable.h"
+#include "Data/TreePrinter.h"
 #include "Data/Object.h"
 #include "Data/Value.h"
 
-using namespace LayoutParser;
+#include "Threading/WorkStealingPool.h"
 
-LayoutCollection::~LayoutCollection()
-{
-	for (auto& pair : m_Layouts)
-		for (auto& object : pair.second)
-			delete object;
-}
+using namespace LayoutParser;
 
-LayoutCollection LayoutCollection::LoadFromString(const std::string& text)
+namespace
 {
-	Parser parser(text);
-	return LayoutCollection(std::move(parser.Parse()), std::move(parser.GetDiagnostics()));
-}
+	struct ParsedFile
+	{
+		std::shared_ptr<Arena> FileArena;
+		FlatMap<Layout> Layouts;
+		DiagnosticCollection Diagnostics;
 
-LayoutCollection LayoutParser::LayoutCollection::LoadFromFile(const std::string& filePath)
-{
-	std::ifstream inputFile(filePath, std::ios::in);
-	std::stringstream fileTextStream;
+		// False if parsing stopped before the end of the text
+		bool IsComplete = false;
 
-	fileTextStream << inputFile.rdbuf();
-	inputFile.close();
+		size_t SourceLength = 0;
 
-	return LoadFromString(fileTextStream.str());
-}
+		// Only with ParseOptions::BuildIndex
+		std::shared_ptr<const ObjectIndex> Index;
 
-// Pretty print source code
+#ifdef LAYOUTPARSER_ENABLE_STATS
+		ParseStats Stats;
 
-#ifndef LAYOUTPARSER_EXCLUDE_PRETTYPRINT
+		// The rest of the load counts as building the collection
+		std::chrono::steady_clock::time_point ParseEnd;
+#endif
+	};
 
-#include <iostream>
-#include <io.h> 
-#include <fcntl.h>
+#ifdef LAYOUTPARSER_ENABLE_STATS
+	double MillisecondsSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
 
-std::wstring PrettyString(const Value* value)
-{
-	switch (value->GetKind())
+	std::shared_ptr<const ParseStats> FinishStats(ParsedFile& file, const Arena& arena)
 	{
-	case ValueKind::Object:
-		return L"ObjectValue";
-	case ValueKind::String:
+		file.Stats.Allocations = arena.GetAllocationCount();
+		file.Stats.BytesAllocated = arena.GetBytesUsed();
+		file.Stats.BytesReserved = arena.GetBytesReserved();
+		file.Stats.BuildMilliseconds = MillisecondsSince(file.ParseEnd);
+		return std::make_shared<const ParseStats>(file.Stats);
+	}
+#endif
+
+	ParsedFile ParseText(std::string_view text, SymbolTable& symbols, std::pmr::memory_resource* resource, int32_t startPosition = 0,
+		const ParseOptions& options = ParseOptions())
 	{
-		auto& str = value->AsString()->GetValue();
-		std::wstringstream returnString;
-		returnString << L"StringValue(" << std::wstring(str.begin(), str.end()) << L")";
-		return returnString.str();
+		ParsedFile file;
+		file.FileArena = std::make_shared<Arena>(resource);
+
+		Parser parser(text, *file.FileArena, symbols, startPosition, options);
+		LAYOUTPARSER_STATS(auto parseStart = std::chrono::steady_clock::now());
+		file.Layouts = parser.Parse();
+		file.Diagnostics = std::move(parser.GetDiagnostics());
+		if (options.BuildIndex)
+			file.Index = std::make_shared<const ObjectIndex>(std::move(parser.GetIndex()));
+
+#ifdef LAYOUTPARSER_ENABLE_STATS
+		file.ParseEnd = std::chrono::steady_clock::now();
+		file.Stats = parser.GetStats();
+		file.Stats.BytesRead = text.length();
+		file.Stats.Layouts = file.Layouts.Size();
+		file.Stats.ParseMilliseconds = std::chrono::duration<double, std::milli>(file.ParseEnd - parseStart).count() - file.Stats.LexMilliseconds;
+#endif
+
+		// Only text with problems pays for the line index
+		if (!file.Diagnostics.IsEmpty())
+			file.Diagnostics.ResolveLocations(LineIndex(text));
+		file.IsComplete = parser.IsAtEnd();
+		file.SourceLength = text.length();
+		return file;
 	}
-	case ValueKind::Number:
+
+	// Every distinct identifier from startPosition on, in the order they first show up
+	void CollectNames(std::string_view text, int32_t startPosition, std::vector<std::string_view>& names)
 	{
-		std::wstringstream returnString;
-		returnString << L"NumberValue(" << value->AsNumber()->GetValue() << L")";
-		return returnString.str();
+		DiagnosticCollection diagnostics;
+		Lexer lexer(text, diagnostics, startPosition);
+
+		std::unordered_set<std::string_view> seen;
+		for (SyntaxToken token = lexer.Lex(); token.Kind != SyntaxKind::EndOfFileToken; token = lexer.Lex())
+		{
+			if (token.Kind == SyntaxKind::IdentifierToken && seen.insert(token.GetText(text)).second)
+				names.push_back(token.GetText(text));
+		}
 	}
-	case ValueKind::Boolean:
+
+	// Chunks smaller than this cost more in setup than they save
+	constexpr size_t MinimumChunkSize = 64 * 1024;
+
+	// Splits the text at top-level layout boundaries and parses the pieces on the pool. Only
+	// succeeds if every piece parses cleanly to its end, anything else (errors, stray tokens
+	// between layouts, unbalanced braces) is left for a sequential parse so the diagnostics and
+	// the point where parsing stops come out exactly the same.
+	bool ParseTextInChunks(std::string_view text, SymbolTable& symbols, std::pmr::memory_resource* resource,
+		WorkStealingPool& pool, std::vector<ParsedFile>& chunks)
 	{
-		std::wstringstream returnString;
-		returnString << L"BooleanValue(" << (value->AsBoolean()->GetValue() ? L"True" : L"Falue") << L")";
-		return returnString.str();
+		std::vector<size_t> layoutEnds;
+		if (!LayoutBoundaries::FindLayoutEnds(text, layoutEnds) || layoutEnds.size() < 2)
+			return false;
+
+		// A few chunks per thread leaves room for stealing when layouts differ in size
+		size_t targetSize = std::max(MinimumChunkSize, text.length() / (pool.GetThreadCount() * 4));
+
+		std::vector<size_t> chunkEnds;
+		size_t chunkStart = 0;
+		for (size_t end : layoutEnds)
+		{
+			if (end - chunkStart >= targetSize)
+			{
+				chunkEnds.push_back(end);
+				chunkStart = end;
+			}
+		}
+
+		// The last chunk takes whatever trails the last layout
+		if (chunkEnds.empty() || chunkEnds.back() != layoutEnds.back())
+			chunkEnds.push_back(text.length());
+		else
+			chunkEnds.back() = text.length();
+
+		if (chunkEnds.size() < 2)
+			return false;
+
+		// The parser interns every identifier it meets, so interning them in source order up front
+		// gives every name the id a sequential parse would, however the threads get scheduled.
+		// Each chunk lexes its own names and they are interned chunk by chunk afterwards.
+		std::vector<std::vector<std::string_view>> chunkNames(chunkEnds.size());
+		pool.ParallelFor(chunkNames.size(), [&](size_t i)
+		{
+			size_t begin = (i == 0) ? 0 : chunkEnds[i - 1];
+			CollectNames(text.substr(0, chunkEnds[i]), static_cast<int32_t>(begin), chunkNames[i]);
+		});
+
+		for (const auto& names : chunkNames)
+		{
+			for (std::string_view name : names)
+				symbols.Intern(name);
+		}
+
+		chunks.resize(chunkEnds.size());
+		pool.ParallelFor(chunks.size(), [&](size_t i)
+		{
+			size_t begin = (i == 0) ? 0 : chunkEnds[i - 1];
+			chunks[i] = ParseText(text.substr(0, chunkEnds[i]), symbols, resource, static_cast<int32_t>(begin));
+		});
+
+		for (const ParsedFile& chunk : chunks)
+		{
+			if (!chunk.IsComplete || !chunk.Diagnostics.IsEmpty())
+				return false;
+		}
+		return true;
 	}
-	case ValueKind::HexColor:
+
+	ParsedFile ParseFile(const std::string& filePath, SymbolTable& symbols, std::pmr::memory_resource* resource,
+		const ParseOptions& options = ParseOptions())
 	{
-		auto hexColor = value->AsHexColor();
-		std::wstringstream returnString;
-		returnString << L"HexColorValue(" <<
-			static_cast<int32_t>(hexColor->GetR()) << L", " <<
-			static_cast<int32_t>(hexColor->GetG()) << L", " <<
-			static_cast<int32_t>(hexColor->GetB()) << L")";
-		return returnString.str();
+		// Lex straight out of the mapping. Everything the collection keeps is copied into
+		// its arena so the file can be unmapped as soon as parsing is done.
+		// A mapped file is only paged in as it's lexed, so most of its reading counts as lexing
+		LAYOUTPARSER_STATS(auto readStart = std::chrono::steady_clock::now());
+		{
+			MappedFile file(filePath);
+			if (file.IsMapped())
+			{
+				LAYOUTPARSER_STATS(double readTime = MillisecondsSince(readStart));
+				ParsedFile parsed = ParseText(file.GetText(), symbols, resource, 0, options);
+				LAYOUTPARSER_STATS(parsed.Stats.ReadMilliseconds = readTime);
+				return parsed;
+			}
+		}
+
+		// Pipes, devices and anything else that can't be mapped get read through a stream
+		std::ifstream inputFile(filePath, std::ios::in);
+		std::stringstream fileTextStream;
+
+		fileTextStream << inputFile.rdbuf();
+		inputFile.close();
+
+		LAYOUTPARSER_STATS(double readTime = MillisecondsSince(readStart));
+		ParsedFile parsed = ParseText(fileTextStream.str(), symbols, resource, 0, options);
+		LAYOUTPARSER_STATS(parsed.Stats.ReadMilliseconds = readTime);
+		return parsed;
 	}
-	case ValueKind::List:
-		return L"ListValue";
-	case ValueKind::Dictionary:
-		return L"DictionaryValue";
-	default:
-		return L"BadValue";
-		break;
+
+	// Same as CollectNames, but the names are copied since the file is closed again right away
+	std::vector<std::string> ReadNames(const std::string& filePath)
+	{
+		MappedFile file(filePath);
+		std::string fileText;
+		std::string_view text = file.GetText();
+		if (!file.IsMapped())
+		{
+			std::ifstream inputFile(filePath, std::ios::in);
+			std::stringstream fileTextStream;
+			fileTextStream << inputFile.rdbuf();
+			fileText = fileTextStream.str();
+			text = fileText;
+		}
+
+		std::vector<std::string_view> names;
+		CollectNames(text, 0, names);
+		return std::vector<std::string>(names.begin(), names.end());
 	}
-}
 
-void LayoutCollection::PrettyPrint(const Value* value, const std::wstring& propertyName, std::wstring indent, bool isLast)
-{
-	const wchar_t* marker = isLast ? L"\u2514\u2500\u2500" : L"\u251C\u2500\u2500";
+	// An edit in the coordinates of the old text
+	struct EditRange
+	{
+		int32_t Start;
+		int32_t End; // of the removed text
+		int32_t Delta; // added to every position after it
+	};
 
-	if (!propertyName.empty())
-		std::wcout << indent << marker << propertyName << L": ";
-	else
-		std::wcout << indent << marker;
+	// Arenas for reparsed text start small, most edits only touch a single object
+	constexpr size_t ReparseBlockSize = 4 * 1024;
 
-	indent.append(isLast ? L"   " : L"\u2502  ");
+	// Index of the first layout that isn't entirely before the edit
+	size_t FindFirstAffectedLayout(const FlatMap<Layout>& layouts, const EditRange& edit)
+	{
+		auto first = std::partition_point(layouts.begin(), layouts.end(),
+			[&](const FlatMap<Layout>::Entry& entry) { return entry.second.GetSpan().GetEnd() <= edit.Start; });
+		return static_cast<size_t>(first - layouts.begin());
+	}
 
-	std::wstring formattedValue = PrettyString(value);
-	switch (value->GetKind())
+	// The parser starts right after a token that the edit didn't touch, so it lexes exactly what
+	// a full parse would from there on. Once the next token starts where an unchanged object or
+	// layout moved to, everything after it is known to come out the same and is reused.
+
+	// Reparses the objects around an edit that stays inside one layout body
+	bool ReparseLayoutObjects(std::string_view text, const FlatMap<Layout>& previous, const EditRange& edit,
+		Arena& arena, SymbolTable& symbols, FlatMap<Layout>& layouts)
 	{
-	case ValueKind::Object:
-		std::wcout << formattedValue << L'\n';
-		PrettyPrint(value->AsObject()->GetValue(), indent, true);
-		return;
-	case ValueKind::String:
-		std::wcout << formattedValue << L'\n';
-		return;
-	case ValueKind::Number:
-		std::wcout << formattedValue << L'\n';
-		return;
-	case ValueKind::Boolean:
-		std::wcout << formattedValue << L'\n';
-		return;
-	case ValueKind::HexColor:
-		std::wcout << formattedValue << L'\n';
-		return;
-	case ValueKind::List:
+		size_t layoutIndex = FindFirstAffectedLayout(previous, edit);
+		if (layoutIndex == previous.Size())
+			return false;
+
+		const Layout& layout = previous.GetEntry(layoutIndex).second;
+		TextSpan layoutSpan = layout.GetSpan();
+		int32_t nameEnd = layoutSpan.Start + static_cast<int32_t>(previous.GetEntry(layoutIndex).first.length());
+		int32_t closingBracket = layoutSpan.GetEnd() - 1;
+
+		// Touching the end of the name could change the name
+		if (edit.Start <= nameEnd || edit.End > closingBracket)
+			return false;
+
+		size_t objectCount = layout.Size();
+		size_t firstObject = 0;
+		while (firstObject < objectCount && layout.GetObjectSpan(firstObject).GetEnd() <= edit.Start)
+			firstObject++;
+
+		size_t resume = firstObject;
+		while (resume < objectCount && layout.GetObjectSpan(resume).Start < edit.End)
+			resume++;
+
+		int32_t regionStart = (firstObject == 0) ? nameEnd : layout.GetObjectSpan(firstObject - 1).GetEnd();
+		Parser parser(text, arena, symbols, regionStart);
+
+		if (firstObject == 0)
+		{
+			if (parser.PeekToken().Kind != SyntaxKind::OpenSquigglyBracketToken)
+				return false;
+			parser.SkipToken();
+		}
+
+		// Spans relative to the layout, which starts where it did before
+		std::vector<Object*> objects;
+		std::vector<TextSpan> objectSpans;
+		objects.reserve(objectCount + 1);
+		objectSpans.reserve(objectCount + 1);
+
+		for (size_t i = 0; i < firstObject; i++)
+		{
+			objects.push_back(layout.begin()[i]);
+			objectSpans.push_back(TextSpan(layout.GetObjectSpan(i).Start - layoutSpan.Start, layout.GetObjectSpan(i).Length));
+		}
+
+		while (true)
+		{
+			SyntaxToken token = parser.PeekToken();
+			while (resume < objectCount && layout.GetObjectSpan(resume).Start + edit.Delta < token.Position)
+				resume++;
+
+			if (resume < objectCount && layout.GetObjectSpan(resume).Start + edit.Delta == token.Position)
+				break;
+
+			if (token.Kind == SyntaxKind::CloseSquigglyBracketToken && token.Position == closingBracket + edit.Delta)
+			{
+				resume = objectCount;
+				break;
+			}
+
+			if (token.Kind != SyntaxKind::OpenAngleBracketToken)
+				return false;
+
+			TextSpan span;
+			objects.push_back(parser.ParseLayoutObject(layoutSpan.Start, span));
+			objectSpans.push_back(span);
+		}
+
+		if (!parser.GetDiagnostics().IsEmpty())
+			return false;
+
+		for (size_t i = resume; i < objectCount; i++)
+		{
+			objects.push_back(layout.begin()[i]);
+			objectSpans.push_back(TextSpan(layout.GetObjectSpan(i).Start - layoutSpan.Start + edit.Delta, layout.GetObjectSpan(i).Length));
+		}
+
+		layouts.Reserve(previous.Size());
+		for (size_t i = 0; i < previous.Size(); i++)
+		{
+			const FlatMap<Layout>::Entry& entry = previous.GetEntry(i);
+			if (i < layoutIndex)
+				layouts.Emplace(previous.GetSymbol(i), entry.first, Layout(entry.second));
+			else if (i > layoutIndex)
+				layouts.Emplace(previous.GetSymbol(i), entry.first, Layout(entry.second, entry.second.GetSpan().Start + edit.Delta));
+			else
+			{
+				layouts.Emplace(previous.GetSymbol(i), entry.first, Layout(
+					arena.CopyArray(objects.data(), objects.size()),
+					arena.CopyArray(objectSpans.data(), objectSpans.size()),
+					objects.size(),
+					TextSpan(layoutSpan.Start, layoutSpan.Length + edit.Delta)));
+			}
+		}
+		return true;
+	}
+
+	// Reparses whole top-level layouts, for edits that cross a layout boundary or its name
+	bool ReparseLayouts(std::string_view text, const FlatMap<Layout>& previous, const EditRange& edit,
+		Arena& arena, SymbolTable& symbols, FlatMap<Layout>& layouts, DiagnosticCollection& diagnostics)
 	{
-		std::wcout << formattedValue << L'\n';
-		auto list = value->AsList();
-		if (!list->IsEmpty())
+		size_t firstLayout = FindFirstAffectedLayout(previous, edit);
+
+		size_t resume = firstLayout;
+		while (resume < previous.Size() && previous.GetEntry(resume).second.GetSpan().Start < edit.End)
+			resume++;
+
+		int32_t regionStart = (firstLayout == 0) ? 0 : previous.GetEntry(firstLayout - 1).second.GetSpan().GetEnd();
+		Parser parser(text, arena, symbols, regionStart);
+
+		layouts.Reserve(previous.Size());
+		for (size_t i = 0; i < firstLayout; i++)
+			layouts.Emplace(previous.GetSymbol(i), previous.GetEntry(i).first, Layout(previous.GetEntry(i).second));
+
+		while (true)
 		{
-			auto last = list->LastValue();
+			SyntaxToken token = parser.PeekToken();
+			while (resume < previous.Size() && previous.GetEntry(resume).second.GetSpan().Start + edit.Delta < token.Position)
+				resume++;
+
+			if (resume < previous.Size() && previous.GetEntry(resume).second.GetSpan().Start + edit.Delta == token.Position)
+				break;
+
+			if (token.Kind == SyntaxKind::EndOfFileToken)
+			{
+				resume = previous.Size();
+				break;
+			}
+
+			// Whatever a full parse would make of this, it isn't a layout
+			if (token.Kind != SyntaxKind::IdentifierToken)
+				return false;
+
+			InternedSymbol name;
+			Layout layout = parser.ParseLayout(name);
+			TextSpan nameSpan(layout.GetSpan().Start, static_cast<int32_t>(name.Name.length()));
+			if (!layouts.Emplace(name.Id, name.Name, std::move(layout)))
+				diagnostics.ReportDuplicateLayout(nameSpan, name.Name);
+		}
+
+		if (!parser.GetDiagnostics().IsEmpty())
+			return false;
 
-			for (auto& value : *list)
-				PrettyPrint(value, L"", indent, value == last);
+		// A new layout can take the name of one further down
+		for (size_t i = resume; i < previous.Size(); i++)
+		{
+			const FlatMap<Layout>::Entry& entry = previous.GetEntry(i);
+			int32_t start = entry.second.GetSpan().Start + edit.Delta;
+			if (!layouts.Emplace(previous.GetSymbol(i), entry.first, Layout(entry.second, start)))
+				diagnostics.ReportDuplicateLayout(TextSpan(start, static_cast<int32_t>(entry.first.length())), entry.first);
 		}
-		return;
+		return true;
 	}
-	case ValueKind::Dictionary:
+
+	// Finds every top-level layout and its name without parsing a single body. Anything that doesn't
+	// split into name-and-braces pieces with nothing but trivia around them is left for a full parse.
+	bool SplitLayouts(std::string_view text, std::vector<TextSpan>& spans, std::vector<TextSpan>& names)
 	{
-		std::wcout << formattedValue << L'\n';
-		auto dictionary = value->AsDictionary();
-		if (!dictionary->IsEmpty())
+		std::vector<size_t> layoutEnds;
+		// Text over the size limit goes to the full parse, which reports it
+		if (text.length() > ParseOptions().MaxInputSize || !LayoutBoundaries::FindLayoutEnds(text, layoutEnds))
+			return false;
+
+		DiagnosticCollection diagnostics;
+		int32_t start = 0;
+		for (size_t layoutEnd : layoutEnds)
 		{
-			auto last = dictionary->LastValue();
+			int32_t end = static_cast<int32_t>(layoutEnd);
+			// The brace right after the name has to be the one that opens the slice, "L3*{" or
+			// "L({ ... }" are broken layouts the parser has to report
+			Lexer lexer(text.substr(0, end), diagnostics, start);
+			SyntaxToken name = lexer.Lex();
+			if (name.Kind != SyntaxKind::IdentifierToken || lexer.Lex().Kind != SyntaxKind::OpenSquigglyBracketToken)
+				return false;
+
+			spans.push_back(TextSpan(name.Position, end - name.Position));
+			names.push_back(TextSpan(name.Position, name.Length));
+			start = end;
+		}
+
+		SyntaxToken trailing = Lexer(text, diagnostics, start).Lex();
+		return trailing.Kind == SyntaxKind::EndOfFileToken && diagnostics.IsEmpty();
+	}
+
+	// Duplicates are reported here since a lazy load never runs Parser::Parse
+	DiagnosticCollection InternLayoutNames(std::string_view text, const std::vector<TextSpan>& names, SymbolTable& symbols,
+		std::vector<InternedSymbol>& layoutNames)
+	{
+		layoutNames.reserve(names.size());
+		for (const TextSpan& name : names)
+		{
+			Symbol symbol = symbols.Intern(text.substr(name.Start, name.Length));
+			layoutNames.push_back({ symbol, symbols.GetName(symbol) });
+		}
+
+		DiagnosticCollection diagnostics;
+		std::vector<bool> isDefined(symbols.Size(), false);
+		for (size_t i = 0; i < layoutNames.size(); i++)
+		{
+			if (isDefined[layoutNames[i].Id.Id])
+				diagnostics.ReportDuplicateLayout(names[i], layoutNames[i].Name);
+			isDefined[layoutNames[i].Id.Id] = true;
+		}
+
+		if (!diagnostics.IsEmpty())
+			diagnostics.ResolveLocations(LineIndex(text));
+		return diagnostics;
+	}
+
+	// The first layout with a name wins, same as a full parse
+	FlatMap<Layout> IndexLazyLayouts(LazyLayouts& lazy, const std::vector<TextSpan>& spans, const std::vector<InternedSymbol>& layoutNames)
+	{
+		FlatMap<Layout> layouts;
+		layouts.Reserve(spans.size());
+		for (size_t i = 0; i < spans.size(); i++)
+			layouts.Emplace(layoutNames[i].Id, layoutNames[i].Name, Layout(&lazy.GetLayout(i), spans[i]));
+		return layouts;
+	}
+}
 
-			for (auto& pair : *dictionary)
-				PrettyPrint(pair.second, std::wstring(pair.first.begin(), pair.first.end()), indent, pair.second == last);
+LayoutCollection LayoutCollection::LoadFromString(std::string_view text, std::pmr::memory_resource* resource)
+{
+	return LoadFromString(text, ParseOptions(), resource);
+}
+
+LayoutCollection LayoutCollection::LoadFromString(std::string_view text, const ParseOptions& options, std::pmr::memory_resource* resource)
+{
+	std::shared_ptr<SymbolTable> symbols = std::make_shared<SymbolTable>(resource);
+	ParsedFile file = ParseText(text, *symbols, resource, 0, options);
+	LAYOUTPARSER_STATS(const Arena& arena = *file.FileArena);
+
+	LayoutCollection collection({ std::move(file.FileArena) }, std::move(symbols), std::move(file.Layouts), std::move(file.Diagnostics), file.SourceLength);
+	collection.m_Index = std::move(file.Index);
+	LAYOUTPARSER_STATS(collection.m_Stats = FinishStats(file, arena));
+	return collection;
+}
+
+LayoutCollection LayoutCollection::LoadFromFile(const std::string& filePath, std::pmr::memory_resource* resource)
+{
+	return LoadFromFile(filePath, ParseOptions(), resource);
+}
+
+LayoutCollection LayoutCollection::LoadFromFile(const std::string& filePath, const ParseOptions& options, std::pmr::memory_resource* resource)
+{
+	std::shared_ptr<SymbolTable> symbols = std::make_shared<SymbolTable>(resource);
+	ParsedFile file = ParseFile(filePath, *symbols, resource, options);
+	LAYOUTPARSER_STATS(const Arena& arena = *file.FileArena);
+
+	LayoutCollection collection({ std::move(file.FileArena) }, std::move(symbols), std::move(file.Layouts), std::move(file.Diagnostics), file.SourceLength);
+	collection.m_Index = std::move(file.Index);
+	LAYOUTPARSER_STATS(collection.m_Stats = FinishStats(file, arena));
+	return collection;
+}
+
+LayoutCollection LayoutCollection::LoadFromStringLazy(std::string_view text, std::pmr::memory_resource* resource)
+{
+	return LoadLazy(std::string(text), resource);
+}
+
+LayoutCollection LayoutCollection::LoadFromFileLazy(const std::string& filePath, std::pmr::memory_resource* resource)
+{
+	// Layouts get parsed long after this returns, a mapping would let anything that edits the
+	// file in place change the text behind their spans or truncate it out from under them
+	std::ifstream inputFile(filePath, std::ios::in | std::ios::binary);
+	std::stringstream fileTextStream;
+
+	fileTextStream << inputFile.rdbuf();
+	inputFile.close();
+
+	return LoadLazy(fileTextStream.str(), resource);
+}
+
+LayoutCollection LayoutCollection::LoadLazy(std::string&& text, std::pmr::memory_resource* resource)
+{
+	std::vector<TextSpan> spans;
+	std::vector<TextSpan> names;
+	if (!SplitLayouts(text, spans, names))
+		return LoadFromString(text, resource);
+
+	std::shared_ptr<SymbolTable> symbols = std::make_shared<SymbolTable>(resource);
+	std::vector<InternedSymbol> layoutNames;
+	DiagnosticCollection diagnostics = InternLayoutNames(text, names, *symbols, layoutNames);
+
+	std::shared_ptr<LazyLayouts> lazy = std::make_shared<LazyLayouts>(std::move(text), spans, symbols, DiagnosticCollection(diagnostics), resource);
+	LayoutCollection collection({}, std::move(symbols), IndexLazyLayouts(*lazy, spans, layoutNames), std::move(diagnostics));
+	collection.m_Lazy = std::move(lazy);
+	return collection;
+}
+
+LayoutCollection LayoutCollection::LoadFromFiles(const std::vector<std::string>& filePaths, size_t threadCount, std::pmr::memory_resource* resource)
+{
+	std::shared_ptr<SymbolTable> symbols = std::make_shared<SymbolTable>(resource);
+
+	std::vector<ParsedFile> files(filePaths.size());
+	WorkStealingPool pool(threadCount);
+
+	// Names are interned in path order first so the symbol ids, and with them the compiled output,
+	// don't depend on how the threads get scheduled. Costs a second lex of every file.
+	std::vector<std::vector<std::string>> fileNames(filePaths.size());
+	pool.ParallelFor(fileNames.size(), [&](size_t i)
+	{
+		fileNames[i] = ReadNames(filePaths[i]);
+	});
+
+	for (const auto& names : fileNames)
+	{
+		for (const std::string& name : names)
+			symbols->Intern(name);
+	}
+	fileNames.clear();
+
+	// Each file gets its own arena, only the symbol table is shared
+	pool.ParallelFor(files.size(), [&](size_t i)
+	{
+		files[i] = ParseFile(filePaths[i], *symbols, resource);
+	});
+
+	// Merge in the order the paths were given so the result doesn't depend on scheduling
+	constexpr size_t NotDefined = static_cast<size_t>(-1);
+	std::vector<size_t> definedIn(symbols->Size(), NotDefined);
+
+	std::vector<std::shared_ptr<Arena>> arenas;
+	arenas.reserve(files.size());
+	FlatMap<Layout> layouts;
+	DiagnosticCollection diagnostics;
+
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		ParsedFile& file = files[i];
+		for (size_t j = 0; j < file.Layouts.Size(); j++)
+		{
+			Symbol name = file.Layouts.GetSymbol(j);
+			std::string_view nameText = file.Layouts.GetEntry(j).first;
+
+			if (definedIn[name.Id] != NotDefined)
+			{
+				TextSpan nameSpan(file.Layouts.GetValue(j).GetSpan().Start, static_cast<int32_t>(nameText.length()));
+				file.Diagnostics.ReportDuplicateLayout(nameSpan, nameText, filePaths[definedIn[name.Id]]);
+				continue;
+			}
+
+			definedIn[name.Id] = i;
+			layouts.Emplace(name, nameText, std::move(file.Layouts.GetValue(j)));
 		}
+
+		diagnostics.Append(file.Diagnostics, filePaths[i]);
+		arenas.push_back(std::move(file.FileArena));
 	}
-	default:
-		break;
+
+	return LayoutCollection(std::move(arenas), std::move(symbols), std::move(layouts), std::move(diagnostics));
+}
+
+LayoutCollection LayoutCollection::LoadFromStringParallel(std::string_view text, size_t threadCount, std::pmr::memory_resource* resource)
+{
+	WorkStealingPool pool(threadCount);
+	if (pool.GetThreadCount() > 1)
+	{
+		std::shared_ptr<SymbolTable> symbols = std::make_shared<SymbolTable>(resource);
+		std::vector<ParsedFile> chunks;
+		if (ParseTextInChunks(text, *symbols, resource, pool, chunks))
+		{
+			// Stitch the chunks back together in source order
+			std::vector<std::shared_ptr<Arena>> arenas;
+			arenas.reserve(chunks.size());
+			FlatMap<Layout> layouts;
+			DiagnosticCollection diagnostics;
+
+			for (ParsedFile& chunk : chunks)
+			{
+				for (size_t i = 0; i < chunk.Layouts.Size(); i++)
+				{
+					std::string_view name = chunk.Layouts.GetEntry(i).first;
+					TextSpan nameSpan(chunk.Layouts.GetValue(i).GetSpan().Start, static_cast<int32_t>(name.length()));
+					if (!layouts.Emplace(chunk.Layouts.GetSymbol(i), name, std::move(chunk.Layouts.GetValue(i))))
+						diagnostics.ReportDuplicateLayout(nameSpan, name);
+				}
+				arenas.push_back(std::move(chunk.FileArena));
+			}
+
+			if (!diagnostics.IsEmpty())
+				diagnostics.ResolveLocations(LineIndex(text));
+
+			return LayoutCollection(std::move(arenas), std::move(symbols), std::move(layouts), std::move(diagnostics), text.length());
+		}
 	}
+
+	return LoadFromString(text, resource);
 }
 
-void LayoutCollection::PrettyPrint(const Object* object, std::wstring indent, bool isLast)
+LayoutCollection LayoutCollection::Reparse(std::string_view text, const TextEdit& edit) const
 {
-	const wchar_t* marker = isLast ? L"\u2514\u2500\u2500" : L"\u251C\u2500\u2500";
+	std::pmr::memory_resource* resource = m_Arenas.empty() ? std::pmr::get_default_resource() : m_Arenas.front()->GetUpstream();
+
+	// Errors can make a full parse stop anywhere, and replaced layouts keep their arena alive
+	// until the next full parse, so those get one
+	bool canReparse = m_SourceLength != NoSource && m_Diagnostics.IsEmpty() && m_ReparsedBytes <= m_SourceLength &&
+		edit.Start <= m_SourceLength && edit.RemovedLength <= m_SourceLength - edit.Start &&
+		text.length() == m_SourceLength - edit.RemovedLength + edit.InsertedLength &&
+		text.length() < static_cast<size_t>(INT32_MAX) && m_SourceLength < static_cast<size_t>(INT32_MAX);
+	if (!canReparse)
+		return LoadFromString(text, resource);
+
+	EditRange range;
+	range.Start = static_cast<int32_t>(edit.Start);
+	range.End = static_cast<int32_t>(edit.Start + edit.RemovedLength);
+	range.Delta = static_cast<int32_t>(edit.InsertedLength) - static_cast<int32_t>(edit.RemovedLength);
+
+	std::shared_ptr<Arena> arena = std::make_shared<Arena>(resource, ReparseBlockSize);
+	FlatMap<Layout> layouts;
+	DiagnosticCollection diagnostics;
+
+	if (!ReparseLayoutObjects(text, m_Layouts, range, *arena, *m_Symbols, layouts))
+	{
+		// Start over with a clean arena, nothing parsed above is reachable
+		arena = std::make_shared<Arena>(resource, ReparseBlockSize);
+		if (!ReparseLayouts(text, m_Layouts, range, *arena, *m_Symbols, layouts, diagnostics))
+			return LoadFromString(text, resource);
+	}
 
-	std::wcout << indent << marker;
+	std::vector<std::shared_ptr<Arena>> arenas;
+	arenas.reserve(m_Arenas.size() + 1);
+	arenas.insert(arenas.end(), m_Arenas.begin(), m_Arenas.end());
+	arenas.push_back(std::move(arena));
 
-	auto& identifier = object->GetIdentifier();
-	if (object->GetConstructor() == nullptr)
-		std::wcout << std::wstring(identifier.begin(), identifier.end()) << L'\n';
-	else
-		std::wcout << std::wstring(identifier.begin(), identifier.end()) << L'(' << PrettyString(object->GetConstructor()) << L")\n";
+	if (!diagnostics.IsEmpty())
+		diagnostics.ResolveLocations(LineIndex(text));
 
-	indent.append(isLast ? L"   " : L"\u2502  ");
+	size_t reparsedBytes = m_ReparsedBytes + arenas.back()->GetBytesReserved();
+	return LayoutCollection(std::move(arenas), m_Symbols, std::move(layouts), std::move(diagnostics), text.length(), reparsedBytes);
+}
 
-	if (!object->IsEmpty())
+DiagnosticCollection& LayoutCollection::GetDiagnostics()
+{
+	if (m_Lazy)
+		m_Lazy->UpdateDiagnostics(m_Diagnostics);
+	return m_Diagnostics;
+}
+
+std::string LayoutCollection::SaveToString() const
+{
+	std::string text;
 	{
-		auto last = object->LastProperty();
+		OutputBuffer output(text);
+		LayoutWriter(output).Write(*this);
+	}
+	return text;
+}
 
-		for (auto& pair : *object)
-			PrettyPrint(pair.second, std::wstring(pair.first.begin(), pair.first.end()), indent, pair.second == last);
+bool LayoutCollection::SaveToFile(const std::string& filePath) const
+{
+	std::ofstream outputFile(filePath, std::ios::out | std::ios::binary | std::ios::trunc);
+	{
+		OutputBuffer output(outputFile);
+		LayoutWriter(output).Write(*this);
 	}
+	outputFile.close();
+
+	return !outputFile.fail();
+}
+
+bool LayoutCollection::SaveBinary(const std::string& filePath) const
+{
+	std::vector<char> image = BinaryWriter(*this).Write();
+
+	std::ofstream outputFile(filePath, std::ios::out | std::ios::binary | std::ios::trunc);
+	outputFile.write(image.data(), static_cast<std::streamsize>(image.size()));
+	outputFile.close();
+
+	return !outputFile.fail();
 }
 
-void LayoutCollection::PrettyPrint(const Layout* layout, const std::wstring& layoutName, std::wstring indent, bool isLast)
+LayoutCollection LayoutCollection::LoadBinary(const std::string& filePath, std::pmr::memory_resource* resource)
 {
-	const wchar_t* marker = isLast ? L"\u2514\u2500\u2500" : L"\u251C\u2500\u2500";
+	// The image is read straight out of the mapping, only the pages the reader touches get loaded
+	{
+		MappedFile file(filePath);
+		if (file.IsMapped())
+			return LoadFromBinary(file.GetText(), resource);
+	}
+
+	std::ifstream inputFile(filePath, std::ios::in | std::ios::binary);
+	std::stringstream fileStream;
+
+	fileStream << inputFile.rdbuf();
+	inputFile.close();
 
-	std::wcout << indent << marker << layoutName << L'\n';
+	return LoadFromBinary(fileStream.str(), resource);
+}
 
-	indent.append(isLast ? L"   " : L"\u2502  ");
+LayoutCollection LayoutCollection::LoadFromBinary(std::string_view data, std::pmr::memory_resource* resource)
+{
+	std::shared_ptr<Arena> arena = std::make_shared<Arena>(resource);
+	std::shared_ptr<SymbolTable> symbols = std::make_shared<SymbolTable>(resource);
+	DiagnosticCollection diagnostics;
 
-	if (!layout->IsEmpty())
+	BinaryImage image(data);
+	if (!image.IsValid())
 	{
-		auto last = layout->LastObject();
+		diagnostics.ReportInvalidBinaryFile(image.GetError());
+		return LayoutCollection({ std::move(arena) }, std::move(symbols), FlatMap<Layout>(), std::move(diagnostics));
+	}
 
-		for (auto& object : *layout)
-			PrettyPrint(object, indent, object == last);
+	BinaryReader reader(image, *arena, *symbols);
+	FlatMap<Layout> layouts = reader.Read();
+	if (reader.HasError())
+	{
+		diagnostics.ReportInvalidBinaryFile(reader.GetError());
+
+		// Nothing from the failed read is reachable anymore, start over with clean tables
+		arena = std::make_shared<Arena>(resource);
+		symbols = std::make_shared<SymbolTable>(resource);
 	}
+
+	return LayoutCollection({ std::move(arena) }, std::move(symbols), std::move(layouts), std::move(diagnostics));
 }
 
-void LayoutCollection::PrettyPrint(const LayoutCollection& collection, std::wstring indent, bool isLast)
+std::string LayoutCollection::SaveToJson() const
 {
-	int32_t previousMode = _setmode(_fileno(stdout), _O_U8TEXT);
+	std::string json;
+	{
+		OutputBuffer output(json);
+		JsonWriter(output).Write(*this);
+	}
+	return json;
+}
 
-	const wchar_t* marker = isLast ? L"\u2514\u2500\u2500" : L"\u251C\u2500\u2500";
+bool LayoutCollection::SaveJson(const std::string& filePath) const
+{
+	std::ofstream outputFile(filePath, std::ios::out | std::ios::binary | std::ios::trunc);
+	{
+		OutputBuffer output(outputFile);
+		JsonWriter(output).Write(*this);
+	}
+	outputFile.close();
 
-	std::wcout << indent << marker << L"Collection" << L'\n';
+	return !outputFile.fail();
+}
 
-	indent.append(isLast ? L"   " : L"\u2502  ");
+LayoutCollection LayoutCollection::LoadJson(const std::string& filePath, std::pmr::memory_resource* resource)
+{
+	{
+		MappedFile file(filePath);
+		if (file.IsMapped())
+			return LoadFromJson(file.GetText(), resource);
+	}
+
+	std::ifstream inputFile(filePath, std::ios::in | std::ios::binary);
+	std::stringstream fileStream;
+
+	fileStream << inputFile.rdbuf();
+	inputFile.close();
+
+	return LoadFromJson(fileStream.str(), resource);
+}
+
+LayoutCollection LayoutCollection::LoadFromJson(std::string_view json, std::pmr::memory_resource* resource)
+{
+	std::shared_ptr<Arena> arena = std::make_shared<Arena>(resource);
+	std::shared_ptr<SymbolTable> symbols = std::make_shared<SymbolTable>(resource);
+	DiagnosticCollection diagnostics;
 
-	if (!collection.IsEmpty())
+	std::vector<std::pair<TextSpan, InternedSymbol>> duplicates;
+	FlatMap<Layout> layouts;
 	{
-		auto last = &collection.LastLayout();
+		JsonReader reader(json, *arena, *symbols);
+		layouts = reader.Read(duplicates);
+		if (reader.HasError())
+		{
+			diagnostics.ReportInvalidJson(reader.GetErrorSpan(), reader.GetError());
 
-		for (auto& pair : collection.m_Layouts)
-			PrettyPrint(&pair.second, std::wstring(pair.first.begin(), pair.first.end()), indent, &pair.second == last);
+			arena = std::make_shared<Arena>(resource);
+			symbols = std::make_shared<SymbolTable>(resource);
+		}
+		else
+		{
+			for (auto& duplicate : duplicates)
+				diagnostics.ReportDuplicateLayout(duplicate.first, duplicate.second.Name);
+		}
 	}
 
-	(void)_setmode(_fileno(stdout), previousMode);
+	if (!diagnostics.IsEmpty())
+		diagnostics.ResolveLocations(LineIndex(json));
+
+	return LayoutCollection({ std::move(arena) }, std::move(symbols), std::move(layouts), std::move(diagnostics));
+}
+
+// Pretty print source code
+
+#ifndef LAYOUTPARSER_EXCLUDE_PRETTYPRINT
+
+#include <iostream>
+
+void LayoutCollection::PrettyPrint(const LayoutCollection& collection)
+{
+	PrettyPrint(collection, std::cout);
+}
+
+void LayoutCollection::PrettyPrint(const LayoutCollection& collection, std::ostream& stream)
+{
+	OutputBuffer output(stream);
+	TreePrinter(output).Print(collection);
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -1,80 +1,253 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
-#include <unordered_map>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+#include <ostream>
 
 #include "../Analysis/Diagnostics.h"
+#include "../Analysis/ParseOptions.h"
+#include "../Analysis/ParseStats.h"
+#include "Arena.h"
+#include "FlatMap.h"
+#include "ObjectIndex.h"
+#include "SymbolTable.h"
+#include "TextSpan.h"
 
 namespace LayoutParser
 {
 	struct Object;
 	struct Value;
 
+	struct LazyLayout;
+	class LazyLayouts;
+
+	// A view over arrays in the arena of the owning collection, so copying a layout never
+	// touches its objects. Spans are positions in the text the layout was parsed from, layouts
+	// loaded from a binary file have empty ones.
+	// Layouts of a lazily loaded collection only know their span until something asks for their
+	// objects, the first of those calls parses the layout.
 	struct Layout
 	{
 	public:
-		Layout(std::vector<Object*>&& objects)
-			: m_Objects(std::move(objects)) {}
-		Layout(const Layout& other)
-			: m_Objects(other.m_Objects) {}
+		Layout()
+			: m_Objects(nullptr), m_ObjectSpans(nullptr), m_ObjectCount(0), m_Lazy(nullptr) {}
+
+		// Both arrays have to live in the arena, object spans are relative to the start of the layout
+		Layout(Object* const* objects, const TextSpan* objectSpans, size_t objectCount, TextSpan span = TextSpan())
+			: m_Objects(objects), m_ObjectSpans(objectSpans), m_ObjectCount(objectCount), m_Span(span), m_Lazy(nullptr) {}
+
+		Layout(LazyLayout* lazy, TextSpan span)
+			: m_Objects(nullptr), m_ObjectSpans(nullptr), m_ObjectCount(0), m_Span(span), m_Lazy(lazy) {}
+
+		// Same objects at another position, for layouts that moved after an edit
+		Layout(const Layout& other, int32_t start)
+			: Layout(other)
+		{
+			m_Span.Start = start;
+		}
 
-		inline const Object* FirstObject() const { return m_Objects.front(); }
-		inline const Object* LastObject() const { return m_Objects.back(); }
+		inline const Object* FirstObject() const { return Resolve().m_Objects[0]; }
+		inline const Object* LastObject() const { const Layout& layout = Resolve(); return layout.m_Objects[layout.m_ObjectCount - 1]; }
 
-		inline bool IsEmpty() const { return m_Objects.empty(); }
+		inline bool IsEmpty() const { return Resolve().m_ObjectCount == 0; }
+		inline size_t Size() const { return Resolve().m_ObjectCount; }
 
-		inline const Object* GetObject(const size_t index) const { return m_Objects.at(index); }
+		inline const Object* GetObject(const size_t index) const { const Layout& layout = Resolve(); return layout.m_Objects[layout.CheckIndex(index)]; }
 
-		inline const Object* operator[](const size_t index) const { return m_Objects.at(index); }
+		inline const Object* operator[](const size_t index) const { return GetObject(index); }
 
-		inline Layout& operator=(const Layout& other) = default;
-		inline Layout& operator=(Layout&& other) noexcept
+		// From the layout name to the closing brace
+		inline TextSpan GetSpan() const { return m_Span; }
+
+		// From the opening to the closing angle bracket
+		inline TextSpan GetObjectSpan(const size_t index) const
 		{
-			if (this != &other)
-				m_Objects = std::move(other.m_Objects);
-			return *this;
+			const Layout& layout = Resolve();
+			if (layout.m_ObjectSpans == nullptr)
+				return TextSpan();
+
+			TextSpan span = layout.m_ObjectSpans[layout.CheckIndex(index)];
+			return TextSpan(m_Span.Start + span.Start, span.Length);
 		}
 
-		auto begin() const { return m_Objects.begin(); }
-		auto end() const { return m_Objects.end(); }
+		Object* const* begin() const { return Resolve().m_Objects; }
+		Object* const* end() const { const Layout& layout = Resolve(); return layout.m_Objects + layout.m_ObjectCount; }
 
 	private:
-		std::vector<Object*> m_Objects;
+		Object* const* m_Objects;
+		const TextSpan* m_ObjectSpans;
+		size_t m_ObjectCount;
+		TextSpan m_Span;
+
+		// Set for layouts that haven't been parsed yet, see LazyLayouts.h
+		LazyLayout* m_Lazy;
+
+		inline const Layout& Resolve() const { return (m_Lazy == nullptr) ? *this : Materialize(); }
+		const Layout& Materialize() const;
+
+		// Throws like the std::vector::at it replaces
+		inline size_t CheckIndex(size_t index) const
+		{
+			if (index >= m_ObjectCount)
+				throw std::out_of_range("Layout: object index out of range");
+			return index;
+		}
+	};
+
+	// One replacement in a text: RemovedLength characters at Start became InsertedLength new ones
+	struct TextEdit
+	{
+		size_t Start;
+		size_t RemovedLength;
+		size_t InsertedLength;
 	};
 
 	class LayoutCollection
 	{
 	public:
+		// Copies share the arena, so the tree stays alive until the last copy is gone
 		LayoutCollection(const LayoutCollection& other)
-			: m_Layouts(other.m_Layouts), m_Diagnostics(other.m_Diagnostics) {}
+			: m_Arenas(other.m_Arenas), m_Symbols(other.m_Symbols), m_Lazy(other.m_Lazy), m_Layouts(other.m_Layouts), m_Diagnostics(other.m_Diagnostics),
+			m_Stats(other.m_Stats), m_Index(other.m_Index), m_SourceLength(other.m_SourceLength), m_ReparsedBytes(other.m_ReparsedBytes) {}
+
+		LayoutCollection(LayoutCollection&& other) noexcept
+			: m_Arenas(std::move(other.m_Arenas)), m_Symbols(std::move(other.m_Symbols)), m_Lazy(std::move(other.m_Lazy)), m_Layouts(std::move(other.m_Layouts)), m_Diagnostics(std::move(other.m_Diagnostics)),
+			m_Stats(std::move(other.m_Stats)), m_Index(std::move(other.m_Index)), m_SourceLength(other.m_SourceLength), m_ReparsedBytes(other.m_ReparsedBytes) {}
+
+		// Every node, string and container is carved out of an arena on top of the given
+		// resource, so tearing the collection down is a single release of that arena.
+		static LayoutCollection LoadFromString(std::string_view text, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+		static LayoutCollection LoadFromFile(const std::string& filePath, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+		// Same with other limits on errors, nesting and input size. Every other way of loading
+		// uses the default ParseOptions.
+		static LayoutCollection LoadFromString(std::string_view text, const ParseOptions& options, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+		static LayoutCollection LoadFromFile(const std::string& filePath, const ParseOptions& options, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+		// Splits the text at top-level layouts and parses them on up to threadCount threads (0 picks
+		// one per core). The result is the same as LoadFromString, symbol ids included; text with errors is always parsed
+		// sequentially to keep the diagnostics identical. The resource has to be thread safe.
+		static LayoutCollection LoadFromStringParallel(std::string_view text, size_t threadCount = 0,
+			std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
-		// The layouts themselves don't have ownership of the objects in case they are copied
-		~LayoutCollection();
+		// Parses the files on up to threadCount threads (0 picks one per core) and merges them in the
+		// order given. Layout names already defined by an earlier file are reported and skipped,
+		// diagnostics are prefixed with the path of their file. With more than one thread the
+		// resource is used concurrently, so it has to be thread safe.
+		static LayoutCollection LoadFromFiles(const std::vector<std::string>& filePaths, size_t threadCount = 0,
+			std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
-		static LayoutCollection LoadFromString(const std::string& text);
-		static LayoutCollection LoadFromFile(const std::string& filePath);
+		// Only finds the top-level layouts and their names, each layout is parsed the first time
+		// anything asks for its objects and kept from then on. That is thread safe, but the resource
+		// has to be as well if layouts get parsed from several threads. The text is copied, a file
+		// is read into memory rather than mapped so editing it later can't change or pull away the
+		// text behind layouts that haven't been parsed yet. Text that doesn't split cleanly into
+		// layouts is parsed up front like LoadFromString would.
+		static LayoutCollection LoadFromStringLazy(std::string_view text, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+		static LayoutCollection LoadFromFileLazy(const std::string& filePath, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
-		inline DiagnosticCollection& GetDiagnostics() { return m_Diagnostics; }
+		// Parses the text after one edit to the text this collection was loaded from. Only the
+		// top-level layout object or layout around the edit is parsed again, everything before and
+		// after it is shared with this collection and just moves by the length difference. Text
+		// with errors, collections merged from several files or loaded from a binary and
+		// collections that have built up too much replaced memory get a full LoadFromString.
+		LayoutCollection Reparse(std::string_view text, const TextEdit& edit) const;
 
-		inline const Layout& FirstLayout() const { return m_Layouts.begin()->second; }
-		inline const Layout& LastLayout() const { return std::prev(m_Layouts.end())->second; }
+		// Canonical .lp source for the collection, see LayoutWriter.h. Loading it again gives the
+		// same tree as long as this collection was loaded without errors.
+		std::string SaveToString() const;
+		bool SaveToFile(const std::string& filePath) const;
 
-		inline bool IsEmpty() const { return m_Layouts.empty(); }
+		// Compiled collections skip lexing and parsing entirely, see BinaryFormat.h for the layout.
+		// A file that fails validation loads as an empty collection with a diagnostic.
+		bool SaveBinary(const std::string& filePath) const;
+		static LayoutCollection LoadBinary(const std::string& filePath, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+		static LayoutCollection LoadFromBinary(std::string_view data, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
-		inline const Layout& GetLayout(const std::string& identifier) const { return m_Layouts.at(identifier); }
+		// The whole tree as JSON, see JsonWriter.h for the schema. Reading it back doesn't need the
+		// .lp source; like binary files, JSON that doesn't fit the schema loads as an empty
+		// collection with a diagnostic pointing at the problem.
+		std::string SaveToJson() const;
+		bool SaveJson(const std::string& filePath) const;
+		static LayoutCollection LoadJson(const std::string& filePath, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+		static LayoutCollection LoadFromJson(std::string_view json, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+		// Lazy collections add the problems found in a layout once it has been parsed,
+		// each one prefixed with the name of the layout. A call brings the collection up to date,
+		// which only copies if a layout reported something since, so don't hold on to it while
+		// layouts are still being touched.
+		DiagnosticCollection& GetDiagnostics();
+
+		// Counts and phase times of the load, see ParseStats.h. Only LoadFromString and LoadFromFile
+		// collect them and only when the library is built with LAYOUTPARSER_ENABLE_STATS, anything
+		// else returns null. Reparsed collections don't carry the stats of the original load.
+		inline const ParseStats* GetStats() const { return m_Stats.get(); }
+
+		// Objects by type and by key, see ObjectIndex.h. Only there for LoadFromString and
+		// LoadFromFile with ParseOptions::BuildIndex, null otherwise and after a Reparse.
+		inline const ObjectIndex* GetIndex() const { return m_Index.get(); }
+
+		// One arena per parsed file
+		inline const std::vector<std::shared_ptr<Arena>>& GetArenas() const { return m_Arenas; }
+
+		// Layout names, object identifiers and property keys are all interned here.
+		// Find a name once and use the symbol for lookups on the objects.
+		inline const SymbolTable& GetSymbols() const { return *m_Symbols; }
+		inline Symbol FindSymbol(std::string_view name) const { return m_Symbols->Find(name); }
+
+		// For things compiled against the table that have to keep it alive, see Query.h
+		inline const std::shared_ptr<SymbolTable>& GetSharedSymbols() const { return m_Symbols; }
+
+		// Layouts are kept in the order they appear in the source
+		inline const Layout& FirstLayout() const { return m_Layouts.Front().second; }
+		inline const Layout& LastLayout() const { return m_Layouts.Back().second; }
+
+		inline bool IsEmpty() const { return m_Layouts.IsEmpty(); }
+
+		inline const Layout& GetLayout(const std::string& identifier) const { return m_Layouts.At(identifier); }
+
+		// Null instead of throwing when there is no such layout
+		inline const Layout* FindLayout(std::string_view identifier) const { return m_Layouts.Find(identifier); }
+		inline const Layout* FindLayout(Symbol symbol) const { return m_Layouts.Find(symbol); }
 
 		// These will both throw exceptions if the key is not found
-		inline const Layout& operator[](const std::string& identifier) const { return m_Layouts.at(identifier); }
-		inline const Layout& operator[](const char* identifier) const { return m_Layouts.at(identifier); }
+		inline const Layout& operator[](const std::string& identifier) const { return m_Layouts.At(identifier); }
+		inline const Layout& operator[](const char* identifier) const { return m_Layouts.At(identifier); }
 
-		inline LayoutCollection& operator=(const LayoutCollection& other) = default;
+		inline LayoutCollection& operator=(const LayoutCollection& other)
+		{
+			if (this != &other)
+			{
+				m_Layouts = other.m_Layouts;
+				m_Arenas = other.m_Arenas;
+				m_Symbols = other.m_Symbols;
+				m_Lazy = other.m_Lazy;
+				m_Diagnostics = other.m_Diagnostics;
+				m_Stats = other.m_Stats;
+				m_Index = other.m_Index;
+				m_SourceLength = other.m_SourceLength;
+				m_ReparsedBytes = other.m_ReparsedBytes;
+			}
+			return *this;
+		}
 		inline LayoutCollection& operator=(LayoutCollection&& other) noexcept
 		{
 			if (this != &other)
 			{
+				// The old layouts still point into the old arena so they have to go first
 				m_Layouts = std::move(other.m_Layouts);
+				m_Arenas = std::move(other.m_Arenas);
+				m_Symbols = std::move(other.m_Symbols);
+				m_Lazy = std::move(other.m_Lazy);
 				m_Diagnostics = std::move(other.m_Diagnostics);
+				m_Stats = std::move(other.m_Stats);
+				m_Index = std::move(other.m_Index);
+				m_SourceLength = other.m_SourceLength;
+				m_ReparsedBytes = other.m_ReparsedBytes;
 			}
 			return *this;
 		}
@@ -83,17 +256,36 @@ namespace LayoutParser
 		auto end() const { return m_Layouts.end(); }
 
 #ifndef LAYOUTPARSER_EXCLUDE_PRETTYPRINT
-		static void PrettyPrint(const LayoutCollection& collection, std::wstring indent = L"", bool isLast = true);
-		static void PrettyPrint(const Layout* layout, const std::wstring& layoutName, std::wstring indent = L"", bool isLast = true);
-		static void PrettyPrint(const Object* object, std::wstring indent, bool isLast);
-		static void PrettyPrint(const Value* value, const std::wstring& propertyName, std::wstring indent = L"", bool isLast = true);
+		// Draws the tree in UTF-8 to stdout or the stream, see TreePrinter.h
+		static void PrettyPrint(const LayoutCollection& collection);
+		static void PrettyPrint(const LayoutCollection& collection, std::ostream& stream);
 #endif
 
 	private:
-		LayoutCollection(std::unordered_map<std::string, Layout>&& layouts, DiagnosticCollection&& diagnostics)
-			: m_Layouts(std::move(layouts)), m_Diagnostics(std::move(diagnostics)) {}
-		
-		std::unordered_map<std::string, Layout> m_Layouts;
+		// Collections that weren't parsed from a single text can't be reparsed
+		static constexpr size_t NoSource = static_cast<size_t>(-1);
+
+		LayoutCollection(std::vector<std::shared_ptr<Arena>>&& arenas, std::shared_ptr<SymbolTable> symbols, FlatMap<Layout>&& layouts, DiagnosticCollection&& diagnostics,
+			size_t sourceLength = NoSource, size_t reparsedBytes = 0)
+			: m_Arenas(std::move(arenas)), m_Symbols(std::move(symbols)), m_Layouts(std::move(layouts)), m_Diagnostics(std::move(diagnostics)),
+			m_SourceLength(sourceLength), m_ReparsedBytes(reparsedBytes) {}
+
+		// Both lazy loads end up here once they own the text
+		static LayoutCollection LoadLazy(std::string&& text, std::pmr::memory_resource* resource);
+
+		// Declared first so they are destroyed after the layouts that point into them
+		std::vector<std::shared_ptr<Arena>> m_Arenas;
+		std::shared_ptr<SymbolTable> m_Symbols;
+		std::shared_ptr<LazyLayouts> m_Lazy;
+		FlatMap<Layout> m_Layouts;
 		DiagnosticCollection m_Diagnostics;
+
+		std::shared_ptr<const ParseStats> m_Stats;
+		std::shared_ptr<const ObjectIndex> m_Index;
+
+		size_t m_SourceLength;
+
+		// Arena memory added by Reparse since the last full parse, most of it replaced by now
+		size_t m_ReparsedBytes;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,196 @@
+#include "Data/LayoutWriter.h"
+
+#include <cmath>
+
+#include "Data/LayoutCollection.h"
+#include "Data/Object.h"
+#include "Data/Value.h"
+
+using namespace LayoutParser;
+
+LayoutWriter::LayoutWriter(OutputBuffer& output)
+	: m_Output(output), m_Depth(0)
+{
+}
+
+void LayoutWriter::Write(const LayoutCollection& collection)
+{
+	bool isFirst = true;
+	for (auto& pair : collection)
+	{
+		if (!isFirst)
+			m_Output.Write('\n');
+		isFirst = false;
+
+		WriteLayout(pair.first, pair.second);
+	}
+}
+
+void LayoutWriter::WriteLayout(std::string_view name, const Layout& layout)
+{
+	m_Output.Write(name);
+	m_Output.Write("\n{");
+
+	m_Depth++;
+	for (const Object* object : layout)
+	{
+		WriteLineBreak();
+		WriteObject(object);
+	}
+	m_Depth--;
+
+	m_Output.Write("\n}\n");
+}
+
+void LayoutWriter::WriteObject(const Object* object)
+{
+	m_Output.Write('<');
+	m_Output.Write(object->GetIdentifier());
+	m_Output.Write('(');
+	if (object->GetConstructor() != nullptr)
+		WriteValue(object->GetConstructor());
+	m_Output.Write(')');
+
+	if (object->IsEmpty())
+	{
+		m_Output.Write('>');
+		return;
+	}
+
+	m_Depth++;
+	bool isFirst = true;
+	for (auto& pair : *object)
+	{
+		if (!isFirst)
+			m_Output.Write(',');
+		isFirst = false;
+
+		WriteLineBreak();
+		m_Output.Write(pair.first);
+		m_Output.Write(" = ");
+		WriteValue(pair.second);
+	}
+	m_Depth--;
+
+	WriteLineBreak();
+	m_Output.Write('>');
+}
+
+namespace
+{
+	// What goes between the brackets for one element of a list or dictionary
+	inline const Value* GetElementValue(const Value* element) { return element; }
+	inline const Value* GetElementValue(const std::pair<std::string_view, const Value*>& entry) { return entry.second; }
+
+	inline void WriteElementName(OutputBuffer&, const Value*) {}
+	inline void WriteElementName(OutputBuffer& output, const std::pair<std::string_view, const Value*>& entry)
+	{
+		output.Write(entry.first);
+		output.Write(" = ");
+	}
+}
+
+template<typename TContainer>
+void LayoutWriter::WriteElements(const TContainer& container, char open, char close)
+{
+	bool isPlain = true;
+	for (auto& element : container)
+		isPlain = isPlain && IsPlain(GetElementValue(element));
+
+	m_Output.Write(open);
+	if (!isPlain)
+		m_Depth++;
+
+	bool isFirst = true;
+	for (auto& element : container)
+	{
+		if (!isFirst)
+			m_Output.Write(isPlain ? ", " : ",");
+		isFirst = false;
+
+		if (!isPlain)
+			WriteLineBreak();
+		WriteElementName(m_Output, element);
+		WriteValue(GetElementValue(element));
+	}
+
+	if (!isPlain)
+	{
+		m_Depth--;
+		WriteLineBreak();
+	}
+	m_Output.Write(close);
+}
+
+void LayoutWriter::WriteValue(const Value* value)
+{
+	static const char hexDigits[] = "0123456789ABCDEF";
+
+	switch (value->GetKind())
+	{
+	case ValueKind::Object:
+		WriteObject(value->AsObject()->GetValue());
+		break;
+	case ValueKind::String:
+		// Strings can't contain a double quote, so there is nothing to escape
+		m_Output.Write('"');
+		m_Output.Write(value->AsString()->GetValue());
+		m_Output.Write('"');
+		break;
+	case ValueKind::Number:
+		WriteNumber(value->AsNumber()->GetValue());
+		break;
+	case ValueKind::Boolean:
+		m_Output.Write(value->AsBoolean()->GetValue() ? "true" : "false");
+		break;
+	case ValueKind::HexColor:
+	{
+		const HexColorValue* hexColor = value->AsHexColor();
+		const uint8_t channels[] = { hexColor->GetR(), hexColor->GetG(), hexColor->GetB() };
+
+		m_Output.Write('#');
+		for (uint8_t channel : channels)
+		{
+			m_Output.Write(hexDigits[channel >> 4]);
+			m_Output.Write(hexDigits[channel & 0xF]);
+		}
+		break;
+	}
+	case ValueKind::List:
+		WriteElements(*value->AsList(), '{', '}');
+		break;
+	case ValueKind::Dictionary:
+		WriteElements(*value->AsDictionary(), '[', ']');
+		break;
+	}
+}
+
+void LayoutWriter::WriteNumber(float number)
+{
+	// Number literals have no exponent, infinity or NaN, those can only come out of an expression
+	if (std::isnan(number))
+	{
+		m_Output.Write("0/0");
+		return;
+	}
+	if (std::isinf(number))
+	{
+		m_Output.Write(number > 0.0f ? "1/0" : "-1/0");
+		return;
+	}
+
+	m_Output.WriteNumber(number, std::chars_format::fixed);
+}
+
+void LayoutWriter::WriteLineBreak()
+{
+	m_Output.Write('\n');
+	for (int32_t i = 0; i < m_Depth; i++)
+		m_Output.Write('\t');
+}
+
+bool LayoutWriter::IsPlain(const Value* value)
+{
+	ValueKind kind = value->GetKind();
+	return kind != ValueKind::Object && kind != ValueKind::List && kind != ValueKind::Dictionary;
+}
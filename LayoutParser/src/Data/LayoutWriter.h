@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include "OutputBuffer.h"
+
+namespace LayoutParser
+{
+	class LayoutCollection;
+	struct Layout;
+	struct Object;
+	struct Value;
+
+	// Writes a collection back out as .lp source in one canonical format: tabs, one property
+	// per line, lists and dictionaries of plain values on one line and numbers in their shortest
+	// form that reads back as the same float. Comments and the original layout of the text are
+	// gone, so writing a loaded collection normalizes it. A collection loaded without errors
+	// loads back from the output to the same tree.
+	class LayoutWriter
+	{
+	public:
+		explicit LayoutWriter(OutputBuffer& output);
+
+		void Write(const LayoutCollection& collection);
+
+	private:
+		OutputBuffer& m_Output;
+		int32_t m_Depth;
+
+		void WriteLayout(std::string_view name, const Layout& layout);
+		void WriteObject(const Object* object);
+		void WriteValue(const Value* value);
+		void WriteNumber(float number);
+
+		// Lists and dictionaries holding an object or another container get a line per element
+		template<typename TContainer>
+		void WriteElements(const TContainer& container, char open, char close);
+
+		void WriteLineBreak();
+
+		static bool IsPlain(const Value* value);
+	};
+}
@@ -0,0 +1,53 @@
+#include "Data/LazyLayouts.h"
+
+#include "Analysis/Parser.h"
+
+using namespace LayoutParser;
+
+// The layout side of the indirection, kept here so LayoutCollection.h doesn't need the parser
+const Layout& Layout::Materialize() const
+{
+	return m_Lazy->Owner->Materialize(*m_Lazy);
+}
+
+LazyLayouts::LazyLayouts(std::string&& text, const std::vector<TextSpan>& spans, std::shared_ptr<SymbolTable> symbols,
+	DiagnosticCollection&& diagnostics, std::pmr::memory_resource* resource)
+	: m_OwnedText(std::move(text)), m_Text(m_OwnedText), m_Symbols(std::move(symbols)), m_Resource(resource), m_Diagnostics(std::move(diagnostics)), m_Lines(m_Text)
+{
+	m_Layouts.reset(new LazyLayout[spans.size()]);
+	for (size_t i = 0; i < spans.size(); i++)
+	{
+		m_Layouts[i].Owner = this;
+		m_Layouts[i].Span = spans[i];
+	}
+}
+
+const Layout& LazyLayouts::Materialize(LazyLayout& layout)
+{
+	std::call_once(layout.Parsed, [&]()
+	{
+		// Small first block, a layout is a fraction of the file
+		layout.LayoutArena = std::make_unique<Arena>(m_Resource, 4 * 1024);
+
+		Parser parser(m_Text.substr(0, layout.Span.GetEnd()), *layout.LayoutArena, *m_Symbols, layout.Span.Start);
+		InternedSymbol name;
+		layout.Value = parser.ParseLayout(name);
+
+		if (!parser.GetDiagnostics().IsEmpty())
+		{
+			std::lock_guard<std::mutex> lock(m_DiagnosticsMutex);
+			parser.GetDiagnostics().ResolveLocations(m_Lines);
+			m_Diagnostics.Append(parser.GetDiagnostics(), name.Name);
+		}
+	});
+
+	return layout.Value;
+}
+
+void LazyLayouts::UpdateDiagnostics(DiagnosticCollection& diagnostics) const
+{
+	// Diagnostics are only ever added, so the same size means nothing changed
+	std::lock_guard<std::mutex> lock(m_DiagnosticsMutex);
+	if (diagnostics.Size() != m_Diagnostics.Size())
+		diagnostics = m_Diagnostics;
+}
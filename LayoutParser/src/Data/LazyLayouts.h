@@ -0,0 +1,68 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <memory_resource>
+
+#include "../Analysis/Diagnostics.h"
+#include "Arena.h"
+#include "LayoutCollection.h"
+#include "SymbolTable.h"
+
+namespace LayoutParser
+{
+	class LazyLayouts;
+
+	// Parse state of one layout of a lazily loaded collection
+	struct LazyLayout
+	{
+		LazyLayouts* Owner = nullptr;
+		TextSpan Span;
+
+		std::once_flag Parsed;
+		std::unique_ptr<Arena> LayoutArena;
+		Layout Value;
+	};
+
+	// The source text of a lazily loaded collection and the layouts that were found in it.
+	// Each layout gets its own arena when it is parsed, so memory only goes to the layouts in use.
+	class LazyLayouts
+	{
+	public:
+		// One layout for every span, the diagnostics are whatever was found while looking for them
+		LazyLayouts(std::string&& text, const std::vector<TextSpan>& spans, std::shared_ptr<SymbolTable> symbols,
+			DiagnosticCollection&& diagnostics, std::pmr::memory_resource* resource);
+
+		LazyLayouts(const LazyLayouts& other) = delete;
+		LazyLayouts& operator=(const LazyLayouts& other) = delete;
+
+		inline std::string_view GetText() const { return m_Text; }
+
+		inline LazyLayout& GetLayout(size_t index) { return m_Layouts[index]; }
+
+		// Parses the layout the first time, every other call and every other thread gets the same result
+		const Layout& Materialize(LazyLayout& layout);
+
+		// What was found while looking for the layouts, then everything reported by the layouts
+		// parsed so far in the order they were parsed. Only copied if something was added since
+		// the collection was last brought up to date.
+		void UpdateDiagnostics(DiagnosticCollection& diagnostics) const;
+
+	private:
+		std::string m_OwnedText;
+		std::string_view m_Text;
+
+		std::unique_ptr<LazyLayout[]> m_Layouts;
+
+		std::shared_ptr<SymbolTable> m_Symbols;
+		std::pmr::memory_resource* m_Resource;
+
+		// The line index is built by the first layout that reports something
+		mutable std::mutex m_DiagnosticsMutex;
+		DiagnosticCollection m_Diagnostics;
+		LineIndex m_Lines;
+	};
+}
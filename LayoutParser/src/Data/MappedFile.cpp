@@ -0,0 +1,158 @@
+#include "Data/MappedFile.h"
+
+#include <utility>
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <Windows.h>
+#else
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
+
+using namespace LayoutParser;
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& filePath)
+	: m_Data(nullptr), m_Size(0), m_IsMapped(false), m_MappingHandle(nullptr)
+{
+	HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return;
+
+	LARGE_INTEGER size;
+	if (GetFileType(file) != FILE_TYPE_DISK || !GetFileSizeEx(file, &size))
+	{
+		CloseHandle(file);
+		return;
+	}
+
+	// Empty files can't be mapped but there is nothing to read either
+	if (size.QuadPart == 0)
+	{
+		CloseHandle(file);
+		m_IsMapped = true;
+		return;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (mapping == nullptr)
+		return;
+
+	void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == nullptr)
+	{
+		CloseHandle(mapping);
+		return;
+	}
+
+	m_Data = static_cast<const char*>(view);
+	m_Size = static_cast<size_t>(size.QuadPart);
+	m_MappingHandle = mapping;
+	m_IsMapped = true;
+}
+
+void MappedFile::Unmap()
+{
+	if (m_Data != nullptr)
+		UnmapViewOfFile(m_Data);
+	if (m_MappingHandle != nullptr)
+		CloseHandle(m_MappingHandle);
+
+	m_Data = nullptr;
+	m_Size = 0;
+	m_MappingHandle = nullptr;
+	m_IsMapped = false;
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+	: m_Data(std::exchange(other.m_Data, nullptr)), m_Size(std::exchange(other.m_Size, 0)),
+	m_IsMapped(std::exchange(other.m_IsMapped, false)), m_MappingHandle(std::exchange(other.m_MappingHandle, nullptr)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other)
+	{
+		Unmap();
+		m_Data = std::exchange(other.m_Data, nullptr);
+		m_Size = std::exchange(other.m_Size, 0);
+		m_IsMapped = std::exchange(other.m_IsMapped, false);
+		m_MappingHandle = std::exchange(other.m_MappingHandle, nullptr);
+	}
+	return *this;
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& filePath)
+	: m_Data(nullptr), m_Size(0), m_IsMapped(false)
+{
+	int file = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+	if (file < 0)
+		return;
+
+	struct stat status;
+	if (fstat(file, &status) != 0 || !S_ISREG(status.st_mode))
+	{
+		close(file);
+		return;
+	}
+
+	// Empty files can't be mapped but there is nothing to read either
+	if (status.st_size == 0)
+	{
+		close(file);
+		m_IsMapped = true;
+		return;
+	}
+
+	void* view = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if (view == MAP_FAILED)
+		return;
+
+	// The lexer only ever walks forward through the file
+	madvise(view, static_cast<size_t>(status.st_size), MADV_SEQUENTIAL);
+
+	m_Data = static_cast<const char*>(view);
+	m_Size = static_cast<size_t>(status.st_size);
+	m_IsMapped = true;
+}
+
+void MappedFile::Unmap()
+{
+	if (m_Data != nullptr)
+		munmap(const_cast<char*>(m_Data), m_Size);
+
+	m_Data = nullptr;
+	m_Size = 0;
+	m_IsMapped = false;
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+	: m_Data(std::exchange(other.m_Data, nullptr)), m_Size(std::exchange(other.m_Size, 0)),
+	m_IsMapped(std::exchange(other.m_IsMapped, false)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other)
+	{
+		Unmap();
+		m_Data = std::exchange(other.m_Data, nullptr);
+		m_Size = std::exchange(other.m_Size, 0);
+		m_IsMapped = std::exchange(other.m_IsMapped, false);
+	}
+	return *this;
+}
+
+#endif
+
+MappedFile::~MappedFile()
+{
+	Unmap();
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace LayoutParser
+{
+	// Read-only memory mapping of a whole file. Only regular files are mapped, for anything
+	// else (pipes, character devices, missing files) IsMapped() is false and the caller is
+	// expected to fall back to reading the file normally.
+	class MappedFile
+	{
+	public:
+		MappedFile(const std::string& filePath);
+		~MappedFile();
+
+		MappedFile(const MappedFile& other) = delete;
+		MappedFile& operator=(const MappedFile& other) = delete;
+
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+
+		inline bool IsMapped() const { return m_IsMapped; }
+
+		inline std::string_view GetText() const { return std::string_view(m_Data, m_Size); }
+		inline size_t GetSize() const { return m_Size; }
+
+	private:
+		const char* m_Data;
+		size_t m_Size;
+		bool m_IsMapped;
+
+#ifdef _WIN32
+		void* m_MappingHandle;
+#endif
+
+		void Unmap();
+	};
+}
@@ -1,38 +1,52 @@
 #pragma once
 
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <memory_resource>
+
+#include "FlatMap.h"
+#include "Symbol.h"
 
 namespace LayoutParser
 {
 	struct Value;
 
+	// Allocated from the owning collection's Arena along with its identifier and properties
 	struct Object
 	{
 	public:
-		Object(const std::string& identifier, Value* constructor, std::unordered_map<std::string, Value*>&& properties)
-			: m_Identifier(identifier), m_Constructor(constructor), m_Properties(std::move(properties)) {}
-		~Object();
+		Object(Symbol symbol, std::string_view identifier, Value* constructor, FlatMap<Value*>&& properties)
+			: m_Symbol(symbol), m_Identifier(identifier), m_Constructor(constructor), m_Properties(std::move(properties)) {}
 
-		const std::string& GetIdentifier() const { return m_Identifier; }
+		std::string_view GetIdentifier() const { return m_Identifier; }
+		Symbol GetSymbol() const { return m_Symbol; }
 		const Value* GetConstructor() const { return m_Constructor; }
 
-		inline const Value* FirstProperty() const { return m_Properties.begin()->second; }
-		inline const Value* LastProperty() const { return std::prev(m_Properties.end())->second; }
+		// Properties are kept in the order they appear in the source
+		inline const Value* FirstProperty() const { return m_Properties.Front().second; }
+		inline const Value* LastProperty() const { return m_Properties.Back().second; }
+
+		inline bool IsEmpty() const { return m_Properties.IsEmpty(); }
 
-		inline bool IsEmpty() const { return m_Properties.empty(); }
+		inline const FlatMap<Value*>& GetContainer() const { return m_Properties; }
 
-		inline const Value* GetProperty(const std::string& identifier) const { return m_Properties.at(identifier); }
+		inline const Value* GetProperty(const std::string& identifier) const { return m_Properties.At(identifier); }
 		
-		inline const Value* operator[](const std::string& identifier) const { return m_Properties.at(identifier); }
-		inline const Value* operator[](const char* identifier) const { return m_Properties.at(identifier); }
+		inline const Value* operator[](const std::string& identifier) const { return m_Properties.At(identifier); }
+		inline const Value* operator[](const char* identifier) const { return m_Properties.At(identifier); }
+
+		// Symbols come from the owning collection's SymbolTable, resolve them once and reuse
+		// them for hot lookups
+		inline const Value* GetProperty(Symbol symbol) const { return m_Properties.At(symbol); }
+		inline const Value* operator[](Symbol symbol) const { return m_Properties.At(symbol); }
 
 		auto begin() const { return m_Properties.begin(); }
 		auto end() const { return m_Properties.end(); }
 
 	private:
-		std::string m_Identifier;
+		Symbol m_Symbol;
+		std::string_view m_Identifier;
 		Value* m_Constructor;
-		std::unordered_map<std::string, Value*> m_Properties;
+		FlatMap<Value*> m_Properties;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,53 @@
+#include "Data/ObjectIndex.h"
+
+#include <algorithm>
+
+using namespace LayoutParser;
+
+void ObjectIndex::BeginLayout()
+{
+	m_LayoutStart = m_Pending.size();
+	m_LayoutKeys.clear();
+}
+
+void ObjectIndex::CommitLayout(Symbol layout)
+{
+	for (auto& key : m_LayoutKeys)
+		m_Keys.emplace(Key{ layout.Id, key.first }, key.second);
+	m_LayoutKeys.clear();
+}
+
+void ObjectIndex::RollbackLayout()
+{
+	m_Pending.resize(m_LayoutStart);
+	m_LayoutKeys.clear();
+}
+
+size_t ObjectIndex::ReserveObject(Symbol type)
+{
+	m_Pending.emplace_back(type.Id, nullptr);
+	return m_Pending.size() - 1;
+}
+
+void ObjectIndex::Finish()
+{
+	uint32_t typeCount = 0;
+	for (auto& pending : m_Pending)
+		typeCount = std::max(typeCount, pending.first + 1);
+
+	// Counting sort, one pass to size the groups and one to fill them keeps source order within a type
+	m_TypeStarts.assign(static_cast<size_t>(typeCount) + 1, 0);
+	for (auto& pending : m_Pending)
+		m_TypeStarts[pending.first + 1]++;
+	for (size_t i = 1; i < m_TypeStarts.size(); i++)
+		m_TypeStarts[i] += m_TypeStarts[i - 1];
+
+	std::vector<uint32_t> next(m_TypeStarts.begin(), m_TypeStarts.end() - 1);
+	m_Objects.resize(m_Pending.size());
+	for (auto& pending : m_Pending)
+		m_Objects[next[pending.first]++] = pending.second;
+
+	m_Pending.clear();
+	m_Pending.shrink_to_fit();
+	m_LayoutKeys = {};
+}
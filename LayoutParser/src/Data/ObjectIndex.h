@@ -0,0 +1,111 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <functional>
+#include <cstdint>
+
+#include "Symbol.h"
+
+namespace LayoutParser
+{
+	struct Object;
+
+	// Objects of one type in the order they appear in the source
+	class ObjectRange
+	{
+	public:
+		ObjectRange()
+			: m_Begin(nullptr), m_End(nullptr) {}
+		ObjectRange(const Object* const* begin, const Object* const* end)
+			: m_Begin(begin), m_End(end) {}
+
+		inline size_t Size() const { return static_cast<size_t>(m_End - m_Begin); }
+		inline bool IsEmpty() const { return m_Begin == m_End; }
+
+		inline const Object* operator[](size_t index) const { return m_Begin[index]; }
+
+		const Object* const* begin() const { return m_Begin; }
+		const Object* const* end() const { return m_End; }
+
+	private:
+		const Object* const* m_Begin;
+		const Object* const* m_End;
+	};
+
+	// Every object of a collection by type, and by the string value of one key property (ID by
+	// default) within its layout, filled in by the Parser as it goes when ParseOptions::BuildIndex
+	// is set. Types are looked up with the symbol of their name, which indexes straight into an
+	// array; keys go through a hash map. Both point into the collection's arena, so the index
+	// lives with it.
+	class ObjectIndex
+	{
+	public:
+		// All objects of the type anywhere in the tree, nested ones included
+		inline ObjectRange GetObjectsOfType(Symbol type) const
+		{
+			if (static_cast<size_t>(type.Id) + 1 >= m_TypeStarts.size())
+				return ObjectRange();
+
+			const Object* const* objects = m_Objects.data();
+			return ObjectRange(objects + m_TypeStarts[type.Id], objects + m_TypeStarts[type.Id + 1]);
+		}
+
+		// Null if no object of the layout has that key. Keys only have to be unique within a
+		// layout, every screen can have its own "frame".
+		inline const Object* FindObject(Symbol layout, std::string_view key) const
+		{
+			auto found = m_Keys.find(Key{ layout.Id, key });
+			return (found != m_Keys.end()) ? found->second : nullptr;
+		}
+
+		inline size_t GetObjectCount() const { return m_Objects.size(); }
+		inline size_t GetKeyCount() const { return m_Keys.size(); }
+
+		// Building, used by the Parser. Everything added between BeginLayout and CommitLayout
+		// belongs to one layout, RollbackLayout drops it again for a layout that isn't kept.
+		void BeginLayout();
+		void CommitLayout(Symbol layout);
+		void RollbackLayout();
+
+		// Objects get their slot when their type is known, so nested objects still come after
+		// the ones they are in
+		size_t ReserveObject(Symbol type);
+		inline void SetObject(size_t slot, const Object* object) { m_Pending[slot].second = object; }
+
+		// The key has to live in the arena, returns false if another object of the layout already has it
+		inline bool AddKey(std::string_view key, const Object* object) { return m_LayoutKeys.emplace(key, object).second; }
+
+		// Sorts the objects by type, nothing can be added after this
+		void Finish();
+
+	private:
+		struct Key
+		{
+			uint32_t Layout;
+			std::string_view Value;
+
+			inline bool operator==(const Key& other) const { return Layout == other.Layout && Value == other.Value; }
+		};
+
+		struct KeyHash
+		{
+			inline size_t operator()(const Key& key) const { return std::hash<std::string_view>()(key.Value) ^ (static_cast<size_t>(key.Layout) * 0x9E3779B9u); }
+		};
+
+		// Objects grouped by type, the ones of type id i are at [m_TypeStarts[i], m_TypeStarts[i + 1])
+		std::vector<const Object*> m_Objects;
+		std::vector<uint32_t> m_TypeStarts;
+
+		std::unordered_map<Key, const Object*, KeyHash> m_Keys;
+
+		// Type id and object in source order until Finish
+		std::vector<std::pair<uint32_t, const Object*>> m_Pending;
+
+		// The layout being built, its objects start at m_LayoutStart in m_Pending
+		size_t m_LayoutStart = 0;
+		std::unordered_map<std::string_view, const Object*> m_LayoutKeys;
+	};
+}
@@ -0,0 +1,57 @@
+#include "Data/OutputBuffer.h"
+
+using namespace LayoutParser;
+
+OutputBuffer::OutputBuffer(Sink sink, size_t capacity)
+	: m_Sink(std::move(sink)), m_Buffer(new char[capacity]), m_Cursor(m_Buffer.get()), m_End(m_Buffer.get() + capacity)
+{
+}
+
+OutputBuffer::OutputBuffer(std::ostream& stream, size_t capacity)
+	: OutputBuffer([&stream](std::string_view text) { stream.write(text.data(), static_cast<std::streamsize>(text.length())); }, capacity)
+{
+}
+
+OutputBuffer::OutputBuffer(std::string& target, size_t capacity)
+	: OutputBuffer([&target](std::string_view text) { target.append(text); }, capacity)
+{
+}
+
+void OutputBuffer::WriteNumber(float number, std::chars_format format)
+{
+	// Fixed notation of the largest float is 39 digits, the smallest denormal about 50
+	char digits[64];
+	std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), number, format);
+	Write(std::string_view(digits, result.ptr - digits));
+}
+
+void OutputBuffer::WriteInteger(int64_t number)
+{
+	char digits[24];
+	std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), number);
+	Write(std::string_view(digits, result.ptr - digits));
+}
+
+void OutputBuffer::Flush()
+{
+	if (m_Cursor == m_Buffer.get())
+		return;
+
+	m_Sink(std::string_view(m_Buffer.get(), m_Cursor - m_Buffer.get()));
+	m_Cursor = m_Buffer.get();
+}
+
+void OutputBuffer::WriteLarge(std::string_view text)
+{
+	Flush();
+
+	// Anything bigger than the whole buffer goes straight through
+	if (text.length() >= static_cast<size_t>(m_End - m_Cursor))
+	{
+		m_Sink(text);
+		return;
+	}
+
+	std::memcpy(m_Cursor, text.data(), text.length());
+	m_Cursor += text.length();
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <charconv>
+#include <cstring>
+#include <cstdint>
+
+namespace LayoutParser
+{
+	// Collects text in one fixed buffer and hands it to the sink in large pieces, so writing a
+	// piece of text is a copy into the buffer and nothing else. Whatever is left is flushed
+	// when the buffer goes away.
+	class OutputBuffer
+	{
+	public:
+		using Sink = std::function<void(std::string_view)>;
+
+		static constexpr size_t DefaultCapacity = 64 * 1024;
+
+		explicit OutputBuffer(Sink sink, size_t capacity = DefaultCapacity);
+
+		// Writes to the stream, or appends to the string
+		explicit OutputBuffer(std::ostream& stream, size_t capacity = DefaultCapacity);
+		explicit OutputBuffer(std::string& target, size_t capacity = DefaultCapacity);
+
+		~OutputBuffer() { Flush(); }
+
+		OutputBuffer(const OutputBuffer& other) = delete;
+		OutputBuffer& operator=(const OutputBuffer& other) = delete;
+
+		inline void Write(std::string_view text)
+		{
+			// An empty view can have a null data pointer, which memcpy doesn't allow even for no bytes
+			if (text.empty())
+				return;
+
+			if (text.length() > static_cast<size_t>(m_End - m_Cursor))
+			{
+				WriteLarge(text);
+				return;
+			}
+
+			std::memcpy(m_Cursor, text.data(), text.length());
+			m_Cursor += text.length();
+		}
+
+		inline void Write(char character)
+		{
+			if (m_Cursor == m_End)
+				Flush();
+			*m_Cursor++ = character;
+		}
+
+		// Shortest text that reads back as the same float, "inf" and "nan" included
+		void WriteNumber(float number, std::chars_format format = std::chars_format::general);
+		void WriteInteger(int64_t number);
+
+		void Flush();
+
+	private:
+		Sink m_Sink;
+		std::unique_ptr<char[]> m_Buffer;
+		char* m_Cursor;
+		char* m_End;
+
+		void WriteLarge(std::string_view text);
+	};
+}
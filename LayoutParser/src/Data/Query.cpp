@@ -0,0 +1,622 @@
+#include "Data/Query.h"
+
+#include <charconv>
+
+#include "Data/LayoutCollection.h"
+#include "Data/Object.h"
+#include "Data/SymbolTable.h"
+
+using namespace LayoutParser;
+
+namespace
+{
+	inline bool IsNameCharacter(char character)
+	{
+		return (character >= 'a' && character <= 'z') || (character >= 'A' && character <= 'Z') || (character >= '0' && character <= '9') || character == '_';
+	}
+
+	inline bool IsDigit(char character)
+	{
+		return character >= '0' && character <= '9';
+	}
+
+	inline int32_t GetHexDigit(char character)
+	{
+		if (character >= '0' && character <= '9')
+			return character - '0';
+		if (character >= 'a' && character <= 'f')
+			return character - 'a' + 10;
+		if (character >= 'A' && character <= 'F')
+			return character - 'A' + 10;
+		return -1;
+	}
+
+	// Symbols of the query are only good for maps from the same table, and a name that wasn't
+	// interned yet when the query was compiled could have been added by a reparse since
+	template<typename TValue>
+	inline const Value* Lookup(const FlatMap<TValue>& map, Symbol symbol, std::string_view name, bool useSymbols)
+	{
+		const TValue* found = (useSymbols && symbol.IsValid()) ? map.Find(symbol) : map.Find(name);
+		return (found != nullptr) ? *found : nullptr;
+	}
+
+	struct CollectSink
+	{
+		std::vector<QueryMatch>& Matches;
+
+		inline bool operator()(const QueryMatch& match)
+		{
+			Matches.push_back(match);
+			return true;
+		}
+	};
+
+	struct FirstSink
+	{
+		QueryMatch& Match;
+
+		inline bool operator()(const QueryMatch& match)
+		{
+			Match = match;
+			return false;
+		}
+	};
+}
+
+Query::Query()
+	: m_Error("empty query"), m_ErrorPosition(0)
+{
+}
+
+Query Query::Compile(std::string_view text, const LayoutCollection& collection)
+{
+	Query query;
+	query.m_Text = std::string(text);
+	query.m_Symbols = collection.GetSharedSymbols();
+	query.Parse(query.m_Symbols.get());
+	return query;
+}
+
+Query Query::Compile(std::string_view text)
+{
+	Query query;
+	query.m_Text = std::string(text);
+	query.Parse(nullptr);
+	return query;
+}
+
+void Query::Run(const LayoutCollection& collection, std::vector<QueryMatch>& matches) const
+{
+	CollectSink sink{ matches };
+	VisitLayouts(collection, sink);
+}
+
+QueryMatch Query::First(const LayoutCollection& collection) const
+{
+	QueryMatch match;
+	FirstSink sink{ match };
+	VisitLayouts(collection, sink);
+	return match;
+}
+
+// Compiling
+
+void Query::Parse(const SymbolTable* symbols)
+{
+	m_Error = nullptr;
+	m_ErrorPosition = 0;
+
+	// Offsets into the text are 32 bit
+	if (m_Text.length() > UINT32_MAX)
+	{
+		Fail("query is too long", 0);
+		return;
+	}
+
+	size_t position = 0;
+	if (!ParseStep(position, symbols))
+		return;
+
+	const Step& layoutStep = m_Steps.front();
+	if (layoutStep.Kind == StepKind::Index || layoutStep.FilterCount != 0)
+	{
+		Fail("the first step has to be a layout name or *", 0);
+		return;
+	}
+
+	while (position < m_Text.length())
+	{
+		if (m_Text[position] != '/')
+		{
+			Fail("expected '/'", position);
+			return;
+		}
+		position++;
+
+		if (!ParseStep(position, symbols))
+			return;
+	}
+
+	if (m_Steps.size() < 2)
+		Fail("a query needs at least one step after the layout", m_Text.length());
+}
+
+bool Query::ParseStep(size_t& position, const SymbolTable* symbols)
+{
+	Step step = {};
+	step.FirstFilter = static_cast<uint32_t>(m_Filters.size());
+
+	if (position < m_Text.length() && m_Text[position] == '*')
+	{
+		step.Kind = StepKind::Any;
+		position++;
+	}
+	else if (position < m_Text.length() && IsDigit(m_Text[position]))
+	{
+		size_t start = position;
+		while (position < m_Text.length() && IsDigit(m_Text[position]))
+			position++;
+
+		std::from_chars_result result = std::from_chars(m_Text.data() + start, m_Text.data() + position, step.Index);
+		if (result.ec != std::errc())
+			return Fail("index is too large", start);
+
+		step.Kind = StepKind::Index;
+	}
+	else
+	{
+		if (!ParseName(position, step.NameStart, step.NameLength))
+			return false;
+
+		step.Kind = StepKind::Name;
+		if (symbols != nullptr)
+			step.Name = symbols->Find(GetName(step.NameStart, step.NameLength));
+	}
+
+	while (position < m_Text.length() && m_Text[position] == '[')
+	{
+		if (!ParseFilter(position, symbols))
+			return false;
+		step.FilterCount++;
+	}
+
+	m_Steps.push_back(step);
+	return true;
+}
+
+bool Query::ParseFilter(size_t& position, const SymbolTable* symbols)
+{
+	Filter filter = {};
+
+	// Skip the [
+	position++;
+	SkipSpaces(position);
+
+	if (!ParseName(position, filter.KeyStart, filter.KeyLength))
+		return false;
+	if (symbols != nullptr)
+		filter.Key = symbols->Find(GetName(filter.KeyStart, filter.KeyLength));
+
+	SkipSpaces(position);
+	if (position < m_Text.length() && m_Text[position] == ']')
+	{
+		filter.Kind = FilterKind::Exists;
+		position++;
+		m_Filters.push_back(filter);
+		return true;
+	}
+
+	if (m_Text.compare(position, 2, "!=") == 0)
+	{
+		filter.Kind = FilterKind::NotEqual;
+		position += 2;
+	}
+	else if (position < m_Text.length() && m_Text[position] == '=')
+	{
+		filter.Kind = FilterKind::Equal;
+		position++;
+	}
+	else
+		return Fail("expected '=', '!=' or ']'", position);
+
+	SkipSpaces(position);
+	if (!ParseLiteral(position, filter))
+		return false;
+
+	SkipSpaces(position);
+	if (position >= m_Text.length() || m_Text[position] != ']')
+		return Fail("expected ']'", position);
+	position++;
+
+	m_Filters.push_back(filter);
+	return true;
+}
+
+bool Query::ParseLiteral(size_t& position, Filter& filter)
+{
+	size_t start = position;
+	char first = (position < m_Text.length()) ? m_Text[position] : '\0';
+
+	if (first == '"')
+	{
+		// Strings in .lp files can't contain a double quote, so there is nothing to unescape
+		size_t closingQuote = m_Text.find('"', position + 1);
+		if (closingQuote == std::string::npos)
+			return Fail("missing closing quote", start);
+
+		filter.LiteralKind = ValueKind::String;
+		filter.StringStart = static_cast<uint32_t>(position + 1);
+		filter.StringLength = static_cast<uint32_t>(closingQuote - position - 1);
+		position = closingQuote + 1;
+		return true;
+	}
+
+	if (first == '#')
+	{
+		position++;
+		for (size_t channel = 0; channel < 3; channel++)
+		{
+			int32_t high = (position < m_Text.length()) ? GetHexDigit(m_Text[position]) : -1;
+			int32_t low = (position + 1 < m_Text.length()) ? GetHexDigit(m_Text[position + 1]) : -1;
+			if (high < 0 || low < 0)
+				return Fail("a color has to be #RRGGBB", start);
+
+			filter.Color[channel] = static_cast<uint8_t>(high * 16 + low);
+			position += 2;
+		}
+
+		filter.LiteralKind = ValueKind::HexColor;
+		return true;
+	}
+
+	if (m_Text.compare(position, 4, "true") == 0 || m_Text.compare(position, 5, "false") == 0)
+	{
+		filter.LiteralKind = ValueKind::Boolean;
+		filter.Boolean = (first == 't');
+		position += filter.Boolean ? 4 : 5;
+		return true;
+	}
+
+	if (first == '-' || first == '.' || IsDigit(first))
+	{
+		const char* end = m_Text.data() + m_Text.length();
+		std::from_chars_result result = std::from_chars(m_Text.data() + position, end, filter.Number);
+		if (result.ec != std::errc())
+			return Fail("invalid number", start);
+
+		filter.LiteralKind = ValueKind::Number;
+		position = static_cast<size_t>(result.ptr - m_Text.data());
+		return true;
+	}
+
+	return Fail("expected a string, number, boolean or color", start);
+}
+
+bool Query::ParseName(size_t& position, uint32_t& start, uint32_t& length)
+{
+	size_t nameStart = position;
+	while (position < m_Text.length() && IsNameCharacter(m_Text[position]))
+		position++;
+
+	if (position == nameStart)
+		return Fail("expected a name", nameStart);
+
+	start = static_cast<uint32_t>(nameStart);
+	length = static_cast<uint32_t>(position - nameStart);
+	return true;
+}
+
+void Query::SkipSpaces(size_t& position) const
+{
+	while (position < m_Text.length() && m_Text[position] == ' ')
+		position++;
+}
+
+bool Query::Fail(const char* error, size_t position)
+{
+	m_Error = error;
+	m_ErrorPosition = position;
+
+	// A broken query matches nothing
+	m_Steps.clear();
+	m_Filters.clear();
+	return false;
+}
+
+// Running
+
+bool Query::UsesSymbolsOf(const LayoutCollection& collection) const
+{
+	return m_Symbols != nullptr && m_Symbols.get() == &collection.GetSymbols();
+}
+
+const Layout* Query::FindLayout(const LayoutCollection& collection, bool useSymbols) const
+{
+	const Step& step = m_Steps.front();
+	if (useSymbols && step.Name.IsValid())
+		return collection.FindLayout(step.Name);
+	return collection.FindLayout(GetName(step.NameStart, step.NameLength));
+}
+
+bool Query::MatchesType(const Step& step, const Object* object, bool useSymbols) const
+{
+	if (step.Kind == StepKind::Any)
+		return true;
+	if (useSymbols && step.Name.IsValid())
+		return object->GetSymbol() == step.Name;
+	return object->GetIdentifier() == GetName(step.NameStart, step.NameLength);
+}
+
+bool Query::MatchesFilters(const Step& step, const Value* value, const Object* object, bool useSymbols) const
+{
+	if (step.FilterCount == 0)
+		return true;
+
+	const DictionaryValue* dictionary = (value != nullptr) ? value->AsDictionary() : nullptr;
+	if (object == nullptr && dictionary == nullptr)
+		return false;
+
+	for (uint32_t i = 0; i < step.FilterCount; i++)
+	{
+		const Filter& filter = m_Filters[step.FirstFilter + i];
+		std::string_view key = GetName(filter.KeyStart, filter.KeyLength);
+
+		const Value* property = (object != nullptr)
+			? Lookup(object->GetContainer(), filter.Key, key, useSymbols)
+			: Lookup(dictionary->GetContainer(), filter.Key, key, useSymbols);
+		if (property == nullptr)
+			return false;
+
+		if (filter.Kind == FilterKind::Equal && !MatchesLiteral(filter, property))
+			return false;
+		if (filter.Kind == FilterKind::NotEqual && MatchesLiteral(filter, property))
+			return false;
+	}
+	return true;
+}
+
+bool Query::MatchesLiteral(const Filter& filter, const Value* value) const
+{
+	if (value->GetKind() != filter.LiteralKind)
+		return false;
+
+	switch (filter.LiteralKind)
+	{
+	case ValueKind::String:
+		return value->AsString()->GetValue() == GetName(filter.StringStart, filter.StringLength);
+	case ValueKind::Number:
+		return value->AsNumber()->GetValue() == filter.Number;
+	case ValueKind::Boolean:
+		return value->AsBoolean()->GetValue() == filter.Boolean;
+	case ValueKind::HexColor:
+	{
+		const HexColorValue* hexColor = value->AsHexColor();
+		return hexColor->GetR() == filter.Color[0] && hexColor->GetG() == filter.Color[1] && hexColor->GetB() == filter.Color[2];
+	}
+	default:
+		return false;
+	}
+}
+
+template<typename TSink>
+bool Query::VisitLayouts(const LayoutCollection& collection, TSink& sink) const
+{
+	if (!IsValid())
+		return true;
+
+	bool useSymbols = UsesSymbolsOf(collection);
+	if (m_Steps.front().Kind == StepKind::Any)
+	{
+		for (auto& pair : collection)
+		{
+			if (!VisitLayout(pair.second, useSymbols, sink))
+				return false;
+		}
+		return true;
+	}
+
+	const Layout* layout = FindLayout(collection, useSymbols);
+	return layout == nullptr || VisitLayout(*layout, useSymbols, sink);
+}
+
+template<typename TSink>
+bool Query::VisitLayout(const Layout& layout, bool useSymbols, TSink& sink) const
+{
+	const Step& step = m_Steps[1];
+	if (step.Kind == StepKind::Index)
+		return step.Index >= layout.Size() || VisitLayoutObject(layout, step.Index, useSymbols, sink);
+
+	for (size_t i = 0; i < layout.Size(); i++)
+	{
+		if (!VisitLayoutObject(layout, i, useSymbols, sink))
+			return false;
+	}
+	return true;
+}
+
+template<typename TSink>
+bool Query::VisitLayoutObject(const Layout& layout, size_t index, bool useSymbols, TSink& sink) const
+{
+	const Step& step = m_Steps[1];
+	const Object* object = layout.begin()[index];
+
+	bool matches = (step.Kind == StepKind::Index) ? step.Index == index : MatchesType(step, object, useSymbols);
+	return !matches || Offer(1, nullptr, object, useSymbols, sink);
+}
+
+template<typename TSink>
+bool Query::Offer(size_t stepIndex, const Value* value, const Object* object, bool useSymbols, TSink& sink) const
+{
+	if (!MatchesFilters(m_Steps[stepIndex], value, object, useSymbols))
+		return true;
+
+	if (stepIndex + 1 == m_Steps.size())
+		return sink(QueryMatch(value, object));
+
+	return Visit(stepIndex + 1, value, object, useSymbols, sink);
+}
+
+template<typename TSink>
+bool Query::Visit(size_t stepIndex, const Value* value, const Object* object, bool useSymbols, TSink& sink) const
+{
+	const Step& step = m_Steps[stepIndex];
+	std::string_view name = GetName(step.NameStart, step.NameLength);
+
+	auto offerValue = [&](const Value* child)
+	{
+		const ObjectValue* objectValue = child->AsObject();
+		return Offer(stepIndex, child, (objectValue != nullptr) ? objectValue->GetValue() : nullptr, useSymbols, sink);
+	};
+
+	// Objects and dictionaries are looked up by key
+	const DictionaryValue* dictionary = (value != nullptr) ? value->AsDictionary() : nullptr;
+	if (object != nullptr || dictionary != nullptr)
+	{
+		if (step.Kind == StepKind::Index)
+			return true;
+
+		if (step.Kind == StepKind::Name)
+		{
+			const Value* child = (object != nullptr)
+				? Lookup(object->GetContainer(), step.Name, name, useSymbols)
+				: Lookup(dictionary->GetContainer(), step.Name, name, useSymbols);
+			return child == nullptr || offerValue(child);
+		}
+
+		if (object != nullptr)
+		{
+			for (auto& pair : *object)
+			{
+				if (!offerValue(pair.second))
+					return false;
+			}
+		}
+		else
+		{
+			for (auto& pair : *dictionary)
+			{
+				if (!offerValue(pair.second))
+					return false;
+			}
+		}
+		return true;
+	}
+
+	// Lists are filtered by type
+	const ListValue* list = (value != nullptr) ? value->AsList() : nullptr;
+	if (list == nullptr)
+		return true;
+
+	const std::pmr::vector<const Value*>& elements = list->GetContainer();
+	if (step.Kind == StepKind::Index)
+		return step.Index >= elements.size() || offerValue(elements[step.Index]);
+
+	for (const Value* element : elements)
+	{
+		const ObjectValue* objectValue = element->AsObject();
+		if (step.Kind == StepKind::Name && (objectValue == nullptr || !MatchesType(step, objectValue->GetValue(), useSymbols)))
+			continue;
+
+		if (!offerValue(element))
+			return false;
+	}
+	return true;
+}
+
+// Batches
+
+namespace
+{
+	struct FirstSinks
+	{
+		std::vector<QueryMatch>& Matches;
+
+		inline FirstSink operator()(size_t query) { return FirstSink{ Matches[query] }; }
+		inline bool IsDone(size_t query) const { return !Matches[query].IsEmpty(); }
+	};
+
+	struct CollectSinks
+	{
+		std::vector<std::vector<QueryMatch>>& Matches;
+
+		inline CollectSink operator()(size_t query) { return CollectSink{ Matches[query] }; }
+		inline bool IsDone(size_t) const { return false; }
+	};
+}
+
+size_t QueryBatch::Add(Query query)
+{
+	size_t index = m_Queries.size();
+	m_Queries.push_back(std::move(query));
+
+	const Query& added = m_Queries.back();
+	if (!added.IsValid())
+		return index;
+
+	const Query::Step& layoutStep = added.m_Steps.front();
+	std::string layout = (layoutStep.Kind == Query::StepKind::Any) ? std::string() : std::string(added.GetName(layoutStep.NameStart, layoutStep.NameLength));
+
+	for (Group& group : m_Groups)
+	{
+		if (group.Layout == layout)
+		{
+			group.Queries.push_back(index);
+			return index;
+		}
+	}
+
+	m_Groups.push_back(Group{ std::move(layout), { index } });
+	return index;
+}
+
+void QueryBatch::RunFirst(const LayoutCollection& collection, std::vector<QueryMatch>& matches) const
+{
+	matches.assign(m_Queries.size(), QueryMatch());
+
+	FirstSinks sinks{ matches };
+	Sweep(collection, sinks);
+}
+
+void QueryBatch::Run(const LayoutCollection& collection, std::vector<std::vector<QueryMatch>>& matches) const
+{
+	matches.resize(m_Queries.size());
+	for (std::vector<QueryMatch>& queryMatches : matches)
+		queryMatches.clear();
+
+	CollectSinks sinks{ matches };
+	Sweep(collection, sinks);
+}
+
+template<typename TSinkFactory>
+void QueryBatch::Sweep(const LayoutCollection& collection, TSinkFactory& makeSink) const
+{
+	auto sweepLayout = [&](const Group& group, const Layout& layout)
+	{
+		for (size_t i = 0; i < layout.Size(); i++)
+		{
+			for (size_t queryIndex : group.Queries)
+			{
+				if (makeSink.IsDone(queryIndex))
+					continue;
+
+				const Query& query = m_Queries[queryIndex];
+				auto sink = makeSink(queryIndex);
+				query.VisitLayoutObject(layout, i, query.UsesSymbolsOf(collection), sink);
+			}
+		}
+	};
+
+	for (const Group& group : m_Groups)
+	{
+		if (group.Layout.empty())
+		{
+			for (auto& pair : collection)
+				sweepLayout(group, pair.second);
+			continue;
+		}
+
+		const Layout* layout = collection.FindLayout(group.Layout);
+		if (layout != nullptr)
+			sweepLayout(group, *layout);
+	}
+}
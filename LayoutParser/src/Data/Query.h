@@ -0,0 +1,189 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include "Symbol.h"
+#include "Value.h"
+
+namespace LayoutParser
+{
+	class LayoutCollection;
+	class SymbolTable;
+	struct Layout;
+	struct Object;
+
+	// Something a query found. Objects directly in a layout have no value around them, so for
+	// those only the object is set. Everything else has a value, and an object too if it is one.
+	class QueryMatch
+	{
+	public:
+		QueryMatch()
+			: m_Value(nullptr), m_Object(nullptr) {}
+		QueryMatch(const Value* value, const Object* object)
+			: m_Value(value), m_Object(object) {}
+
+		inline bool IsEmpty() const { return m_Value == nullptr && m_Object == nullptr; }
+
+		inline const Value* GetValue() const { return m_Value; }
+		inline const Object* GetObject() const { return m_Object; }
+
+	private:
+		const Value* m_Value;
+		const Object* m_Object;
+	};
+
+	// A path through a collection, compiled once and run as often as needed:
+	//
+	//   Main/Frame[ID="frame"]/Constraints/Top/Target
+	//
+	// The first step names a layout, or is * for all of them. After that a name looks up a
+	// property of an object or an entry of a dictionary, and picks the objects of that type out
+	// of a layout or a list. * takes everything at that level and a number picks one object of
+	// a layout or one element of a list. Every step after the layout can be followed by filters
+	// on the properties of what it found: [Key], [Key="text"], [Key=0.5], [Key=true] and
+	// [Key=#RRGGBB], or != for anything but that value (the key still has to be there).
+	//
+	// Names are resolved against the symbol table of the collection the query was compiled for.
+	// Collections sharing that table (reparsed ones do) are searched by symbol, any other
+	// collection still works but compares names. Running a query allocates nothing besides
+	// growing the vector the matches go to.
+	class Query
+	{
+	public:
+		Query();
+
+		// A query that doesn't compile matches nothing, GetError says what is wrong at which position
+		static Query Compile(std::string_view text, const LayoutCollection& collection);
+		static Query Compile(std::string_view text);
+
+		inline bool IsValid() const { return m_Error == nullptr; }
+		inline const char* GetError() const { return m_Error; }
+		inline size_t GetErrorPosition() const { return m_ErrorPosition; }
+
+		inline const std::string& GetText() const { return m_Text; }
+
+		// Adds every match in the order of the tree
+		void Run(const LayoutCollection& collection, std::vector<QueryMatch>& matches) const;
+
+		// Stops at the first match, the result is empty if there is none
+		QueryMatch First(const LayoutCollection& collection) const;
+
+	private:
+		friend class QueryBatch;
+
+		enum class StepKind : uint8_t
+		{
+			Name,
+			Any,
+			Index
+		};
+
+		enum class FilterKind : uint8_t
+		{
+			Exists,
+			Equal,
+			NotEqual
+		};
+
+		// Names and strings are offsets into m_Text so copies of the query stay valid
+		struct Step
+		{
+			StepKind Kind;
+			Symbol Name;
+			uint32_t NameStart;
+			uint32_t NameLength;
+			uint32_t Index;
+			uint32_t FirstFilter;
+			uint32_t FilterCount;
+		};
+
+		struct Filter
+		{
+			FilterKind Kind;
+			ValueKind LiteralKind;
+			Symbol Key;
+			uint32_t KeyStart;
+			uint32_t KeyLength;
+			uint32_t StringStart;
+			uint32_t StringLength;
+			float Number;
+			bool Boolean;
+			uint8_t Color[3];
+		};
+
+		std::string m_Text;
+		std::shared_ptr<const SymbolTable> m_Symbols;
+
+		std::vector<Step> m_Steps;
+		std::vector<Filter> m_Filters;
+
+		const char* m_Error;
+		size_t m_ErrorPosition;
+
+		// Compiling
+		void Parse(const SymbolTable* symbols);
+		bool ParseStep(size_t& position, const SymbolTable* symbols);
+		bool ParseFilter(size_t& position, const SymbolTable* symbols);
+		bool ParseLiteral(size_t& position, Filter& filter);
+		bool ParseName(size_t& position, uint32_t& start, uint32_t& length);
+		void SkipSpaces(size_t& position) const;
+		bool Fail(const char* error, size_t position);
+
+		// Running
+		inline std::string_view GetName(uint32_t start, uint32_t length) const { return std::string_view(m_Text).substr(start, length); }
+		bool UsesSymbolsOf(const LayoutCollection& collection) const;
+
+		const Layout* FindLayout(const LayoutCollection& collection, bool useSymbols) const;
+		bool MatchesType(const Step& step, const Object* object, bool useSymbols) const;
+		bool MatchesFilters(const Step& step, const Value* value, const Object* object, bool useSymbols) const;
+		bool MatchesLiteral(const Filter& filter, const Value* value) const;
+
+		template<typename TSink>
+		bool VisitLayouts(const LayoutCollection& collection, TSink& sink) const;
+		template<typename TSink>
+		bool VisitLayout(const Layout& layout, bool useSymbols, TSink& sink) const;
+		template<typename TSink>
+		bool VisitLayoutObject(const Layout& layout, size_t index, bool useSymbols, TSink& sink) const;
+		template<typename TSink>
+		bool Visit(size_t stepIndex, const Value* value, const Object* object, bool useSymbols, TSink& sink) const;
+		template<typename TSink>
+		bool Offer(size_t stepIndex, const Value* value, const Object* object, bool useSymbols, TSink& sink) const;
+	};
+
+	// Runs many queries in one sweep, for resolving all bindings of a screen at once. Queries
+	// are grouped by the layout they start in; each layout is looked up once per run and its
+	// objects are visited once for the whole group instead of once per query.
+	class QueryBatch
+	{
+	public:
+		// Returns the index the query's matches show up at
+		size_t Add(Query query);
+
+		inline size_t Size() const { return m_Queries.size(); }
+		inline const Query& GetQuery(size_t index) const { return m_Queries[index]; }
+
+		// matches[i] is the first match of query i, or empty
+		void RunFirst(const LayoutCollection& collection, std::vector<QueryMatch>& matches) const;
+
+		// matches[i] gets every match of query i, the inner vectors keep their capacity between runs
+		void Run(const LayoutCollection& collection, std::vector<std::vector<QueryMatch>>& matches) const;
+
+	private:
+		struct Group
+		{
+			// Empty for queries that start with *
+			std::string Layout;
+			std::vector<size_t> Queries;
+		};
+
+		std::vector<Query> m_Queries;
+		std::vector<Group> m_Groups;
+
+		template<typename TSinkFactory>
+		void Sweep(const LayoutCollection& collection, TSinkFactory& makeSink) const;
+	};
+}
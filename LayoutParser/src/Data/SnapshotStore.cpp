@@ -0,0 +1,144 @@
+#include "Data/SnapshotStore.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace LayoutParser;
+
+// What a reader announces to the writers. Zero means it isn't pinned.
+struct SnapshotStore::ReaderSlot
+{
+	std::atomic<uint64_t> Epoch { 0 };
+	std::atomic<bool> IsClaimed { true };
+	ReaderSlot* Next = nullptr;
+};
+
+SnapshotStore::Pin::Pin(Reader& reader)
+	: m_Reader(reader)
+{
+	if (m_Reader.m_PinDepth++ > 0)
+	{
+		m_Snapshot = m_Reader.m_Pinned;
+		return;
+	}
+
+	// Announce first, then load. A writer that swapped before the epoch was read is seen by
+	// the load, a writer that swaps after it sees the announcement and keeps the old snapshot.
+	SnapshotStore& store = m_Reader.m_Store;
+	m_Reader.m_Slot->Epoch.store(store.m_Epoch.load());
+	m_Snapshot = store.m_Current.load();
+	m_Reader.m_Pinned = m_Snapshot;
+}
+
+SnapshotStore::Pin::~Pin()
+{
+	if (--m_Reader.m_PinDepth > 0)
+		return;
+
+	m_Reader.m_Pinned = nullptr;
+	m_Reader.m_Slot->Epoch.store(0, std::memory_order_release);
+}
+
+SnapshotStore::Reader::Reader(SnapshotStore& store)
+	: m_Store(store), m_Slot(store.AcquireSlot()), m_PinDepth(0), m_Pinned(nullptr)
+{
+}
+
+SnapshotStore::Reader::~Reader()
+{
+	m_Slot->IsClaimed.store(false, std::memory_order_release);
+}
+
+SnapshotStore::SnapshotStore(LayoutCollection&& collection)
+	: m_Current(new Snapshot(1, std::move(collection))), m_Version(1), m_Epoch(1), m_Slots(nullptr)
+{
+}
+
+SnapshotStore::~SnapshotStore()
+{
+	// Every reader has to be gone by now
+	delete m_Current.load();
+	for (const RetiredSnapshot& retired : m_Retired)
+		delete retired.Value;
+
+	ReaderSlot* slot = m_Slots.load();
+	while (slot != nullptr)
+	{
+		ReaderSlot* next = slot->Next;
+		delete slot;
+		slot = next;
+	}
+}
+
+uint64_t SnapshotStore::Publish(LayoutCollection&& collection)
+{
+	std::lock_guard<std::mutex> lock(m_WriteMutex);
+
+	uint64_t version = m_Version.load(std::memory_order_relaxed) + 1;
+	const Snapshot* snapshot = new Snapshot(version, std::move(collection));
+
+	// Readers announcing the epoch before the increment may still load the old snapshot
+	const Snapshot* previous = m_Current.exchange(snapshot);
+	m_Version.store(version, std::memory_order_release);
+	uint64_t epoch = m_Epoch.fetch_add(1);
+	m_Retired.push_back({ previous, epoch });
+
+	ReclaimLocked();
+	return version;
+}
+
+size_t SnapshotStore::Reclaim()
+{
+	std::lock_guard<std::mutex> lock(m_WriteMutex);
+	return ReclaimLocked();
+}
+
+size_t SnapshotStore::GetRetiredCount() const
+{
+	std::lock_guard<std::mutex> lock(m_WriteMutex);
+	return m_Retired.size();
+}
+
+SnapshotStore::ReaderSlot* SnapshotStore::AcquireSlot()
+{
+	for (ReaderSlot* slot = m_Slots.load(std::memory_order_acquire); slot != nullptr; slot = slot->Next)
+	{
+		bool isClaimed = false;
+		if (!slot->IsClaimed.load(std::memory_order_relaxed) && slot->IsClaimed.compare_exchange_strong(isClaimed, true, std::memory_order_acquire))
+			return slot;
+	}
+
+	ReaderSlot* slot = new ReaderSlot();
+	ReaderSlot* head = m_Slots.load(std::memory_order_relaxed);
+	do
+	{
+		slot->Next = head;
+	} while (!m_Slots.compare_exchange_weak(head, slot, std::memory_order_release, std::memory_order_relaxed));
+	return slot;
+}
+
+size_t SnapshotStore::ReclaimLocked()
+{
+	if (m_Retired.empty())
+		return 0;
+
+	uint64_t oldestEpoch = std::numeric_limits<uint64_t>::max();
+	for (ReaderSlot* slot = m_Slots.load(); slot != nullptr; slot = slot->Next)
+	{
+		uint64_t epoch = slot->Epoch.load();
+		if (epoch != 0)
+			oldestEpoch = std::min(oldestEpoch, epoch);
+	}
+
+	// A snapshot retired in epoch E can only be held by readers that announced E or earlier
+	auto reclaimable = std::partition(m_Retired.begin(), m_Retired.end(), [&](const RetiredSnapshot& retired)
+	{
+		return retired.Epoch >= oldestEpoch;
+	});
+
+	for (auto retired = reclaimable; retired != m_Retired.end(); ++retired)
+		delete retired->Value;
+
+	m_Retired.erase(reclaimable, m_Retired.end());
+	return m_Retired.size();
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+
+#include "LayoutCollection.h"
+
+namespace LayoutParser
+{
+	// An immutable, versioned collection. Nothing in it changes once it has been published.
+	struct Snapshot
+	{
+		Snapshot(uint64_t version, LayoutCollection&& collection)
+			: Version(version), Collection(std::move(collection)) {}
+
+		const uint64_t Version;
+		const LayoutCollection Collection;
+	};
+
+	// Hands out the current snapshot to readers on any number of threads while a writer replaces it.
+	//
+	// Readers never lock. Pinning announces the epoch the reader is in and loads the current
+	// snapshot, two atomic operations and no reference count. Publishing swaps in the new snapshot
+	// and retires the old one. A retired snapshot is only deleted once every reader that could still
+	// hold it has unpinned, which is checked whenever a snapshot is published or Reclaim is called.
+	//
+	// Writers are serialized. Lazily loaded collections still take a lock the first time a layout is
+	// touched, see LoadFromStringLazy.
+	class SnapshotStore
+	{
+		struct ReaderSlot;
+
+	public:
+		class Reader;
+
+		// Keeps one snapshot alive while it's in scope. Pins of the same reader can be nested,
+		// only the outermost one announces anything.
+		class Pin
+		{
+		public:
+			explicit Pin(Reader& reader);
+			~Pin();
+
+			Pin(const Pin& other) = delete;
+			Pin& operator=(const Pin& other) = delete;
+
+			inline const Snapshot& Get() const { return *m_Snapshot; }
+			inline const Snapshot* operator->() const { return m_Snapshot; }
+			inline const Snapshot& operator*() const { return *m_Snapshot; }
+
+		private:
+			Reader& m_Reader;
+			const Snapshot* m_Snapshot;
+		};
+
+		// One per reading thread, kept around for as long as the thread reads. Creating one takes
+		// a free slot in the store or adds a new one, so it's not meant to be done per read.
+		class Reader
+		{
+		public:
+			explicit Reader(SnapshotStore& store);
+			~Reader();
+
+			Reader(const Reader& other) = delete;
+			Reader& operator=(const Reader& other) = delete;
+
+		private:
+			friend class Pin;
+
+			SnapshotStore& m_Store;
+			ReaderSlot* m_Slot;
+
+			// Only touched by the owning thread
+			uint32_t m_PinDepth;
+			const Snapshot* m_Pinned;
+		};
+
+		explicit SnapshotStore(LayoutCollection&& collection);
+		~SnapshotStore();
+
+		SnapshotStore(const SnapshotStore& other) = delete;
+		SnapshotStore& operator=(const SnapshotStore& other) = delete;
+
+		// Makes the collection the current snapshot and returns its version. Readers that pin
+		// from now on see it, readers that are already pinned keep the one they have.
+		uint64_t Publish(LayoutCollection&& collection);
+
+		// Deletes the retired snapshots no reader can still see and returns how many are left
+		size_t Reclaim();
+
+		// Version of the newest snapshot, the first one is version 1. Kept apart from the snapshot
+		// so it can be read from any thread without a pin.
+		inline uint64_t GetVersion() const { return m_Version.load(std::memory_order_acquire); }
+
+		// Snapshots that were replaced but couldn't be deleted yet
+		size_t GetRetiredCount() const;
+
+	private:
+		struct RetiredSnapshot
+		{
+			const Snapshot* Value;
+			uint64_t Epoch; // the global epoch while it was still current
+		};
+
+		std::atomic<const Snapshot*> m_Current;
+		std::atomic<uint64_t> m_Version;
+		std::atomic<uint64_t> m_Epoch;
+
+		// Slots are only ever added, and deleted with the store
+		std::atomic<ReaderSlot*> m_Slots;
+
+		mutable std::mutex m_WriteMutex;
+		std::vector<RetiredSnapshot> m_Retired;
+
+		ReaderSlot* AcquireSlot();
+		size_t ReclaimLocked();
+	};
+}
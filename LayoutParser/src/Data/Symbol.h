@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+namespace LayoutParser
+{
+	// Interned name handed out by a SymbolTable. Two symbols from the same table are equal
+	// exactly when their names are, so lookups can compare these instead of strings.
+	struct Symbol
+	{
+	public:
+		static constexpr uint32_t InvalidId = UINT32_MAX;
+
+		constexpr Symbol()
+			: Id(InvalidId) {}
+		constexpr explicit Symbol(uint32_t id)
+			: Id(id) {}
+
+		inline constexpr bool IsValid() const { return Id != InvalidId; }
+
+		inline constexpr bool operator==(Symbol other) const { return Id == other.Id; }
+		inline constexpr bool operator!=(Symbol other) const { return Id != other.Id; }
+
+		uint32_t Id;
+	};
+}
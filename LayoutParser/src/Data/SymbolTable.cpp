@@ -0,0 +1,102 @@
+#include "Data/SymbolTable.h"
+
+#include <functional>
+
+using namespace LayoutParser;
+
+Symbol SymbolTable::Intern(std::string_view name)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	if (m_Slots.empty() || (m_Names.size() + 1) * 2 > m_Slots.size())
+		Grow();
+
+	size_t slot = FindSlot(name);
+	if (m_Slots[slot] != 0)
+		return Symbol(m_Slots[slot] - 1);
+
+	uint32_t id = static_cast<uint32_t>(m_Names.size());
+	m_Names.push_back(m_Strings.CopyString(name));
+	m_Slots[slot] = id + 1;
+
+	return Symbol(id);
+}
+
+Symbol SymbolTable::Find(std::string_view name) const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	if (m_Slots.empty())
+		return Symbol();
+
+	size_t slot = FindSlot(name);
+	return (m_Slots[slot] != 0) ? Symbol(m_Slots[slot] - 1) : Symbol();
+}
+
+// Either the slot holding the name or the empty slot where it would go
+size_t SymbolTable::FindSlot(std::string_view name) const
+{
+	size_t mask = m_Slots.size() - 1;
+	size_t slot = std::hash<std::string_view>()(name) & mask;
+	while (m_Slots[slot] != 0 && m_Names[m_Slots[slot] - 1] != name)
+		slot = (slot + 1) & mask;
+
+	return slot;
+}
+
+void SymbolTable::Grow()
+{
+	size_t capacity = m_Slots.empty() ? 256 : m_Slots.size() * 2;
+	m_Slots.assign(capacity, 0);
+
+	size_t mask = capacity - 1;
+	for (uint32_t id = 0; id < m_Names.size(); id++)
+	{
+		size_t slot = std::hash<std::string_view>()(m_Names[id]) & mask;
+		while (m_Slots[slot] != 0)
+			slot = (slot + 1) & mask;
+
+		m_Slots[slot] = id + 1;
+	}
+}
+
+InternedSymbol SymbolCache::Intern(std::string_view name)
+{
+	if (m_Slots.empty() || (m_Count + 1) * 2 > m_Slots.size())
+		Grow();
+
+	size_t mask = m_Slots.size() - 1;
+	size_t slot = std::hash<std::string_view>()(name) & mask;
+	while (m_Slots[slot].Id.IsValid())
+	{
+		if (m_Slots[slot].Name == name)
+			return m_Slots[slot];
+
+		slot = (slot + 1) & mask;
+	}
+
+	Symbol symbol = m_Table.Intern(name);
+	m_Slots[slot] = InternedSymbol{ symbol, m_Table.GetName(symbol) };
+	m_Count++;
+
+	return m_Slots[slot];
+}
+
+void SymbolCache::Grow()
+{
+	std::vector<InternedSymbol> slots(m_Slots.empty() ? 256 : m_Slots.size() * 2);
+	std::swap(slots, m_Slots);
+
+	size_t mask = m_Slots.size() - 1;
+	for (const InternedSymbol& entry : slots)
+	{
+		if (!entry.Id.IsValid())
+			continue;
+
+		size_t slot = std::hash<std::string_view>()(entry.Name) & mask;
+		while (m_Slots[slot].Id.IsValid())
+			slot = (slot + 1) & mask;
+
+		m_Slots[slot] = entry;
+	}
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include <mutex>
+#include <memory_resource>
+
+#include "Arena.h"
+#include "Symbol.h"
+
+namespace LayoutParser
+{
+	// Interns layout names, object identifiers and property keys for a collection. Every
+	// name is stored once and the views handed out stay valid as long as the table.
+	// Safe to use from several threads, parsers go through a SymbolCache so they rarely take the lock.
+	class SymbolTable
+	{
+	public:
+		SymbolTable(std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+			: m_Strings(upstream, 4 * 1024), m_Names(&m_Strings), m_Slots(&m_Strings) {}
+
+		SymbolTable(const SymbolTable& other) = delete;
+		SymbolTable& operator=(const SymbolTable& other) = delete;
+
+		// Returns the existing symbol for the name or adds a new one
+		Symbol Intern(std::string_view name);
+
+		// Returns an invalid symbol if the name was never interned, so nothing matches it
+		Symbol Find(std::string_view name) const;
+
+		inline std::string_view GetName(Symbol symbol) const
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			return m_Names[symbol.Id];
+		}
+
+		inline size_t Size() const
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			return m_Names.size();
+		}
+
+	private:
+		mutable std::mutex m_Mutex;
+
+		Arena m_Strings;
+		std::pmr::vector<std::string_view> m_Names;
+
+		// Open addressing over symbol id + 1, zero means empty
+		std::pmr::vector<uint32_t> m_Slots;
+
+		size_t FindSlot(std::string_view name) const;
+		void Grow();
+	};
+
+	struct InternedSymbol
+	{
+		Symbol Id;
+		std::string_view Name; // owned by the table
+	};
+
+	// Unsynchronized front for a shared SymbolTable, one per parser. A layout only uses a
+	// few hundred distinct names so nearly every lookup is answered here without locking.
+	class SymbolCache
+	{
+	public:
+		SymbolCache(SymbolTable& table)
+			: m_Table(table), m_Count(0) {}
+
+		InternedSymbol Intern(std::string_view name);
+
+	private:
+		SymbolTable& m_Table;
+
+		// Open addressing, an invalid id marks an empty slot
+		std::vector<InternedSymbol> m_Slots;
+		size_t m_Count;
+
+		void Grow();
+	};
+}
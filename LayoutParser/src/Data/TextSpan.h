@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+namespace LayoutParser
+{
+	// Range of source text, in the same units as token positions
+	struct TextSpan
+	{
+	public:
+		constexpr TextSpan()
+			: Start(0), Length(0) {}
+		constexpr TextSpan(int32_t start, int32_t length)
+			: Start(start), Length(length) {}
+
+		inline constexpr int32_t GetEnd() const { return Start + Length; }
+
+		int32_t Start;
+		int32_t Length;
+	};
+}
@@ -0,0 +1,181 @@
+#include "Data/TreePrinter.h"
+
+#include "Data/LayoutCollection.h"
+#include "Data/Object.h"
+#include "Data/Value.h"
+
+using namespace LayoutParser;
+
+namespace
+{
+	// UTF-8 spelled out so the source doesn't depend on the compiler's character set
+	constexpr std::string_view LastBranch = "\xE2\x94\x94\xE2\x94\x80\xE2\x94\x80"; // └──
+	constexpr std::string_view Branch = "\xE2\x94\x9C\xE2\x94\x80\xE2\x94\x80"; // ├──
+	constexpr std::string_view Continuation = "\xE2\x94\x82  "; // │
+	constexpr std::string_view Gap = "   ";
+}
+
+TreePrinter::TreePrinter(OutputBuffer& output)
+	: m_Output(output)
+{
+}
+
+void TreePrinter::Print(const LayoutCollection& collection)
+{
+	BeginLine(true);
+	m_Output.Write("Collection\n");
+
+	PushIndent(true);
+	if (!collection.IsEmpty())
+	{
+		const Layout* last = &collection.LastLayout();
+		for (auto& pair : collection)
+			PrintLayout(pair.first, pair.second, &pair.second == last);
+	}
+	PopIndent();
+}
+
+void TreePrinter::PrintLayout(std::string_view name, const Layout& layout, bool isLast)
+{
+	BeginLine(isLast);
+	m_Output.Write(name);
+	m_Output.Write('\n');
+
+	PushIndent(isLast);
+	if (!layout.IsEmpty())
+	{
+		const Object* last = layout.LastObject();
+		for (const Object* object : layout)
+			PrintObject(object, object == last);
+	}
+	PopIndent();
+}
+
+void TreePrinter::PrintObject(const Object* object, bool isLast)
+{
+	BeginLine(isLast);
+	m_Output.Write(object->GetIdentifier());
+	if (object->GetConstructor() != nullptr)
+	{
+		m_Output.Write('(');
+		WriteValueText(object->GetConstructor());
+		m_Output.Write(')');
+	}
+	m_Output.Write('\n');
+
+	PushIndent(isLast);
+	if (!object->IsEmpty())
+	{
+		const Value* last = object->LastProperty();
+		for (auto& pair : *object)
+			PrintValue(pair.second, pair.first, pair.second == last);
+	}
+	PopIndent();
+}
+
+void TreePrinter::PrintValue(const Value* value, std::string_view propertyName, bool isLast)
+{
+	BeginLine(isLast);
+	if (!propertyName.empty())
+	{
+		m_Output.Write(propertyName);
+		m_Output.Write(": ");
+	}
+	WriteValueText(value);
+	m_Output.Write('\n');
+
+	PushIndent(isLast);
+	switch (value->GetKind())
+	{
+	case ValueKind::Object:
+		PrintObject(value->AsObject()->GetValue(), true);
+		break;
+	case ValueKind::List:
+	{
+		const ListValue* list = value->AsList();
+		if (!list->IsEmpty())
+		{
+			const Value* last = list->LastValue();
+			for (const Value* element : *list)
+				PrintValue(element, std::string_view(), element == last);
+		}
+		break;
+	}
+	case ValueKind::Dictionary:
+	{
+		const DictionaryValue* dictionary = value->AsDictionary();
+		if (!dictionary->IsEmpty())
+		{
+			const Value* last = dictionary->LastValue();
+			for (auto& pair : *dictionary)
+				PrintValue(pair.second, pair.first, pair.second == last);
+		}
+		break;
+	}
+	default:
+		break;
+	}
+	PopIndent();
+}
+
+void TreePrinter::WriteValueText(const Value* value)
+{
+	switch (value->GetKind())
+	{
+	case ValueKind::Object:
+		m_Output.Write("ObjectValue");
+		break;
+	case ValueKind::String:
+		m_Output.Write("StringValue(");
+		m_Output.Write(value->AsString()->GetValue());
+		m_Output.Write(')');
+		break;
+	case ValueKind::Number:
+		m_Output.Write("NumberValue(");
+		m_Output.WriteNumber(value->AsNumber()->GetValue());
+		m_Output.Write(')');
+		break;
+	case ValueKind::Boolean:
+		m_Output.Write(value->AsBoolean()->GetValue() ? "BooleanValue(True)" : "BooleanValue(False)");
+		break;
+	case ValueKind::HexColor:
+	{
+		const HexColorValue* hexColor = value->AsHexColor();
+		m_Output.Write("HexColorValue(");
+		m_Output.WriteInteger(hexColor->GetR());
+		m_Output.Write(", ");
+		m_Output.WriteInteger(hexColor->GetG());
+		m_Output.Write(", ");
+		m_Output.WriteInteger(hexColor->GetB());
+		m_Output.Write(')');
+		break;
+	}
+	case ValueKind::List:
+		m_Output.Write("ListValue");
+		break;
+	case ValueKind::Dictionary:
+		m_Output.Write("DictionaryValue");
+		break;
+	default:
+		m_Output.Write("BadValue");
+		break;
+	}
+}
+
+void TreePrinter::BeginLine(bool isLast)
+{
+	m_Output.Write(m_Indent);
+	m_Output.Write(isLast ? LastBranch : Branch);
+}
+
+void TreePrinter::PushIndent(bool isLast)
+{
+	m_IndentLengths.push_back(m_Indent.length());
+	m_Indent.append(isLast ? Gap : Continuation);
+}
+
+void TreePrinter::PopIndent()
+{
+	m_Indent.resize(m_IndentLengths.back());
+	m_IndentLengths.pop_back();
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "OutputBuffer.h"
+
+namespace LayoutParser
+{
+	class LayoutCollection;
+	struct Layout;
+	struct Object;
+	struct Value;
+
+	// Draws a collection as a tree with UTF-8 box drawing characters, one node per line.
+	// The prefix of the current line is kept as one string that every level appends its part
+	// to and cuts back off, so nothing is allocated per node once it has grown to the deepest level.
+	class TreePrinter
+	{
+	public:
+		explicit TreePrinter(OutputBuffer& output);
+
+		void Print(const LayoutCollection& collection);
+
+	private:
+		OutputBuffer& m_Output;
+
+		std::string m_Indent;
+		std::vector<size_t> m_IndentLengths;
+
+		void PrintLayout(std::string_view name, const Layout& layout, bool isLast);
+		void PrintObject(const Object* object, bool isLast);
+		void PrintValue(const Value* value, std::string_view propertyName, bool isLast);
+
+		void WriteValueText(const Value* value);
+
+		// Writes the prefix and the branch of a node
+		void BeginLine(bool isLast);
+
+		void PushIndent(bool isLast);
+		void PopIndent();
+	};
+}
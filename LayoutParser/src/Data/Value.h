@@ -1,8 +1,14 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <charconv>
+#include <cstdint>
 #include <vector>
-#include <unordered_map>
+#include <memory_resource>
+
+#include "FlatMap.h"
+#include "Symbol.h"
 
 namespace LayoutParser
 {
@@ -27,6 +33,8 @@ namespace LayoutParser
 		Dictionary
 	};
 
+	// Values are allocated from the Arena of the LayoutCollection that owns them and
+	// are never destroyed one by one. Anything they reference must live in the same arena.
 	struct Value
 	{
 	public:
@@ -66,7 +74,6 @@ namespace LayoutParser
 	public:
 		ObjectValue(Object* object)
 			: Value(ValueKind::Object), m_Object(object) {}
-		virtual ~ObjectValue() override;
 
 		inline const Object* GetValue() const { return m_Object; }
 
@@ -77,16 +84,13 @@ namespace LayoutParser
 	struct StringValue : public Value
 	{
 	public:
-		StringValue(const std::string& string)
-			: Value(ValueKind::String), m_String(string) {}
-
-		StringValue(std::string&& string)
+		StringValue(std::string_view string)
 			: Value(ValueKind::String), m_String(string) {}
 
-		inline const std::string& GetValue() const { return m_String; }
+		inline std::string_view GetValue() const { return m_String; }
 
 	private:
-		std::string m_String;
+		std::string_view m_String;
 	};
 
 	struct NumberValue : public Value
@@ -119,14 +123,16 @@ namespace LayoutParser
 	struct HexColorValue : public Value
 	{
 	public:
-		HexColorValue(const std::string& stringRepresentation)
+		HexColorValue(std::string_view stringRepresentation)
 			: Value(ValueKind::HexColor)
 		{
 			// Expected input format: #RRGGBB
-			R = static_cast<int8_t>(std::stoi(stringRepresentation.substr(1, 2), nullptr, 16));
-			G = static_cast<int8_t>(std::stoi(stringRepresentation.substr(3, 2), nullptr, 16));
-			B = static_cast<int8_t>(std::stoi(stringRepresentation.substr(5, 2), nullptr, 16));
+			R = ParseChannel(stringRepresentation, 1);
+			G = ParseChannel(stringRepresentation, 3);
+			B = ParseChannel(stringRepresentation, 5);
 		}
+		HexColorValue(uint8_t r, uint8_t g, uint8_t b)
+			: Value(ValueKind::HexColor), R(r), G(g), B(b) {}
 
 		inline uint8_t GetR() const { return R; }
 		inline uint8_t GetG() const { return G; }
@@ -136,17 +142,24 @@ namespace LayoutParser
 		uint8_t R;
 		uint8_t G;
 		uint8_t B;
+
+		// The lexer already reported malformed colors so bad digits just become 0 here
+		static inline uint8_t ParseChannel(std::string_view text, size_t offset)
+		{
+			uint8_t channel = 0;
+			if (offset + 2 <= text.length())
+				std::from_chars(text.data() + offset, text.data() + offset + 2, channel, 16);
+			return channel;
+		}
 	};
 
 	struct ListValue : public Value
 	{
 	public:
-		ListValue(std::vector<const Value*>&& list)
-			: Value(ValueKind::List), m_List(list) {}
+		ListValue(std::pmr::vector<const Value*>&& list)
+			: Value(ValueKind::List), m_List(std::move(list)) {}
 
-		virtual ~ListValue() override;
-
-		inline const std::vector<const Value*>& GetContainer() const { return m_List; }
+		inline const std::pmr::vector<const Value*>& GetContainer() const { return m_List; }
 
 		inline const Value* FirstValue() const { return m_List.front(); }
 		inline const Value* LastValue() const { return m_List.back(); }
@@ -159,31 +172,30 @@ namespace LayoutParser
 		auto end() const { return m_List.end(); }
 
 	private:
-		std::vector<const Value*> m_List;
+		std::pmr::vector<const Value*> m_List;
 	};
 
 	struct DictionaryValue : public Value
 	{
 	public:
-		DictionaryValue(std::unordered_map<std::string, const Value*>&& dictionary)
-			: Value(ValueKind::Dictionary), m_Dictionary(dictionary) {}
-
-		virtual ~DictionaryValue() override;
+		DictionaryValue(FlatMap<const Value*>&& dictionary)
+			: Value(ValueKind::Dictionary), m_Dictionary(std::move(dictionary)) {}
 
-		inline const std::unordered_map<std::string, const Value*>& GetContainer() const { return m_Dictionary; }
+		inline const FlatMap<const Value*>& GetContainer() const { return m_Dictionary; }
 
-		inline const Value* FirstValue() const { return m_Dictionary.begin()->second; }
-		inline const Value* LastValue() const { return std::prev(m_Dictionary.end())->second; }
+		inline const Value* FirstValue() const { return m_Dictionary.Front().second; }
+		inline const Value* LastValue() const { return m_Dictionary.Back().second; }
 
-		inline bool IsEmpty() const { return m_Dictionary.empty(); }
+		inline bool IsEmpty() const { return m_Dictionary.IsEmpty(); }
 
-		inline const Value* operator[](const std::string& identifier) const { return m_Dictionary.at(identifier); }
-		inline const Value* operator[](const char* identifier) const { return m_Dictionary.at(identifier); }
+		inline const Value* operator[](const std::string& identifier) const { return m_Dictionary.At(identifier); }
+		inline const Value* operator[](const char* identifier) const { return m_Dictionary.At(identifier); }
+		inline const Value* operator[](Symbol symbol) const { return m_Dictionary.At(symbol); }
 
 		auto begin() const { return m_Dictionary.begin(); }
 		auto end() const { return m_Dictionary.end(); }
 
 	private:
-		std::unordered_map<std::string, const Value*> m_Dictionary;
+		FlatMap<const Value*> m_Dictionary;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "Threading/WorkStealingPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace LayoutParser;
+
+WorkStealingPool::WorkStealingPool(size_t threadCount)
+	: m_ThreadCount(threadCount)
+{
+	if (m_ThreadCount == 0)
+		m_ThreadCount = std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+void WorkStealingPool::ParallelFor(size_t count, const std::function<void(size_t)>& task)
+{
+	size_t workerCount = std::min(m_ThreadCount, count);
+	if (workerCount <= 1)
+	{
+		for (size_t i = 0; i < count; i++)
+			task(i);
+		return;
+	}
+
+	// Neighbouring tasks tend to touch the same data, so hand out contiguous blocks
+	std::unique_ptr<WorkQueue[]> queues(new WorkQueue[workerCount]);
+	for (size_t worker = 0; worker < workerCount; worker++)
+	{
+		queues[worker].Begin = count * worker / workerCount;
+		queues[worker].End = count * (worker + 1) / workerCount;
+	}
+
+	std::atomic<bool> failed(false);
+	std::exception_ptr firstError;
+	std::mutex errorMutex;
+
+	auto run = [&](size_t worker)
+	{
+		size_t index;
+		while (!failed.load(std::memory_order_relaxed) &&
+			(Pop(queues[worker], index) || Steal(queues.get(), workerCount, worker, index)))
+		{
+			try
+			{
+				task(index);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(errorMutex);
+				if (!firstError)
+					firstError = std::current_exception();
+				failed = true;
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve(workerCount - 1);
+	for (size_t worker = 1; worker < workerCount; worker++)
+		threads.emplace_back(run, worker);
+
+	run(0);
+	for (std::thread& thread : threads)
+		thread.join();
+
+	if (firstError)
+		std::rethrow_exception(firstError);
+}
+
+bool WorkStealingPool::Pop(WorkQueue& queue, size_t& index)
+{
+	std::lock_guard<std::mutex> lock(queue.Mutex);
+	if (queue.Begin == queue.End)
+		return false;
+
+	index = queue.Begin++;
+	return true;
+}
+
+// Takes from the back of the victim's block, the owner keeps working from the front
+bool WorkStealingPool::Steal(WorkQueue* queues, size_t queueCount, size_t thief, size_t& index)
+{
+	for (size_t offset = 1; offset < queueCount; offset++)
+	{
+		WorkQueue& victim = queues[(thief + offset) % queueCount];
+
+		std::lock_guard<std::mutex> lock(victim.Mutex);
+		if (victim.Begin != victim.End)
+		{
+			index = --victim.End;
+			return true;
+		}
+	}
+	return false;
+}
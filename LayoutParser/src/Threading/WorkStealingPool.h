@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <mutex>
+
+namespace LayoutParser
+{
+	// Runs batches of independent tasks on a team of threads. Each worker starts on its own
+	// contiguous block of indices and, once that runs dry, steals from the back of another
+	// worker's block, so uneven tasks still keep every thread busy.
+	class WorkStealingPool
+	{
+	public:
+		// Zero picks one thread per core
+		WorkStealingPool(size_t threadCount = 0);
+
+		inline size_t GetThreadCount() const { return m_ThreadCount; }
+
+		// Calls task(index) for every index in [0, count) and returns once all of them are done.
+		// The calling thread works too. If a task throws, no new tasks are started and the first
+		// exception is rethrown here.
+		void ParallelFor(size_t count, const std::function<void(size_t)>& task);
+
+	private:
+		struct WorkQueue
+		{
+			std::mutex Mutex;
+			size_t Begin = 0;
+			size_t End = 0;
+		};
+
+		size_t m_ThreadCount;
+
+		static bool Pop(WorkQueue& queue, size_t& index);
+		static bool Steal(WorkQueue* queues, size_t queueCount, size_t thief, size_t& index);
+	};
+}